@@ -114,6 +114,9 @@ void FileNameEditor::addToNameEditor(QString s)
 
 void FileNameEditor::updateComponents()
 {
-    m_nameEditor->setText(ConfigHandler().filenamePattern());
-    m_outputLabel->setText(m_nameHandler->parsedPattern());
+    // Called on ConfigHandler::fileChanged, maybe before the pattern of
+    // FileNameHandler::parsedPattern() is updated
+    const QString pattern = ConfigHandler().filenamePattern();
+    m_nameEditor->setText(pattern);
+    m_outputLabel->setText(m_nameHandler->parseFilename(pattern));
 }
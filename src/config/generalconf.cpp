@@ -35,6 +35,7 @@ GeneralConf::GeneralConf(QWidget* parent)
     initShowHelp();
     initShowSidePanelButton();
     initShowDesktopNotification();
+    initLogToFile();
     initShowTrayIcon();
     initHistoryConfirmationToDelete();
     initCheckForUpdates();
@@ -60,6 +61,7 @@ GeneralConf::GeneralConf(QWidget* parent)
 
     initShowMagnifier();
     initSquareMagnifier();
+    initSmartSelection();
     // this has to be at the end
     initConfigButtons();
     updateComponents();
@@ -71,6 +73,7 @@ void GeneralConf::_updateComponents(bool allowEmptySavePath)
     m_helpMessage->setChecked(config.showHelp());
     m_sidePanelButton->setChecked(config.showSidePanelButton());
     m_sysNotifications->setChecked(config.showDesktopNotification());
+    m_logToFile->setChecked(config.logToFile());
     m_autostart->setChecked(config.startupLaunch());
     m_copyAndCloseAfterUpload->setChecked(config.copyAndCloseAfterUpload());
     m_saveAfterCopy->setChecked(config.saveAfterCopy());
@@ -84,6 +87,7 @@ void GeneralConf::_updateComponents(bool allowEmptySavePath)
     m_allowMultipleGuiInstances->setChecked(config.allowMultipleGuiInstances());
     m_showMagnifier->setChecked(config.showMagnifier());
     m_squareMagnifier->setChecked(config.squareMagnifier());
+    m_smartSelection->setChecked(config.smartSelection());
 
 #if !defined(Q_OS_WIN)
     m_autoCloseIdleDaemon->setChecked(config.autoCloseIdleDaemon());
@@ -260,6 +264,18 @@ void GeneralConf::initShowDesktopNotification()
             &GeneralConf::showDesktopNotificationChanged);
 }
 
+void GeneralConf::initLogToFile()
+{
+    m_logToFile = new QCheckBox(tr("Write a log file"), this);
+    m_logToFile->setToolTip(
+      tr("Also write the messages printed in the terminal to flameshot.log"));
+    m_scrollAreaLayout->addWidget(m_logToFile);
+
+    connect(m_logToFile, &QCheckBox::clicked, [](bool checked) {
+        ConfigHandler().setLogToFile(checked);
+    });
+}
+
 void GeneralConf::initShowTrayIcon()
 {
 #if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
@@ -688,6 +704,19 @@ void GeneralConf::initSquareMagnifier()
     });
 }
 
+void GeneralConf::initSmartSelection()
+{
+    m_smartSelection =
+      new QCheckBox(tr("Snap selection to windows and elements"), this);
+    m_smartSelection->setToolTip(
+      tr("Highlight the window or element under the mouse before selecting "
+         "an area, a click selects it"));
+    m_scrollAreaLayout->addWidget(m_smartSelection);
+    connect(m_smartSelection, &QCheckBox::clicked, [](bool checked) {
+        ConfigHandler().setSmartSelection(checked);
+    });
+}
+
 void GeneralConf::togglePathFixed()
 {
     ConfigHandler().setSavePathFixed(m_screenshotPathFixedCheck->isChecked());
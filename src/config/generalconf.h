@@ -61,12 +61,14 @@ private:
     void initSaveAfterCopy();
     void initScrollArea();
     void initShowDesktopNotification();
+    void initLogToFile();
     void initShowHelp();
     void initShowMagnifier();
     void initShowSidePanelButton();
     void initShowStartupLaunchMessage();
     void initShowTrayIcon();
     void initSquareMagnifier();
+    void initSmartSelection();
     void initUndoLimit();
     void initUploadWithoutConfirmation();
     void initUseJpgForClipboard();
@@ -80,6 +82,7 @@ private:
     QVBoxLayout* m_scrollAreaLayout;
     QScrollArea* m_scrollArea;
     QCheckBox* m_sysNotifications;
+    QCheckBox* m_logToFile;
     QCheckBox* m_showTray;
     QCheckBox* m_helpMessage;
     QCheckBox* m_sidePanelButton;
@@ -108,5 +111,6 @@ private:
     QCheckBox* m_predefinedColorPaletteLarge;
     QCheckBox* m_showMagnifier;
     QCheckBox* m_squareMagnifier;
+    QCheckBox* m_smartSelection;
     QCheckBox* m_copyOnDoubleClick;
 };
@@ -177,6 +177,7 @@ void ShortcutsWidget::loadShortcuts()
     appendShortcut("TYPE_RESIZE_UP", "Resize selection up 1px");
     appendShortcut("TYPE_RESIZE_DOWN", "Resize selection down 1px");
     appendShortcut("TYPE_SELECT_ALL", "Select entire screen");
+    appendShortcut("TYPE_SAVE_PROJECT", "Save as an editable project");
     appendShortcut("TYPE_MOVE_LEFT", "Move selection left 1px");
     appendShortcut("TYPE_MOVE_RIGHT", "Move selection right 1px");
     appendShortcut("TYPE_MOVE_UP", "Move selection up 1px");
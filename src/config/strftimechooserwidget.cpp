@@ -11,24 +11,20 @@ StrftimeChooserWidget::StrftimeChooserWidget(QWidget* parent)
 {
     auto* layout = new QGridLayout(this);
     auto k = m_buttonData.keys();
-    int middle = k.length() / 2;
-    // add the buttons in 2 columns (they need to be even)
-    for (int i = 0; i < 2; i++) {
-        for (int j = 0; j < middle; j++) {
-            QString key = k.last();
-            k.pop_back();
-            QString variable = m_buttonData.value(key);
-            auto* button = new QPushButton(this);
-            button->setText(tr(key.toStdString().data()));
-            button->setToolTip(variable);
-            button->setSizePolicy(QSizePolicy::Expanding,
-                                  QSizePolicy::Expanding);
-            button->setMinimumHeight(25);
-            layout->addWidget(button, j, i);
-            connect(button, &QPushButton::clicked, this, [variable, this]() {
-                emit variableEmitted(variable);
-            });
-        }
+    int rows = (k.length() + 1) / 2;
+    // add the buttons in 2 columns
+    for (int i = 0; i < k.length(); i++) {
+        QString key = k.at(k.length() - 1 - i);
+        QString variable = m_buttonData.value(key);
+        auto* button = new QPushButton(this);
+        button->setText(tr(key.toStdString().data()));
+        button->setToolTip(variable);
+        button->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+        button->setMinimumHeight(25);
+        layout->addWidget(button, i % rows, i / rows);
+        connect(button, &QPushButton::clicked, this, [variable, this]() {
+            emit variableEmitted(variable);
+        });
     }
     setLayout(layout);
 }
@@ -67,4 +63,7 @@ QMap<QString, QString> StrftimeChooserWidget::m_buttonData{
     { QT_TR_NOOP("Full Date (%m/%d/%y)"), "%D" },
 #endif
     { QT_TR_NOOP("Full Date (%Y-%m-%d)"), "%F" },
+    { QT_TR_NOOP("Capture Number (1, 2, ...)"), "%{counter}" },
+    { QT_TR_NOOP("Screen Name"), "%{screen}" },
+    { QT_TR_NOOP("Capture Size (1920x1080)"), "%{size}" },
 };
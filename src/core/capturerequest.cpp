@@ -56,6 +56,11 @@ QRect CaptureRequest::initialSelection() const
     return m_initialSelection;
 }
 
+QString CaptureRequest::projectPath() const
+{
+    return m_projectPath;
+}
+
 void CaptureRequest::addTask(CaptureRequest::ExportTask task)
 {
     if (task == SAVE) {
@@ -85,3 +90,8 @@ void CaptureRequest::setInitialSelection(const QRect& selection)
 {
     m_initialSelection = selection;
 }
+
+void CaptureRequest::setProjectPath(const QString& path)
+{
+    m_projectPath = path;
+}
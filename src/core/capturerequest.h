@@ -15,6 +15,11 @@ public:
         FULLSCREEN_MODE,
         GRAPHICAL_MODE,
         SCREEN_MODE,
+        // The region is grabbed repeatedly while it scrolls
+        SCROLL_MODE,
+        // The region is recorded as an animation, data holds the fps and the
+        // duration in milliseconds
+        RECORD_MODE,
     };
 
     enum ExportTask
@@ -43,17 +48,21 @@ public:
     CaptureMode captureMode() const;
     ExportTask tasks() const;
     QRect initialSelection() const;
+    QString projectPath() const;
 
     void addTask(ExportTask task);
     void removeTask(ExportTask task);
     void addSaveTask(const QString& path = QString());
     void addPinTask(const QRect& pinWindowGeometry);
     void setInitialSelection(const QRect& selection);
+    // Edit an AnnotationProject instead of a new screenshot
+    void setProjectPath(const QString& path);
 
 private:
     CaptureMode m_mode;
     uint m_delay;
     QString m_path;
+    QString m_projectPath;
     ExportTask m_tasks;
     QVariant m_data;
     QRect m_pinWindowGeometry, m_initialSelection;
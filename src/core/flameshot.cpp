@@ -16,19 +16,27 @@
 #include "src/tools/imgupload/imguploadermanager.h"
 #include "src/tools/imgupload/storages/imguploaderbase.h"
 #include "src/utils/confighandler.h"
+#include "src/utils/filenamehandler.h"
 #include "src/utils/screengrabber.h"
+#include "src/utils/tracing.h"
 #include "src/widgets/capture/capturewidget.h"
+#include "src/widgets/capture/selectioncapturewidget.h"
 #include "src/widgets/capturelauncher.h"
 #include "src/widgets/imguploaddialog.h"
 #include "src/widgets/infowindow.h"
+#include "src/widgets/recordwidget.h"
+#include "src/widgets/scrollcapturewidget.h"
 #include "src/widgets/uploadhistory.h"
 #include <QApplication>
 #include <QBuffer>
 #include <QDebug>
 #include <QDesktopServices>
 #include <QDesktopWidget>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QMessageBox>
+#include <QStandardPaths>
 #include <QThread>
 #include <QTimer>
 #include <QVersionNumber>
@@ -78,6 +86,7 @@ Flameshot* Flameshot::instance()
 
 CaptureWidget* Flameshot::gui(const CaptureRequest& req)
 {
+    TRACE_SPAN("Flameshot::gui");
     if (!resolveAnyConfigErrors()) {
         return nullptr;
     }
@@ -114,9 +123,16 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
             return nullptr;
         }
 
-        m_captureWindow = new CaptureWidget(req);
-        // m_captureWindow = new CaptureWidget(req, false); //
-        // debug
+        CaptureWidget* captureWidget = nullptr;
+        if (SelectionCaptureWidget::canHandle(req)) {
+            // Nothing will be drawn, skip the editing machinery
+            m_captureWindow = new SelectionCaptureWidget(req);
+        } else {
+            captureWidget = new CaptureWidget(req);
+            // captureWidget = new CaptureWidget(req, false); //
+            // debug
+            m_captureWindow = captureWidget;
+        }
 
 #ifdef Q_OS_WIN
         m_captureWindow->show();
@@ -129,7 +145,7 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
         m_captureWindow->showFullScreen();
 //        m_captureWindow->show(); // For CaptureWidget Debugging under Linux
 #endif
-        return m_captureWindow;
+        return captureWidget;
     } else {
         emit captureFailed();
         return nullptr;
@@ -138,6 +154,7 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
 
 void Flameshot::screen(CaptureRequest req, const int screenNumber)
 {
+    TRACE_SPAN("Flameshot::screen");
     if (!resolveAnyConfigErrors())
         return;
 
@@ -184,6 +201,7 @@ void Flameshot::screen(CaptureRequest req, const int screenNumber)
 
 void Flameshot::full(const CaptureRequest& req)
 {
+    TRACE_SPAN("Flameshot::full");
     if (!resolveAnyConfigErrors())
         return;
 
@@ -201,6 +219,98 @@ void Flameshot::full(const CaptureRequest& req)
     }
 }
 
+void Flameshot::scroll(const CaptureRequest& req)
+{
+    TRACE_SPAN("Flameshot::scroll");
+    if (!resolveAnyConfigErrors())
+        return;
+
+    if (m_scrollCaptureWindow != nullptr) {
+        emit captureFailed();
+        return;
+    }
+    QRect region = req.initialSelection();
+    if (region.isNull()) {
+        region = ScreenGrabber().screenGeometry(
+          QGuiAppCurrentScreen().currentScreen());
+    }
+    auto* widget = new ScrollCaptureWidget(region);
+    connect(widget,
+            &ScrollCaptureWidget::captureFinished,
+            this,
+            [this, req, region](QPixmap capture) {
+                QRect selection(region.topLeft(),
+                                capture.size() / capture.devicePixelRatio());
+                exportCapture(capture, selection, req);
+            });
+    connect(widget,
+            &ScrollCaptureWidget::captureCanceled,
+            this,
+            &Flameshot::captureFailed);
+    if (!widget->start()) {
+        delete widget;
+        emit captureFailed();
+        return;
+    }
+    m_scrollCaptureWindow = widget;
+}
+
+void Flameshot::record(const CaptureRequest& req)
+{
+    TRACE_SPAN("Flameshot::record");
+    if (!resolveAnyConfigErrors())
+        return;
+
+    if (m_recordWindow != nullptr) {
+        emit captureFailed();
+        return;
+    }
+    QRect region = req.initialSelection();
+    if (region.isNull()) {
+        region = ScreenGrabber().screenGeometry(
+          QGuiAppCurrentScreen().currentScreen());
+    }
+    QString path = req.path();
+    if (path.isEmpty()) {
+        path = ConfigHandler().savePath();
+        if (path.isEmpty() || !QDir(path).exists()) {
+            path = QStandardPaths::writableLocation(
+              QStandardPaths::PicturesLocation);
+        }
+    }
+    // GIF unless a file name with another format was given
+    QFileInfo info(path);
+    QString format = info.isDir() ? QString() : info.suffix();
+    if (format.isEmpty()) {
+        format = QStringLiteral("gif");
+    }
+    path = FileNameHandler().reserveScreenshotPath(path, format);
+
+    const QVariantMap options = req.data().toMap();
+    auto* widget =
+      new RecordWidget(region,
+                       options.value(QStringLiteral("fps")).toInt(),
+                       options.value(QStringLiteral("duration")).toInt());
+    connect(widget,
+            &RecordWidget::recordingSaved,
+            this,
+            [this](const QString& path) {
+                AbstractLogger().attachNotificationPath(path)
+                  << tr("Recording saved as ") + path;
+                emit recordingSaved(path);
+            });
+    connect(
+      widget, &RecordWidget::recordingFailed, this, &Flameshot::captureFailed);
+    if (!widget->start(path)) {
+        delete widget;
+        // reserveScreenshotPath created it
+        QFile::remove(path);
+        emit captureFailed();
+        return;
+    }
+    m_recordWindow = widget;
+}
+
 void Flameshot::launcher()
 {
     if (!resolveAnyConfigErrors())
@@ -284,7 +394,7 @@ bool Flameshot::resolveAnyConfigErrors()
 {
     bool resolved = true;
     ConfigHandler config;
-    if (!config.checkUnrecognizedSettings() || !config.checkSemantics()) {
+    if (config.hasInvalidSettings()) {
         auto* resolver = new ConfigResolver();
         QObject::connect(
           resolver, &ConfigResolver::rejected, [resolver, &resolved]() {
@@ -331,6 +441,14 @@ void Flameshot::requestCapture(const CaptureRequest& request)
               request.delay(), this, [this, request]() { gui(request); });
             break;
         }
+        case CaptureRequest::SCROLL_MODE:
+            QTimer::singleShot(
+              request.delay(), this, [this, request]() { scroll(request); });
+            break;
+        case CaptureRequest::RECORD_MODE:
+            QTimer::singleShot(
+              request.delay(), this, [this, request]() { record(request); });
+            break;
         default:
             emit captureFailed();
             break;
@@ -341,6 +459,7 @@ void Flameshot::exportCapture(QPixmap capture,
                               QRect& selection,
                               const CaptureRequest& req)
 {
+    TRACE_SPAN("Flameshot::exportCapture");
     using CR = CaptureRequest;
     int tasks = req.tasks(), mode = req.captureMode();
     QString path = req.path();
@@ -9,8 +9,11 @@
 #include <QVersionNumber>
 
 class CaptureWidget;
+class QWidget;
 class ConfigWindow;
 class InfoWindow;
+class ScrollCaptureWidget;
+class RecordWidget;
 class CaptureLauncher;
 class UploadHistory;
 #if (defined(Q_OS_MAC) || defined(Q_OS_MAC64) || defined(Q_OS_MACOS) ||        \
@@ -36,6 +39,8 @@ public slots:
       const CaptureRequest& req = CaptureRequest::GRAPHICAL_MODE);
     void screen(CaptureRequest req, const int screenNumber = -1);
     void full(const CaptureRequest& req);
+    void scroll(const CaptureRequest& req);
+    void record(const CaptureRequest& req);
     void launcher();
     void config();
 
@@ -51,6 +56,7 @@ public:
 signals:
     void captureTaken(QPixmap p);
     void captureFailed();
+    void recordingSaved(const QString& path);
 
 public slots:
     void requestCapture(const CaptureRequest& request);
@@ -63,10 +69,13 @@ private:
     // class members
     static Origin m_origin;
 
-    QPointer<CaptureWidget> m_captureWindow;
+    // Either a CaptureWidget or a SelectionCaptureWidget
+    QPointer<QWidget> m_captureWindow;
     QPointer<InfoWindow> m_infoWindow;
     QPointer<CaptureLauncher> m_launcherWindow;
     QPointer<ConfigWindow> m_configWindow;
+    QPointer<ScrollCaptureWidget> m_scrollCaptureWindow;
+    QPointer<RecordWidget> m_recordWindow;
 
 #if (defined(Q_OS_MAC) || defined(Q_OS_MAC64) || defined(Q_OS_MACOS) ||        \
      defined(Q_OS_MACX))
@@ -5,7 +5,9 @@
 #include "flameshot.h"
 #include "pinwidget.h"
 #include "screenshotsaver.h"
+#include "src/tools/imgupload/uploadqueue.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/tracing.h"
 #include "src/widgets/capture/capturewidget.h"
 #include "src/widgets/trayicon.h"
 #include <QApplication>
@@ -99,11 +101,21 @@ void FlameshotDaemon::start()
         // Tray icon needs FlameshotDaemon::instance() to be non-null
         m_instance->initTrayIcon();
         qApp->setQuitOnLastWindowClosed(false);
+        // Uploads interrupted by the end of the previous daemon
+        UploadQueue* uploads = UploadQueue::instance();
+        connect(uploads, &UploadQueue::activityChanged, m_instance, []() {
+            m_instance->updateUploadStatus();
+            if (UploadQueue::instance()->isIdle()) {
+                m_instance->quitIfIdle();
+            }
+        });
+        uploads->resume();
     }
 }
 
 void FlameshotDaemon::createPin(QPixmap capture, QRect geometry)
 {
+    TRACE_SPAN("FlameshotDaemon::createPin");
     if (instance()) {
         instance()->attachPin(capture, geometry);
         return;
@@ -120,6 +132,7 @@ void FlameshotDaemon::createPin(QPixmap capture, QRect geometry)
 
 void FlameshotDaemon::copyToClipboard(QPixmap capture)
 {
+    TRACE_SPAN("FlameshotDaemon::copyToClipboard");
     if (instance()) {
         instance()->attachScreenshotToClipboard(capture);
         return;
@@ -138,6 +151,7 @@ void FlameshotDaemon::copyToClipboard(QPixmap capture)
 
 void FlameshotDaemon::copyToClipboard(QString text, QString notification)
 {
+    TRACE_SPAN("FlameshotDaemon::copyToClipboard");
     if (instance()) {
         instance()->attachTextToClipboard(text, notification);
         return;
@@ -151,6 +165,34 @@ void FlameshotDaemon::copyToClipboard(QString text, QString notification)
     sessionBus.call(m);
 }
 
+void FlameshotDaemon::upload(const QString& id,
+                             const QString& storage,
+                             const QString& name,
+                             const QByteArray& png)
+{
+    TRACE_SPAN("FlameshotDaemon::upload");
+    if (instance()) {
+        instance()->attachUpload(id, storage, name, png);
+        return;
+    }
+
+    QDBusMessage m = createMethodCall(QStringLiteral("attachUpload"));
+    m << id << storage << name << png;
+    call(m);
+}
+
+void FlameshotDaemon::cancelUpload(const QString& id)
+{
+    if (instance()) {
+        instance()->detachUpload(id);
+        return;
+    }
+
+    QDBusMessage m = createMethodCall(QStringLiteral("cancelUpload"));
+    m << id;
+    call(m);
+}
+
 /**
  * @brief Is this instance of flameshot hosting any windows as a daemon?
  */
@@ -240,15 +282,37 @@ void FlameshotDaemon::quitIfIdle()
     if (m_persist) {
         return;
     }
-    if (!m_hostingClipboard && m_widgets.isEmpty()) {
+    if (!m_hostingClipboard && m_widgets.isEmpty() &&
+        UploadQueue::instance()->isIdle()) {
         qApp->exit(0);
     }
 }
 
+void FlameshotDaemon::updateUploadStatus()
+{
+    if (m_trayIcon == nullptr) {
+        return;
+    }
+    UploadQueue* uploads = UploadQueue::instance();
+    if (uploads->isIdle()) {
+        m_trayIcon->setToolTip(QStringLiteral("Flameshot"));
+        return;
+    }
+    qint64 sent, total;
+    uploads->progress(sent, total);
+    QString status =
+      tr("Uploading %n screenshot(s)", "", uploads->pendingCount());
+    if (total > 0) {
+        status += QStringLiteral(" (%1%)").arg(sent * 100 / total);
+    }
+    m_trayIcon->setToolTip(QStringLiteral("Flameshot\n") + status);
+}
+
 // SERVICE METHODS
 
 void FlameshotDaemon::attachPin(QPixmap pixmap, QRect geometry)
 {
+    TRACE_SPAN("FlameshotDaemon::attachPin");
     auto* pinWidget = new PinWidget(pixmap, geometry);
     m_widgets.append(pinWidget);
     connect(pinWidget, &QObject::destroyed, this, [=]() {
@@ -262,6 +326,7 @@ void FlameshotDaemon::attachPin(QPixmap pixmap, QRect geometry)
 
 void FlameshotDaemon::attachScreenshotToClipboard(QPixmap pixmap)
 {
+    TRACE_SPAN("FlameshotDaemon::attachScreenshotToClipboard");
     m_hostingClipboard = true;
     QClipboard* clipboard = QApplication::clipboard();
     clipboard->blockSignals(true);
@@ -276,6 +341,7 @@ void FlameshotDaemon::attachScreenshotToClipboard(QPixmap pixmap)
 
 void FlameshotDaemon::attachPin(const QByteArray& data)
 {
+    TRACE_SPAN("FlameshotDaemon::attachPin");
     QDataStream stream(data);
     QPixmap pixmap;
     QRect geometry;
@@ -288,6 +354,7 @@ void FlameshotDaemon::attachPin(const QByteArray& data)
 
 void FlameshotDaemon::attachScreenshotToClipboard(const QByteArray& screenshot)
 {
+    TRACE_SPAN("FlameshotDaemon::attachScreenshotToClipboard");
     QDataStream stream(screenshot);
     QPixmap p;
     stream >> p;
@@ -297,7 +364,8 @@ void FlameshotDaemon::attachScreenshotToClipboard(const QByteArray& screenshot)
 
 void FlameshotDaemon::attachTextToClipboard(QString text, QString notification)
 {
-    // Must send notification before clipboard modification on linux
+    TRACE_SPAN("FlameshotDaemon::attachTextToClipboard");
+    // Queued, the notification doesn't wait for the notification server
     if (!notification.isEmpty()) {
         AbstractLogger::info() << notification;
     }
@@ -313,6 +381,20 @@ void FlameshotDaemon::attachTextToClipboard(QString text, QString notification)
     clipboard->blockSignals(false);
 }
 
+void FlameshotDaemon::attachUpload(const QString& id,
+                                   const QString& storage,
+                                   const QString& name,
+                                   const QByteArray& png)
+{
+    TRACE_SPAN("FlameshotDaemon::attachUpload");
+    UploadQueue::instance()->enqueue(id, storage, name, png);
+}
+
+void FlameshotDaemon::detachUpload(const QString& id)
+{
+    UploadQueue::instance()->cancel(id);
+}
+
 void FlameshotDaemon::initTrayIcon()
 {
 #if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
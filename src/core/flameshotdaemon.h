@@ -23,6 +23,12 @@ public:
     static void createPin(QPixmap capture, QRect geometry);
     static void copyToClipboard(QPixmap capture);
     static void copyToClipboard(QString text, QString notification = "");
+    // Queues an upload on the UploadQueue of the daemon
+    static void upload(const QString& id,
+                       const QString& storage,
+                       const QString& name,
+                       const QByteArray& png);
+    static void cancelUpload(const QString& id);
     static bool isThisInstanceHostingWidgets();
 
     void sendTrayNotification(
@@ -48,9 +54,15 @@ private:
     void attachPin(const QByteArray& data);
     void attachScreenshotToClipboard(const QByteArray& screenshot);
     void attachTextToClipboard(QString text, QString notification);
+    void attachUpload(const QString& id,
+                      const QString& storage,
+                      const QString& name,
+                      const QByteArray& png);
+    void detachUpload(const QString& id);
 
     void initTrayIcon();
     void enableTrayIcon(bool enable);
+    void updateUploadStatus();
 
 private slots:
     void handleReplyCheckUpdates(QNetworkReply* reply);
@@ -3,10 +3,27 @@
 
 #include "flameshotdbusadapter.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/tools/imgupload/uploadqueue.h"
 
 FlameshotDBusAdapter::FlameshotDBusAdapter(QObject* parent)
   : QDBusAbstractAdaptor(parent)
-{}
+{
+    UploadQueue* uploads = UploadQueue::instance();
+    connect(uploads,
+            &UploadQueue::uploadProgress,
+            this,
+            &FlameshotDBusAdapter::uploadProgress);
+    connect(uploads,
+            &UploadQueue::uploaded,
+            this,
+            [this](const QString& id, const QUrl& url, const QString& name) {
+                emit uploadFinished(id, url.toString(), name);
+            });
+    connect(uploads,
+            &UploadQueue::failed,
+            this,
+            &FlameshotDBusAdapter::uploadFailed);
+}
 
 FlameshotDBusAdapter::~FlameshotDBusAdapter() = default;
 
@@ -25,3 +42,16 @@ void FlameshotDBusAdapter::attachPin(const QByteArray& data)
 {
     FlameshotDaemon::instance()->attachPin(data);
 }
+
+void FlameshotDBusAdapter::attachUpload(QString id,
+                                        QString storage,
+                                        QString name,
+                                        const QByteArray& png)
+{
+    FlameshotDaemon::instance()->attachUpload(id, storage, name, png);
+}
+
+void FlameshotDBusAdapter::cancelUpload(QString id)
+{
+    FlameshotDaemon::instance()->detachUpload(id);
+}
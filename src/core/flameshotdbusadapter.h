@@ -14,8 +14,19 @@ public:
     explicit FlameshotDBusAdapter(QObject* parent = nullptr);
     virtual ~FlameshotDBusAdapter();
 
+signals:
+    // Relayed from the UploadQueue of the daemon
+    void uploadProgress(QString id, qint64 sent, qint64 total);
+    void uploadFinished(QString id, QString url, QString historyName);
+    void uploadFailed(QString id, QString error);
+
 public slots:
     Q_NOREPLY void attachScreenshotToClipboard(const QByteArray& data);
     Q_NOREPLY void attachTextToClipboard(QString text, QString notification);
     Q_NOREPLY void attachPin(const QByteArray& data);
+    Q_NOREPLY void attachUpload(QString id,
+                                QString storage,
+                                QString name,
+                                const QByteArray& png);
+    Q_NOREPLY void cancelUpload(QString id);
 };
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "headlessrenderer.h"
+#include "abstractlogger.h"
+#include "src/tools/annotationdocument.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QPainter>
+#include <QPixmap>
+#include <QTextStream>
+#include <QtConcurrent>
+
+namespace {
+
+struct PreparedJob
+{
+    HeadlessRenderer::Job job;
+    QList<CaptureTool*> objects;
+    QString error;
+};
+
+QString outputPath(const HeadlessRenderer::Job& job)
+{
+    QFileInfo output(job.output);
+    if (output.isDir()) {
+        return QDir(job.output).filePath(QFileInfo(job.input).fileName());
+    }
+    return job.output;
+}
+
+// Runs in a worker thread, only the tool objects of this job are touched
+void render(PreparedJob& prepared)
+{
+    if (!prepared.error.isEmpty()) {
+        return;
+    }
+    QImageReader reader(prepared.job.input);
+    QImage image = reader.read();
+    if (image.isNull()) {
+        prepared.error = QObject::tr("Unable to read image %1: %2")
+                           .arg(prepared.job.input)
+                           .arg(reader.errorString());
+        return;
+    }
+    // Same format as the screenshots CaptureWidget draws on
+    image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(1);
+
+    for (auto* tool : prepared.objects) {
+        // The tools that read what is under them (pixelate, invert...) need a
+        // pixmap, the offscreen platform supports them outside the GUI thread
+        QPixmap background;
+        if (!tool->isProcessThreadSafe()) {
+            background = QPixmap::fromImage(image);
+        }
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        tool->process(painter, background);
+    }
+
+    const QString path = outputPath(prepared.job);
+    if (!image.save(path)) {
+        prepared.error = QObject::tr("Unable to write image %1").arg(path);
+    }
+}
+
+} // unnamed namespace
+
+namespace HeadlessRenderer {
+
+bool readBatch(const QString& path, QVector<Job>& jobs, QString& error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        error = QObject::tr("Unable to open %1").arg(path);
+        return false;
+    }
+    QTextStream stream(&file);
+    int lineNumber = 0;
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine();
+        ++lineNumber;
+        if (line.trimmed().isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const QStringList fields = line.split('\t');
+        if (fields.size() != 3) {
+            error = QObject::tr("%1:%2: expected input, annotations and "
+                                "output separated by tabs")
+                      .arg(path)
+                      .arg(lineNumber);
+            return false;
+        }
+        jobs << Job{ fields[0], fields[1], fields[2] };
+    }
+    return true;
+}
+
+int run(const QVector<Job>& jobs)
+{
+    // ToolFactory and the tools read ConfigHandler, which must stay in the
+    // GUI thread, only the rasterization is spread over the thread pool
+    QVector<PreparedJob> prepared;
+    prepared.reserve(jobs.size());
+    for (const Job& job : jobs) {
+        PreparedJob p;
+        p.job = job;
+        if (!AnnotationDocument::read(job.annotations, p.objects, p.error)) {
+            p.error = QObject::tr("Unable to read annotations %1: %2")
+                        .arg(job.annotations)
+                        .arg(p.error);
+        }
+        prepared << p;
+    }
+
+    QtConcurrent::blockingMap(prepared, render);
+
+    int failed = 0;
+    for (PreparedJob& p : prepared) {
+        qDeleteAll(p.objects);
+        if (!p.error.isEmpty()) {
+            AbstractLogger::error(AbstractLogger::Stderr) << p.error;
+            ++failed;
+        }
+    }
+    return failed;
+}
+
+} // namespace
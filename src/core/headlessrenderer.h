@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+// Backend of `flameshot render`: applies annotation documents (see
+// AnnotationDocument) to existing images without showing any window, so that
+// screenshots can be annotated by scripts and CI jobs.
+namespace HeadlessRenderer {
+
+struct Job
+{
+    QString input;
+    QString annotations;
+    // Output file, or an existing directory to save to under the input name
+    QString output;
+};
+
+// Reads "input<TAB>annotations<TAB>output" lines, empty lines and lines
+// starting with '#' are skipped
+bool readBatch(const QString& path, QVector<Job>& jobs, QString& error);
+
+// Renders the jobs in parallel, the tool objects are created in the calling
+// thread, which must be the GUI thread. Returns the number of failed jobs.
+int run(const QVector<Job>& jobs);
+
+} // namespace
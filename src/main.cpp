@@ -13,6 +13,7 @@
 #include "src/core/capturerequest.h"
 #include "src/core/flameshot.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/core/headlessrenderer.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/pathinfo.h"
@@ -55,6 +56,10 @@ void requestCaptureAndWait(const CaptureRequest& req)
             qApp->exit(0);
         }
     });
+    // Nothing is left to host once a recording is saved
+    QObject::connect(flameshot, &Flameshot::recordingSaved, [](QString) {
+        qApp->exit(0);
+    });
     QObject::connect(flameshot, &Flameshot::captureFailed, []() {
         AbstractLogger::info() << "Screenshot aborted.";
         qApp->exit(1);
@@ -161,6 +166,15 @@ int main(int argc, char* argv[])
                                    QObject::tr("Configure") + " flameshot.");
     CommandArgument screenArgument(QStringLiteral("screen"),
                                    QObject::tr("Capture a single screen."));
+    CommandArgument scrollArgument(
+      QStringLiteral("scroll"),
+      QObject::tr("Capture a region while scrolling it, as one tall image."));
+    CommandArgument recordArgument(
+      QStringLiteral("record"),
+      QObject::tr("Record a region as an animated GIF or PNG."));
+    CommandArgument renderArgument(
+      QStringLiteral("render"),
+      QObject::tr("Draw annotations on existing images, without a display."));
 
     // Options
     CommandOption pathOption(
@@ -182,6 +196,10 @@ int main(int argc, char* argv[])
     CommandOption filenameOption({ "f", "filename" },
                                  QObject::tr("Set the filename pattern"),
                                  QStringLiteral("pattern"));
+    CommandOption openOption(
+      "open",
+      QObject::tr("Edit a project saved during an earlier capture"),
+      QStringLiteral("path"));
     CommandOption acceptOnSelectOption(
       { "s", "accept-on-select" },
       QObject::tr("Accept capture as soon as a selection is made"));
@@ -217,6 +235,33 @@ int main(int argc, char* argv[])
         QObject::tr("default: screen containing the cursor"),
       QObject::tr("Screen number"),
       QStringLiteral("-1"));
+    CommandOption fpsOption("fps",
+                            QObject::tr("Frames recorded per second"),
+                            QStringLiteral("fps"),
+                            QStringLiteral("10"));
+    CommandOption durationOption(
+      "duration",
+      QObject::tr("Duration of the recording in seconds, it can be stopped "
+                  "earlier"),
+      QStringLiteral("seconds"),
+      QStringLiteral("10"));
+
+    CommandOption inputOption({ "i", "input" },
+                              QObject::tr("Image to annotate"),
+                              QStringLiteral("path"));
+    CommandOption annotationsOption(
+      { "a", "annotations" },
+      QObject::tr("JSON or binary annotation document to draw"),
+      QStringLiteral("path"));
+    CommandOption outputOption(
+      { "o", "output" },
+      QObject::tr("Existing directory or new file to save to"),
+      QStringLiteral("path"));
+    CommandOption batchOption(
+      { "b", "batch" },
+      QObject::tr("File listing one 'input<TAB>annotations<TAB>output' "
+                  "job per line, rendered in parallel"),
+      QStringLiteral("path"));
 
     // Add checkers
     auto colorChecker = [](const QString& colorCode) -> bool {
@@ -243,6 +288,20 @@ int main(int argc, char* argv[])
         int value = delayValue.toInt(&ok);
         return ok && value >= 0;
     };
+    const QString fpsErr =
+      QObject::tr("Invalid frame rate, it must be between 1 and 30");
+    auto fpsChecker = [](const QString& fpsValue) -> bool {
+        bool ok;
+        int value = fpsValue.toInt(&ok);
+        return ok && value >= 1 && value <= 30;
+    };
+    const QString durationErr =
+      QObject::tr("Invalid duration, it must be between 1 and 60 seconds");
+    auto durationChecker = [](const QString& durationValue) -> bool {
+        bool ok;
+        int value = durationValue.toInt(&ok);
+        return ok && value >= 1 && value <= 60;
+    };
     auto regionChecker = [](const QString& region) -> bool {
         Region valueHandler;
         return valueHandler.check(region);
@@ -272,7 +331,14 @@ int main(int argc, char* argv[])
     mainColorOption.addChecker(colorChecker, colorErr);
     delayOption.addChecker(numericChecker, delayErr);
     regionOption.addChecker(regionChecker, regionErr);
+    fpsOption.addChecker(fpsChecker, fpsErr);
+    durationOption.addChecker(durationChecker, durationErr);
     pathOption.addChecker(pathChecker, pathErr);
+    const QString projectErr = QObject::tr("Invalid project, no such file");
+    openOption.addChecker(
+      [](const QString& path) -> bool { return QFileInfo(path).isFile(); },
+      projectErr);
+    outputOption.addChecker(pathChecker, pathErr);
     trayOption.addChecker(booleanChecker, booleanErr);
     autostartOption.addChecker(booleanChecker, booleanErr);
     showHelpOption.addChecker(booleanChecker, booleanErr);
@@ -282,8 +348,11 @@ int main(int argc, char* argv[])
     parser.AddArgument(guiArgument);
     parser.AddArgument(screenArgument);
     parser.AddArgument(fullArgument);
+    parser.AddArgument(scrollArgument);
+    parser.AddArgument(recordArgument);
     parser.AddArgument(launcherArgument);
     parser.AddArgument(configArgument);
+    parser.AddArgument(renderArgument);
     auto helpOption = parser.addHelpOption();
     auto versionOption = parser.addVersionOption();
     parser.AddOptions({ pathOption,
@@ -294,7 +363,8 @@ int main(int argc, char* argv[])
                         selectionOption,
                         uploadOption,
                         pinOption,
-                        acceptOnSelectOption },
+                        acceptOnSelectOption,
+                        openOption },
                       guiArgument);
     parser.AddOptions({ screenNumberOption,
                         clipboardOption,
@@ -312,6 +382,16 @@ int main(int argc, char* argv[])
                         rawImageOption,
                         uploadOption },
                       fullArgument);
+    parser.AddOptions({ pathOption,
+                        clipboardOption,
+                        delayOption,
+                        regionOption,
+                        rawImageOption,
+                        uploadOption },
+                      scrollArgument);
+    parser.AddOptions(
+      { pathOption, delayOption, regionOption, fpsOption, durationOption },
+      recordArgument);
     parser.AddOptions({ autostartOption,
                         filenameOption,
                         trayOption,
@@ -320,6 +400,9 @@ int main(int argc, char* argv[])
                         contrastColorOption,
                         checkOption },
                       configArgument);
+    parser.AddOptions(
+      { inputOption, annotationsOption, outputOption, batchOption },
+      renderArgument);
     // Parse
     if (!parser.parse(qApp->arguments())) {
         goto finish;
@@ -365,7 +448,11 @@ int main(int argc, char* argv[])
         bool pin = parser.isSet(pinOption);
         bool upload = parser.isSet(uploadOption);
         bool acceptOnSelect = parser.isSet(acceptOnSelectOption);
+        QString project = parser.value(openOption);
         CaptureRequest req(CaptureRequest::GRAPHICAL_MODE, delay, path);
+        if (!project.isEmpty()) {
+            req.setProjectPath(QFileInfo(project).absoluteFilePath());
+        }
         if (!region.isEmpty()) {
             req.setInitialSelection(Region().value(region).toRect());
         }
@@ -434,6 +521,67 @@ int main(int argc, char* argv[])
             req.addSaveTask();
         }
         requestCaptureAndWait(req);
+    } else if (parser.isSet(scrollArgument)) { // SCROLL
+        // Recreate the application as a QApplication
+        // TODO find a way so we don't have to do this
+        delete qApp;
+        new QApplication(argc, argv);
+
+        // Option values
+        QString path = parser.value(pathOption);
+        if (!path.isEmpty()) {
+            path = QDir(path).absolutePath();
+        }
+        int delay = parser.value(delayOption).toInt();
+        QString region = parser.value(regionOption);
+        bool clipboard = parser.isSet(clipboardOption);
+        bool raw = parser.isSet(rawImageOption);
+        bool upload = parser.isSet(uploadOption);
+
+        CaptureRequest req(CaptureRequest::SCROLL_MODE, delay);
+        if (!region.isEmpty()) {
+            req.setInitialSelection(Region().value(region).toRect());
+        }
+        if (clipboard) {
+            req.addTask(CaptureRequest::COPY);
+        }
+        if (!path.isEmpty()) {
+            req.addSaveTask(path);
+        }
+        if (raw) {
+            req.addTask(CaptureRequest::PRINT_RAW);
+        }
+        if (upload) {
+            req.addTask(CaptureRequest::UPLOAD);
+        }
+        if (!clipboard && path.isEmpty() && !raw && !upload) {
+            req.addSaveTask();
+        }
+        requestCaptureAndWait(req);
+    } else if (parser.isSet(recordArgument)) { // RECORD
+        // Recreate the application as a QApplication
+        // TODO find a way so we don't have to do this
+        delete qApp;
+        new QApplication(argc, argv);
+
+        // Option values
+        QString path = parser.value(pathOption);
+        if (!path.isEmpty()) {
+            path = QDir(path).absolutePath();
+        }
+        int delay = parser.value(delayOption).toInt();
+        QString region = parser.value(regionOption);
+        QVariantMap options;
+        options[QStringLiteral("fps")] = parser.value(fpsOption).toInt();
+        options[QStringLiteral("duration")] =
+          parser.value(durationOption).toInt() * 1000;
+
+        CaptureRequest req(CaptureRequest::RECORD_MODE, delay, options);
+        if (!region.isEmpty()) {
+            req.setInitialSelection(Region().value(region).toRect());
+        }
+        req.addSaveTask(path);
+        requestCaptureAndWait(req);
     } else if (parser.isSet(screenArgument)) { // SCREEN
         // Recreate the application as a QApplication
         // TODO find a way so we don't have to do this
@@ -487,6 +635,41 @@ int main(int argc, char* argv[])
         }
 
         requestCaptureAndWait(req);
+    } else if (parser.isSet(renderArgument)) { // RENDER
+        QVector<HeadlessRenderer::Job> jobs;
+        if (parser.isSet(batchOption)) {
+            QString error;
+            if (!HeadlessRenderer::readBatch(
+                  parser.value(batchOption), jobs, error)) {
+                AbstractLogger::error(AbstractLogger::Stderr) << error;
+                return 1;
+            }
+        }
+        if (parser.isSet(inputOption) || parser.isSet(annotationsOption) ||
+            parser.isSet(outputOption)) {
+            if (!parser.isSet(inputOption) ||
+                !parser.isSet(annotationsOption) ||
+                !parser.isSet(outputOption)) {
+                AbstractLogger::error(AbstractLogger::Stderr)
+                  << QObject::tr("--input, --annotations and --output must "
+                                 "be used together");
+                return 1;
+            }
+            jobs << HeadlessRenderer::Job{ parser.value(inputOption),
+                                           parser.value(annotationsOption),
+                                           parser.value(outputOption) };
+        }
+        if (jobs.isEmpty()) {
+            AbstractLogger::error(AbstractLogger::Stderr)
+              << QObject::tr("Nothing to render. See") +
+                   " flameshot render --help.";
+            return 1;
+        }
+        // No window is ever shown, so no display is required
+        delete qApp;
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        new QApplication(argc, argv);
+        return HeadlessRenderer::run(jobs) == 0 ? 0 : 1;
     } else if (parser.isSet(configArgument)) { // CONFIG
         bool autostart = parser.isSet(autostartOption);
         bool filename = parser.isSet(filenameOption);
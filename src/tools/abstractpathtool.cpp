@@ -131,6 +131,41 @@ void AbstractPathTool::move(const QPoint& mousePos)
     }
 }
 
+void AbstractPathTool::saveState(QVariantMap& state) const
+{
+    CaptureTool::saveState(state);
+    QVariantList points;
+    points.reserve(m_points.size());
+    for (const auto& point : m_points) {
+        points << pointToVariant(point);
+    }
+    state[QStringLiteral("color")] = m_color.name(QColor::HexArgb);
+    state[QStringLiteral("size")] = m_thickness;
+    state[QStringLiteral("points")] = points;
+}
+
+bool AbstractPathTool::loadState(const QVariantMap& state)
+{
+    const QVariantList points = state.value(QStringLiteral("points")).toList();
+    const QColor color(state.value(QStringLiteral("color")).toString());
+    if (points.isEmpty() || !color.isValid() ||
+        !CaptureTool::loadState(state)) {
+        return false;
+    }
+    m_color = color;
+    m_thickness = qMax(1, state.value(QStringLiteral("size"), 1).toInt());
+    m_points.clear();
+    m_points.reserve(points.size());
+    for (const auto& point : points) {
+        m_points << variantToPoint(point);
+    }
+    m_pathArea = QRect(m_points.first(), m_points.first());
+    for (const auto& point : m_points) {
+        m_pathArea |= QRect(point, point);
+    }
+    return true;
+}
+
 const QPoint* AbstractPathTool::pos()
 {
     if (m_points.empty()) {
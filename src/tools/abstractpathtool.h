@@ -15,11 +15,14 @@ public:
     bool closeOnButtonPressed() const override;
     bool isSelectable() const override;
     bool showMousePreview() const override;
+    bool isProcessThreadSafe() const override { return true; }
     QRect mousePreviewRect(const CaptureContext& context) const override;
     QRect boundingRect() const override;
     void move(const QPoint& mousePos) override;
     const QPoint* pos() override;
     int size() const override { return m_thickness; };
+    void saveState(QVariantMap& state) const override;
+    bool loadState(const QVariantMap& state) override;
 
 public slots:
     void drawEnd(const QPoint& p) override;
@@ -99,21 +99,25 @@ void AbstractTwoPointTool::drawEnd(const QPoint& p)
 void AbstractTwoPointTool::drawMove(const QPoint& p)
 {
     m_points.second = p;
+    invalidateSprite();
 }
 
 void AbstractTwoPointTool::drawMoveWithAdjustment(const QPoint& p)
 {
     m_points.second = m_points.first + adjustedVector(p - m_points.first);
+    invalidateSprite();
 }
 
 void AbstractTwoPointTool::onColorChanged(const QColor& c)
 {
     m_color = c;
+    invalidateSprite();
 }
 
 void AbstractTwoPointTool::onSizeChanged(int size)
 {
     m_thickness = size;
+    invalidateSprite();
 }
 
 void AbstractTwoPointTool::paintMousePreview(QPainter& painter,
@@ -184,3 +188,29 @@ const QPoint* AbstractTwoPointTool::pos()
 {
     return &m_points.first;
 }
+
+void AbstractTwoPointTool::saveState(QVariantMap& state) const
+{
+    CaptureTool::saveState(state);
+    state[QStringLiteral("color")] = m_color.name(QColor::HexArgb);
+    state[QStringLiteral("size")] = m_thickness;
+    state[QStringLiteral("points")] =
+      QVariantList{ pointToVariant(m_points.first),
+                    pointToVariant(m_points.second) };
+}
+
+bool AbstractTwoPointTool::loadState(const QVariantMap& state)
+{
+    const QVariantList points = state.value(QStringLiteral("points")).toList();
+    const QColor color(state.value(QStringLiteral("color")).toString());
+    if (points.size() != 2 || !color.isValid() ||
+        !CaptureTool::loadState(state)) {
+        return false;
+    }
+    m_color = color;
+    m_thickness = qMax(1, state.value(QStringLiteral("size"), 1).toInt());
+    m_points.first = variantToPoint(points[0]);
+    m_points.second = variantToPoint(points[1]);
+    invalidateSprite();
+    return true;
+}
@@ -15,6 +15,8 @@ public:
     bool closeOnButtonPressed() const override;
     bool isSelectable() const override;
     bool showMousePreview() const override;
+    bool isProcessThreadSafe() const override { return true; }
+    bool isSpriteCacheable() const override { return true; }
     QRect mousePreviewRect(const CaptureContext& context) const override;
     QRect boundingRect() const override;
     void move(const QPoint& pos) override;
@@ -24,6 +26,8 @@ public:
     const QPair<QPoint, QPoint> points() const { return m_points; };
     void paintMousePreview(QPainter& painter,
                            const CaptureContext& context) override;
+    void saveState(QVariantMap& state) const override;
+    bool loadState(const QVariantMap& state) override;
 
 public slots:
     void drawEnd(const QPoint& p) override;
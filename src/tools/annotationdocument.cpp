@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "annotationdocument.h"
+#include "src/tools/toolfactory.h"
+#include <QDataStream>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaEnum>
+
+namespace {
+
+const quint32 DOCUMENT_MAGIC = 0x46534144; // "FSAD"
+const int DOCUMENT_VERSION = 1;
+const QString TYPE_PREFIX = QStringLiteral("TYPE_");
+
+// "arrow" for CaptureTool::TYPE_ARROW
+QString typeName(CaptureTool::Type type)
+{
+    const QMetaEnum types = QMetaEnum::fromType<CaptureTool::Type>();
+    return QString::fromLatin1(types.valueToKey(type))
+      .mid(TYPE_PREFIX.size())
+      .toLower();
+}
+
+CaptureTool::Type typeFromName(const QString& name)
+{
+    const QMetaEnum types = QMetaEnum::fromType<CaptureTool::Type>();
+    bool ok = false;
+    const QByteArray key = (TYPE_PREFIX + name.toUpper()).toLatin1();
+    int type = types.keyToValue(key.constData(), &ok);
+    return ok ? static_cast<CaptureTool::Type>(type) : CaptureTool::NONE;
+}
+
+} // unnamed namespace
+
+namespace AnnotationDocument {
+
+QVariantMap toVariant(const QList<QPointer<CaptureTool>>& objects)
+{
+    QVariantList list;
+    for (const auto& object : objects) {
+        if (object.isNull()) {
+            continue;
+        }
+        QVariantMap state;
+        object->saveState(state);
+        state[QStringLiteral("type")] = typeName(object->type());
+        list << state;
+    }
+    QVariantMap document;
+    document[QStringLiteral("version")] = DOCUMENT_VERSION;
+    document[QStringLiteral("objects")] = list;
+    return document;
+}
+
+bool fromVariant(const QVariantMap& document,
+                 QList<CaptureTool*>& objects,
+                 QString& error)
+{
+    if (document.value(QStringLiteral("version")).toInt() > DOCUMENT_VERSION) {
+        error = QObject::tr("Unsupported annotation document version");
+        return false;
+    }
+    ToolFactory factory;
+    const QVariantList list =
+      document.value(QStringLiteral("objects")).toList();
+    for (int i = 0; i < list.size(); ++i) {
+        const QVariantMap state = list[i].toMap();
+        const QString name = state.value(QStringLiteral("type")).toString();
+        CaptureTool* object = factory.CreateTool(typeFromName(name));
+        // Only the tools that draw objects can be restored
+        if (object == nullptr || !object->isSelectable() ||
+            !object->loadState(state)) {
+            delete object;
+            qDeleteAll(objects);
+            objects.clear();
+            error = QObject::tr("Invalid object %1 of type '%2'")
+                      .arg(i)
+                      .arg(name);
+            return false;
+        }
+        objects << object;
+    }
+    return true;
+}
+
+bool read(QIODevice& device, QList<CaptureTool*>& objects, QString& error)
+{
+    QVariantMap document;
+    const QByteArray head = device.peek(sizeof(DOCUMENT_MAGIC));
+    quint32 magic = 0;
+    QDataStream(head) >> magic;
+    if (magic == DOCUMENT_MAGIC) {
+        qint32 version = 0;
+        QDataStream stream(&device);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream >> magic >> version >> document;
+        if (stream.status() != QDataStream::Ok) {
+            error = QObject::tr("Corrupted annotation document");
+            return false;
+        }
+    } else {
+        QJsonParseError parseError;
+        QJsonDocument json =
+          QJsonDocument::fromJson(device.readAll(), &parseError);
+        if (!json.isObject()) {
+            error = parseError.errorString();
+            return false;
+        }
+        document = json.object().toVariantMap();
+    }
+    return fromVariant(document, objects, error);
+}
+
+bool read(const QString& path, QList<CaptureTool*>& objects, QString& error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    return read(file, objects, error);
+}
+
+bool write(QIODevice& device,
+           const QList<QPointer<CaptureTool>>& objects,
+           Format format)
+{
+    const QVariantMap document = toVariant(objects);
+    if (format == JSON) {
+        QByteArray data = QJsonDocument(QJsonObject::fromVariantMap(document))
+                            .toJson(QJsonDocument::Compact);
+        return device.write(data) == data.size();
+    }
+    QDataStream stream(&device);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << DOCUMENT_MAGIC << static_cast<qint32>(DOCUMENT_VERSION)
+           << document;
+    return stream.status() == QDataStream::Ok;
+}
+
+} // namespace
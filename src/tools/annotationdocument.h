@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/capturetool.h"
+#include <QList>
+#include <QPointer>
+
+class QIODevice;
+
+// List of capture tool objects, stored either as JSON:
+//
+//   { "version": 1,
+//     "objects": [ { "type": "arrow", "color": "#ffff0000", "size": 3,
+//                    "points": [[10, 10], [200, 120]] }, ... ] }
+//
+// or as the same map written with QDataStream after a binary header. The
+// format is detected when reading. The keys of each object are the ones of
+// CaptureTool::saveState().
+namespace AnnotationDocument {
+
+enum Format
+{
+    JSON,
+    BINARY
+};
+
+// Creates the objects with ToolFactory, the caller takes their ownership.
+// Returns false and sets error if the document can't be read.
+bool read(QIODevice& device, QList<CaptureTool*>& objects, QString& error);
+bool read(const QString& path, QList<CaptureTool*>& objects, QString& error);
+
+bool write(QIODevice& device,
+           const QList<QPointer<CaptureTool>>& objects,
+           Format format);
+
+QVariantMap toVariant(const QList<QPointer<CaptureTool>>& objects);
+bool fromVariant(const QVariantMap& document,
+                 QList<CaptureTool*>& objects,
+                 QString& error);
+
+} // namespace
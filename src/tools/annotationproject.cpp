@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "annotationproject.h"
+#include "src/tools/annotationdocument.h"
+#include <QDataStream>
+#include <QFile>
+#include <QImage>
+#include <QSaveFile>
+
+// Windows maps files at offsets multiple of its 64 KiB allocation granularity,
+// which is also a multiple of the page size everywhere else
+#define PIXELS_ALIGNMENT 65536
+
+namespace {
+
+const quint32 PROJECT_MAGIC = 0x4653504A; // "FSPJ"
+const int PROJECT_VERSION = 1;
+
+struct Header
+{
+    qint32 version = PROJECT_VERSION;
+    qint32 width = 0;
+    qint32 height = 0;
+    qint32 bytesPerLine = 0;
+    qint32 format = QImage::Format_Invalid;
+    double devicePixelRatio = 1;
+    QRect selection;
+    quint64 pixelsOffset = 0;
+};
+
+QDataStream& operator<<(QDataStream& stream, const Header& header)
+{
+    return stream << PROJECT_MAGIC << header.version << header.width
+                  << header.height << header.bytesPerLine << header.format
+                  << header.devicePixelRatio << header.selection
+                  << header.pixelsOffset;
+}
+
+QDataStream& operator>>(QDataStream& stream, Header& header)
+{
+    quint32 magic = 0;
+    stream >> magic;
+    if (magic != PROJECT_MAGIC) {
+        stream.setStatus(QDataStream::ReadCorruptData);
+        return stream;
+    }
+    return stream >> header.version >> header.width >> header.height >>
+           header.bytesPerLine >> header.format >> header.devicePixelRatio >>
+           header.selection >> header.pixelsOffset;
+}
+
+quint64 pixelsSize(const Header& header)
+{
+    return quint64(header.bytesPerLine) * quint64(header.height);
+}
+
+bool isValid(const Header& header, quint64 fileSize)
+{
+    if (header.version > PROJECT_VERSION || header.width <= 0 ||
+        header.height <= 0 || header.format <= QImage::Format_Invalid ||
+        header.format >= QImage::NImageFormats ||
+        header.devicePixelRatio <= 0 ||
+        header.pixelsOffset % PIXELS_ALIGNMENT != 0) {
+        return false;
+    }
+    const QImage::Format format = static_cast<QImage::Format>(header.format);
+    const int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    return qint64(header.bytesPerLine) * 8 >= qint64(header.width) * depth &&
+           header.pixelsOffset + pixelsSize(header) <= fileSize;
+}
+
+void unmapImage(void* file)
+{
+    // Closing the file unmaps the pixels
+    delete static_cast<QFile*>(file);
+}
+
+} // unnamed namespace
+
+namespace AnnotationProject {
+
+QString fileSuffix()
+{
+    return QStringLiteral("fsproj");
+}
+
+bool save(const QString& path,
+          const QPixmap& screenshot,
+          const QRect& selection,
+          const QList<QPointer<CaptureTool>>& objects,
+          QString& error)
+{
+    const QImage image = screenshot.toImage();
+    Header header;
+    header.width = image.width();
+    header.height = image.height();
+    header.bytesPerLine = image.bytesPerLine();
+    header.format = image.format();
+    header.devicePixelRatio = image.devicePixelRatio();
+    header.selection = selection;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    // The offset of the pixels is only known once the objects are written,
+    // the header has a fixed size so it is rewritten in place afterwards
+    stream << header;
+    if (!AnnotationDocument::write(
+          file, objects, AnnotationDocument::BINARY)) {
+        error = file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    header.pixelsOffset =
+      (quint64(file.pos()) + PIXELS_ALIGNMENT - 1) / PIXELS_ALIGNMENT *
+      PIXELS_ALIGNMENT;
+    const QByteArray padding(int(header.pixelsOffset - file.pos()), '\0');
+    const qint64 size = qint64(pixelsSize(header));
+    const char* pixels = reinterpret_cast<const char*>(image.constBits());
+    bool ok = file.write(padding) == padding.size() &&
+              file.write(pixels, size) == size && file.seek(0);
+    stream << header;
+    if (!ok || stream.status() != QDataStream::Ok || !file.commit()) {
+        error = file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    return true;
+}
+
+bool open(const QString& path,
+          QPixmap& screenshot,
+          QRect& selection,
+          QList<CaptureTool*>& objects,
+          QString& error)
+{
+    auto* file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        error = file->errorString();
+        delete file;
+        return false;
+    }
+    Header header;
+    QDataStream stream(file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream >> header;
+    if (stream.status() != QDataStream::Ok ||
+        !isValid(header, quint64(file->size()))) {
+        error = QObject::tr("Invalid or unsupported project file");
+        delete file;
+        return false;
+    }
+    if (!AnnotationDocument::read(*file, objects, error)) {
+        delete file;
+        return false;
+    }
+
+    const qint64 size = qint64(pixelsSize(header));
+    uchar* pixels = file->map(qint64(header.pixelsOffset), size);
+    QImage image;
+    if (pixels != nullptr) {
+        // Read only, painting on the image detaches it from the mapping
+        image = QImage(static_cast<const uchar*>(pixels),
+                       header.width,
+                       header.height,
+                       header.bytesPerLine,
+                       static_cast<QImage::Format>(header.format),
+                       unmapImage,
+                       file);
+    } else {
+        // Fall back to reading the pixels, for file systems without mmap
+        image = QImage(header.width,
+                       header.height,
+                       static_cast<QImage::Format>(header.format));
+        char* bits = reinterpret_cast<char*>(image.bits());
+        if (image.isNull() || image.bytesPerLine() != header.bytesPerLine ||
+            !file->seek(qint64(header.pixelsOffset)) ||
+            file->read(bits, size) != size) {
+            image = QImage();
+        }
+        delete file;
+    }
+    if (image.isNull()) {
+        error = QObject::tr("Unable to load the project image");
+        qDeleteAll(objects);
+        objects.clear();
+        return false;
+    }
+    image.setDevicePixelRatio(header.devicePixelRatio);
+    // Raster pixmaps keep sharing the image, and with it the mapped pages
+    screenshot = QPixmap::fromImage(std::move(image));
+    selection = header.selection;
+    return true;
+}
+
+} // namespace
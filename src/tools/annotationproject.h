@@ -0,0 +1,38 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/capturetool.h"
+#include <QList>
+#include <QPixmap>
+#include <QPointer>
+
+// Editable capture: the unannotated screenshot, the selection and the capture
+// tool objects, so that the annotations can be changed after the capture is
+// closed.
+//
+// The file starts with a small header followed by the objects, in the binary
+// AnnotationDocument format. The pixels are stored uncompressed at an offset
+// aligned for memory mapping, so opening a project maps them instead of
+// reading and decoding them, and the pages are only loaded when accessed.
+namespace AnnotationProject {
+
+// Without the leading dot
+QString fileSuffix();
+
+// selection is in the logical coordinates of the screenshot
+bool save(const QString& path,
+          const QPixmap& screenshot,
+          const QRect& selection,
+          const QList<QPointer<CaptureTool>>& objects,
+          QString& error);
+
+// The caller takes the ownership of the objects
+bool open(const QString& path,
+          QPixmap& screenshot,
+          QRect& selection,
+          QList<CaptureTool*>& objects,
+          QString& error);
+
+} // namespace
@@ -99,8 +99,10 @@ QRect ArrowTool::boundingRect() const
     int min_y = points().first.y();
     int max_x = points().first.x();
     int max_y = points().first.y();
-    for (int i = 0; i < m_arrowPath.elementCount(); i++) {
-        QPointF pt = m_arrowPath.elementAt(i);
+    QPainterPath arrowPath =
+      getArrowHead(points().first, points().second, size());
+    for (int i = 0; i < arrowPath.elementCount(); i++) {
+        QPointF pt = arrowPath.elementAt(i);
         if (static_cast<int>(pt.x()) < min_x) {
             min_x = static_cast<int>(pt.x());
         }
@@ -143,7 +145,6 @@ CaptureTool* ArrowTool::copy(QObject* parent)
 void ArrowTool::copyParams(const ArrowTool* from, ArrowTool* to)
 {
     AbstractTwoPointTool::copyParams(from, to);
-    to->m_arrowPath = this->m_arrowPath;
 }
 
 void ArrowTool::process(QPainter& painter, const QPixmap& pixmap)
@@ -151,8 +152,8 @@ void ArrowTool::process(QPainter& painter, const QPixmap& pixmap)
     Q_UNUSED(pixmap)
     painter.setPen(QPen(color(), size()));
     painter.drawLine(getShorterLine(points().first, points().second, size()));
-    m_arrowPath = getArrowHead(points().first, points().second, size());
-    painter.fillPath(m_arrowPath, QBrush(color()));
+    painter.fillPath(getArrowHead(points().first, points().second, size()),
+                     QBrush(color()));
 }
 
 void ArrowTool::pressed(CaptureContext& context)
@@ -27,7 +27,4 @@ protected:
 
 public slots:
     void pressed(CaptureContext& context) override;
-
-private:
-    QPainterPath m_arrowPath;
 };
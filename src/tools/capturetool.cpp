@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "capturetool.h"
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <cmath>
+
+// Memory for the sprites of all the objects (bytes). Above it, the sprites of
+// the objects drawn least recently are dropped.
+#define SPRITE_CACHE_BUDGET (64 * 1024 * 1024)
+
+namespace {
+
+struct Sprite
+{
+    QImage image;
+    // Size of paintRect() when the sprite was rendered
+    QSize size;
+};
+
+// The tile workers look the sprites up concurrently
+QMutex spriteCacheMutex;
+
+QCache<const CaptureTool*, Sprite>& spriteCache()
+{
+    // Never destroyed, the tools may outlive the static objects
+    static auto* cache =
+      new QCache<const CaptureTool*, Sprite>(SPRITE_CACHE_BUDGET);
+    return *cache;
+}
+
+int spriteCost(const QImage& image)
+{
+    return image.bytesPerLine() * image.height();
+}
+
+// Null without an up to date sprite for rect
+QImage findSprite(const CaptureTool* tool,
+                  const QRect& rect,
+                  qreal devicePixelRatio)
+{
+    QMutexLocker locker(&spriteCacheMutex);
+    const Sprite* sprite = spriteCache().object(tool);
+    if (sprite == nullptr || sprite->size != rect.size() ||
+        sprite->image.devicePixelRatio() != devicePixelRatio) {
+        return {};
+    }
+    return sprite->image;
+}
+
+} // unnamed namespace
+
+CaptureTool::~CaptureTool()
+{
+    invalidateSprite();
+}
+
+void CaptureTool::updateSprite(const QPaintDevice& target)
+{
+    if (!isSpriteCacheable()) {
+        return;
+    }
+    updateBoundingRect();
+    const QRect rect = paintRect();
+    const qreal dpr = target.devicePixelRatioF();
+    // With a fractional ratio, the rasterization of an object depends on its
+    // position within the device pixels
+    if (rect.isEmpty() || dpr != std::floor(dpr)) {
+        invalidateSprite();
+        return;
+    }
+    if (!findSprite(this, rect, dpr).isNull()) {
+        return;
+    }
+    QImage sprite(rect.size() * dpr, QImage::Format_ARGB32_Premultiplied);
+    sprite.setDevicePixelRatio(dpr);
+    // Fonts are sized with the resolution of the target
+    sprite.setDotsPerMeterX(qRound(target.logicalDpiX() / 0.0254));
+    sprite.setDotsPerMeterY(qRound(target.logicalDpiY() / 0.0254));
+    sprite.fill(Qt::transparent);
+    {
+        QPainter painter(&sprite);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.translate(-rect.topLeft());
+        process(painter, QPixmap());
+    }
+    QMutexLocker locker(&spriteCacheMutex);
+    // A sprite above the whole budget isn't kept, its object is drawn
+    // directly
+    spriteCache().insert(
+      this, new Sprite{ sprite, rect.size() }, spriteCost(sprite));
+}
+
+void CaptureTool::drawCached(QPainter& painter, const QPixmap& pixmap)
+{
+    const QRect rect = paintRect();
+    QImage sprite;
+    if (isSpriteCacheable()) {
+        sprite =
+          findSprite(this, rect, painter.device()->devicePixelRatioF());
+    }
+    if (sprite.isNull()) {
+        process(painter, pixmap);
+        return;
+    }
+    const QPainter::CompositionMode mode = painter.compositionMode();
+    painter.setCompositionMode(spriteCompositionMode());
+    painter.drawImage(rect.topLeft(), sprite);
+    painter.setCompositionMode(mode);
+}
+
+void CaptureTool::invalidateSprite()
+{
+    QMutexLocker locker(&spriteCacheMutex);
+    spriteCache().remove(this);
+}
+
+void CaptureTool::shareSprite(const CaptureTool* from, CaptureTool* to)
+{
+    QMutexLocker locker(&spriteCacheMutex);
+    const Sprite* sprite = spriteCache().object(from);
+    if (sprite == nullptr) {
+        spriteCache().remove(to);
+        return;
+    }
+    // The pixels are shared, but counted once per object
+    spriteCache().insert(to, new Sprite(*sprite), spriteCost(sprite->image));
+}
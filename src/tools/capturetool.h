@@ -8,6 +8,7 @@
 #include "src/utils/pathinfo.h"
 #include <QIcon>
 #include <QPainter>
+#include <QVariantMap>
 
 class CaptureTool : public QObject
 {
@@ -83,6 +84,7 @@ public:
       , m_count(0)
       , m_editMode(false)
     {}
+    ~CaptureTool() override;
 
     // TODO unused
     virtual void setCapture(const QPixmap& pixmap){};
@@ -102,6 +104,18 @@ public:
         return {};
     };
     virtual QRect boundingRect() const = 0;
+    // boundingRect() grown by what the strokes of the tool, their caps and
+    // their antialiasing can draw outside of it
+    QRect paintRect() const
+    {
+        const QRect rect = boundingRect();
+        if (rect.isEmpty()) {
+            return rect;
+        }
+        // One more pixel for the antialiasing
+        const int padding = qMax(size(), 0) + 1;
+        return rect + QMargins(padding, padding, padding, padding);
+    }
 
     // The icon of the tool.
     // inEditor is true when the icon is requested inside the editor
@@ -135,11 +149,33 @@ public:
 
     // Counter for all object types (currently is used for the CircleCounter
     // only)
-    virtual void setCount(int count) { m_count = count; };
+    virtual void setCount(int count)
+    {
+        if (count != static_cast<int>(m_count)) {
+            m_count = count;
+            invalidateSprite();
+        }
+    };
     virtual int count() const { return m_count; };
 
     // Called every time the tool has to draw
     virtual void process(QPainter& painter, const QPixmap& pixmap) = 0;
+    // Returns true if process() only draws the tool's own state: it neither
+    // reads the pixmap nor modifies the tool or its widgets. Such tools can be
+    // replayed concurrently onto tiles of the capture.
+    virtual bool isProcessThreadSafe() const { return false; }
+    // Returns true if process() draws the same pixels wherever the object is
+    // moved and whatever the pixmap. The object is then rasterized once into
+    // a sprite, and replays blit it until invalidateSprite() is called.
+    virtual bool isSpriteCacheable() const { return false; }
+    // Renders the sprite for painters on target, unless it is up to date.
+    // Must be called from the thread of the tool before drawCached(). The
+    // sprites of all the objects share a memory budget, the least recently
+    // drawn ones are dropped and rendered again when they are needed.
+    void updateSprite(const QPaintDevice& target);
+    // Blits the sprite, or calls process() without an up to date sprite.
+    // Unlike process(), can be called concurrently after updateSprite().
+    void drawCached(QPainter& painter, const QPixmap& pixmap);
     virtual void drawSearchArea(QPainter& painter, const QPixmap& pixmap)
     {
         process(painter, pixmap);
@@ -156,6 +192,21 @@ public:
     virtual void move(const QPoint& pos) { Q_UNUSED(pos) };
     virtual const QPoint* pos() { return nullptr; };
 
+    // Serialized state of a drawn object. Values are kept JSON compatible
+    // (numbers, strings, lists and maps) so that annotation documents can be
+    // written as JSON as well as with QDataStream.
+    virtual void saveState(QVariantMap& state) const
+    {
+        state[QStringLiteral("count")] = count();
+    }
+    // Restore an object saved by a tool of the same type. Returns false if the
+    // state doesn't describe a valid object.
+    virtual bool loadState(const QVariantMap& state)
+    {
+        setCount(state.value(QStringLiteral("count"), 0).toInt());
+        return true;
+    }
+
 signals:
     void requestAction(Request r);
 
@@ -163,6 +214,20 @@ protected:
     void copyParams(const CaptureTool* from, CaptureTool* to)
     {
         to->m_count = from->m_count;
+        // Shared until one of the tools renders a new one
+        shareSprite(from, to);
+    }
+
+    // Called by cacheable tools when a property their drawing depends on
+    // changes. A move keeping the size of boundingRect() doesn't need it.
+    void invalidateSprite();
+    // Brings boundingRect() up to date before a sprite is rendered, for the
+    // tools which lay their object out in process()
+    virtual void updateBoundingRect() {}
+    // How the sprite is blended with what is below it
+    virtual QPainter::CompositionMode spriteCompositionMode() const
+    {
+        return QPainter::CompositionMode_SourceOver;
     }
 
     QString iconPath(const QColor& c) const
@@ -171,6 +236,20 @@ protected:
                                           : PathInfo::blackIconPath();
     }
 
+    static QVariant pointToVariant(const QPoint& p)
+    {
+        return QVariantList{ p.x(), p.y() };
+    }
+
+    static QPoint variantToPoint(const QVariant& v)
+    {
+        const QVariantList coords = v.toList();
+        if (coords.size() != 2) {
+            return {};
+        }
+        return { coords[0].toInt(), coords[1].toInt() };
+    }
+
     void drawObjectSelectionRect(QPainter& painter, QRect rect)
     {
         QPen orig_pen = painter.pen();
@@ -200,6 +279,8 @@ public slots:
     virtual int size() const { return -1; };
 
 private:
+    static void shareSprite(const CaptureTool* from, CaptureTool* to);
+
     unsigned int m_count;
     bool m_editMode;
 };
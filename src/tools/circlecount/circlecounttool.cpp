@@ -158,6 +158,12 @@ void CircleCountTool::paintMousePreview(QPainter& painter,
     painter.setPen(orig_pen);
 }
 
+bool CircleCountTool::loadState(const QVariantMap& state)
+{
+    m_valid = AbstractTwoPointTool::loadState(state);
+    return m_valid;
+}
+
 void CircleCountTool::drawStart(const CaptureContext& context)
 {
     AbstractTwoPointTool::drawStart(context);
@@ -24,6 +24,7 @@ public:
     void process(QPainter& painter, const QPixmap& pixmap) override;
     void paintMousePreview(QPainter& painter,
                            const CaptureContext& context) override;
+    bool loadState(const QVariantMap& state) override;
 
 protected:
     CaptureTool::Type type() const override;
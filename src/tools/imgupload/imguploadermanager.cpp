@@ -3,49 +3,43 @@
 //
 
 #include "imguploadermanager.h"
+#include "src/utils/confighandler.h"
 #include <QPixmap>
 #include <QWidget>
 
 // TODO - remove this hard-code and create plugin manager in the future, you may
 // include other storage headers here
+#include "storages/http/httpuploader.h"
 #include "storages/imgur/imguruploader.h"
 
 ImgUploaderManager::ImgUploaderManager(QObject* parent)
   : QObject(parent)
   , m_imgUploaderBase(nullptr)
 {
-    // TODO - implement ImgUploader for other Storages and selection among them
-    m_imgUploaderPlugin = IMG_UPLOADER_STORAGE_DEFAULT;
+    m_imgUploaderPlugin = ConfigHandler().uploadStorage();
     init();
 }
 
 void ImgUploaderManager::init()
 {
-    // TODO - implement ImgUploader for other Storages and selection among them,
-    // example:
-    // if (uploaderPlugin().compare("s3") == 0) {
-    //    m_qstrUrl = ImgS3Settings().value("S3", "S3_URL").toString();
-    //} else {
-    //    m_qstrUrl = "https://imgur.com/";
-    //    m_imgUploaderPlugin = "imgur";
-    //}
+    // The URL is the base of the upload history entries, which are all
+    // Imgur uploads
     m_urlString = "https://imgur.com/";
-    m_imgUploaderPlugin = "imgur";
+    if (m_imgUploaderPlugin != QLatin1String(IMG_UPLOADER_STORAGE_HTTP)) {
+        m_imgUploaderPlugin = IMG_UPLOADER_STORAGE_DEFAULT;
+    }
 }
 
 ImgUploaderBase* ImgUploaderManager::uploader(const QPixmap& capture,
                                               QWidget* parent)
 {
-    // TODO - implement ImgUploader for other Storages and selection among them,
-    // example:
-    // if (uploaderPlugin().compare("s3") == 0) {
-    //    m_imgUploaderBase =
-    //      (ImgUploaderBase*)(new ImgS3Uploader(capture, parent));
-    //} else {
-    //    m_imgUploaderBase =
-    //      (ImgUploaderBase*)(new ImgurUploader(capture, parent));
-    //}
-    m_imgUploaderBase = (ImgUploaderBase*)(new ImgurUploader(capture, parent));
+    if (uploaderPlugin() == QLatin1String(IMG_UPLOADER_STORAGE_HTTP)) {
+        m_imgUploaderBase =
+          (ImgUploaderBase*)(new HttpUploader(capture, parent));
+    } else {
+        m_imgUploaderBase =
+          (ImgUploaderBase*)(new ImgurUploader(capture, parent));
+    }
     if (m_imgUploaderBase && !capture.isNull()) {
         m_imgUploaderBase->upload();
     }
@@ -68,3 +62,38 @@ const QString& ImgUploaderManager::url()
 {
     return m_urlString;
 }
+
+QNetworkReply* ImgUploaderManager::sendUpload(const QString& storage,
+                                              const QString& name,
+                                              QNetworkAccessManager* network,
+                                              QIODevice* body)
+{
+    if (storage == QLatin1String(IMG_UPLOADER_STORAGE_DEFAULT)) {
+        return ImgurUploader::send(network, body, name);
+    } else if (storage == QLatin1String(IMG_UPLOADER_STORAGE_HTTP)) {
+        return HttpUploader::send(
+          network, body, HttpUploader::settings(), name);
+    }
+    return nullptr;
+}
+
+bool ImgUploaderManager::parseUploadReply(const QString& storage,
+                                          QNetworkReply* reply,
+                                          QUrl& url,
+                                          QString& deleteToken,
+                                          QString& error)
+{
+    if (storage == QLatin1String(IMG_UPLOADER_STORAGE_DEFAULT)) {
+        return ImgurUploader::parseReply(reply, url, deleteToken, error);
+    } else if (storage == QLatin1String(IMG_UPLOADER_STORAGE_HTTP)) {
+        return HttpUploader::parseReply(
+          reply, HttpUploader::settings(), url, error);
+    }
+    error = tr("Unknown storage: %1").arg(storage);
+    return false;
+}
+
+bool ImgUploaderManager::keepsHistory(const QString& storage)
+{
+    return storage == QLatin1String(IMG_UPLOADER_STORAGE_DEFAULT);
+}
@@ -9,7 +9,11 @@
 #include <QObject>
 
 #define IMG_UPLOADER_STORAGE_DEFAULT "imgur"
+#define IMG_UPLOADER_STORAGE_HTTP "http"
 
+class QIODevice;
+class QNetworkAccessManager;
+class QNetworkReply;
 class QPixmap;
 class QWidget;
 
@@ -26,6 +30,19 @@ public:
     const QString& url();
     const QString& uploaderPlugin();
 
+    // Used by UploadQueue, which only knows the name of the storage of a job
+    static QNetworkReply* sendUpload(const QString& storage,
+                                     const QString& name,
+                                     QNetworkAccessManager* network,
+                                     QIODevice* body);
+    static bool parseUploadReply(const QString& storage,
+                                 QNetworkReply* reply,
+                                 QUrl& url,
+                                 QString& deleteToken,
+                                 QString& error);
+    // The upload history can only rebuild the URLs of Imgur uploads
+    static bool keepsHistory(const QString& storage);
+
 private:
     void init();
 
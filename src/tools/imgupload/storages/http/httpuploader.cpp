@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "httpuploader.h"
+#include "src/utils/confighandler.h"
+#include "src/widgets/notificationwidget.h"
+#include <QHttpMultiPart>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+namespace {
+
+// The file name comes from the user's pattern. Control characters are
+// dropped and quotes escaped, so that the name can't end the parameter or the
+// header. Non-ASCII characters are replaced in the quoted name, and the full
+// name is also sent as an RFC 5987 filename* for the servers which read it.
+QByteArray contentDisposition(const QString& fileName)
+{
+    QString name;
+    QByteArray quoted;
+    bool ascii = true;
+    for (const QChar c : fileName) {
+        if (c.category() == QChar::Other_Control) {
+            continue;
+        }
+        name += c;
+        if (c.unicode() >= 0x80) {
+            quoted += '_';
+            ascii = false;
+            continue;
+        }
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c.toLatin1();
+    }
+    QByteArray header = "form-data; name=\"file\"; filename=\"" + quoted + '"';
+    if (!ascii) {
+        header += "; filename*=UTF-8''" + QUrl::toPercentEncoding(name);
+    }
+    return header;
+}
+
+} // unnamed namespace
+
+HttpUploader::HttpUploader(const QPixmap& capture, QWidget* parent)
+  : ImgUploaderBase(capture, parent)
+{}
+
+void HttpUploader::upload()
+{
+    enqueueUpload(QStringLiteral("http"));
+}
+
+void HttpUploader::deleteImage(const QString& fileName,
+                               const QString& deleteToken)
+{
+    Q_UNUSED(fileName)
+    Q_UNUSED(deleteToken)
+    notification()->showMessage(
+      tr("Deleting is not supported by this storage."));
+}
+
+HttpUploader::Settings HttpUploader::settings()
+{
+    ConfigHandler config;
+    Settings settings;
+    settings.url = config.httpUploadUrl();
+    settings.put =
+      config.httpUploadMethod().compare("PUT", Qt::CaseInsensitive) == 0;
+    settings.multipart = config.httpUploadMultipart();
+    settings.urlPath = config.httpUploadUrlPath();
+    // "Name: value"
+    for (const QString& header : config.httpUploadHeaders()) {
+        int colon = header.indexOf(':');
+        if (colon > 0) {
+            settings.headers << qMakePair(
+              header.left(colon).trimmed().toUtf8(),
+              header.mid(colon + 1).trimmed().toUtf8());
+        }
+    }
+    return settings;
+}
+
+QNetworkReply* HttpUploader::send(QNetworkAccessManager* network,
+                                  QIODevice* body,
+                                  const Settings& settings,
+                                  const QString& name)
+{
+    const QString fileName = name + ".png";
+    QString url = settings.url;
+    url.replace(QStringLiteral("{filename}"),
+                QString::fromUtf8(QUrl::toPercentEncoding(fileName)));
+    if (!QUrl(url).isValid() || QUrl(url).scheme().isEmpty()) {
+        return nullptr;
+    }
+    QNetworkRequest request{ QUrl(url) };
+    for (const auto& header : settings.headers) {
+        request.setRawHeader(header.first, header.second);
+    }
+
+    // Both bodies are streamed from the device, with a Content-Length since
+    // the size is known
+    if (!settings.multipart) {
+        request.setHeader(QNetworkRequest::ContentTypeHeader,
+                          QStringLiteral("image/png"));
+        request.setHeader(QNetworkRequest::ContentLengthHeader, body->size());
+        return settings.put ? network->put(request, body)
+                            : network->post(request, body);
+    }
+
+    auto* multipart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    QHttpPart part;
+    part.setHeader(QNetworkRequest::ContentTypeHeader,
+                   QStringLiteral("image/png"));
+    part.setRawHeader("Content-Disposition", contentDisposition(fileName));
+    part.setBodyDevice(body);
+    multipart->append(part);
+    QNetworkReply* reply = settings.put ? network->put(request, multipart)
+                                        : network->post(request, multipart);
+    multipart->setParent(reply);
+    return reply;
+}
+
+bool HttpUploader::parseReply(QNetworkReply* reply,
+                              const Settings& settings,
+                              QUrl& url,
+                              QString& error)
+{
+    const QByteArray data = reply->readAll();
+    if (settings.urlPath.isEmpty()) {
+        // Object stores answer a PUT with an empty body
+        const QByteArray body = data.trimmed();
+        url = body.isEmpty()
+                ? reply->request().url()
+                : QUrl(QString::fromUtf8(body), QUrl::StrictMode);
+    } else {
+        QJsonValue value = QJsonDocument::fromJson(data).object();
+        for (const QString& key : settings.urlPath.split('.')) {
+            if (value.isArray()) {
+                value = value.toArray().at(key.toInt());
+            } else {
+                value = value.toObject().value(key);
+            }
+        }
+        url = QUrl(value.toString());
+    }
+    // Anything else, e.g. an error page served with a 200, is not the URL
+    // of the image
+    const QString scheme = url.scheme().toLower();
+    if (!url.isValid() || url.host().isEmpty() ||
+        (scheme != QLatin1String("http") && scheme != QLatin1String("https"))) {
+        error = tr("Unexpected response from the server");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/imgupload/storages/imguploaderbase.h"
+#include <QList>
+#include <QPair>
+#include <QUrl>
+#include <QWidget>
+
+class QIODevice;
+class QNetworkReply;
+class QNetworkAccessManager;
+
+// Uploads to any HTTP endpoint, as described by the httpUpload* options:
+// PUT or POST of the PNG image or of a multipart form, with custom headers,
+// and the URL of the image read from the JSON response.
+class HttpUploader : public ImgUploaderBase
+{
+    Q_OBJECT
+public:
+    explicit HttpUploader(const QPixmap& capture, QWidget* parent = nullptr);
+    void deleteImage(const QString& fileName, const QString& deleteToken);
+
+    struct Settings
+    {
+        // {filename} is replaced by the name of the uploaded file
+        QString url;
+        bool put = false;
+        bool multipart = true;
+        QList<QPair<QByteArray, QByteArray>> headers;
+        // Dot separated, e.g. "data.link" or "files.0.url"
+        QString urlPath;
+    };
+    static Settings settings();
+
+    // The PNG encoded capture is streamed from body, name is its file name
+    // without suffix
+    static QNetworkReply* send(QNetworkAccessManager* network,
+                               QIODevice* body,
+                               const Settings& settings,
+                               const QString& name);
+    static bool parseReply(QNetworkReply* reply,
+                           const Settings& settings,
+                           QUrl& url,
+                           QString& error);
+
+private:
+    void upload();
+};
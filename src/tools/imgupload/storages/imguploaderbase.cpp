@@ -3,7 +3,9 @@
 
 #include "imguploaderbase.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/tools/imgupload/uploadqueue.h"
 #include "src/utils/confighandler.h"
+#include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
 #include "src/utils/history.h"
 #include "src/utils/screenshotsaver.h"
@@ -11,11 +13,14 @@
 #include "src/widgets/loadspinner.h"
 #include "src/widgets/notificationwidget.h"
 #include <QApplication>
-// FIXME #include <QBuffer>
+#include <QBuffer>
 #include <QClipboard>
+#include <QCloseEvent>
 #include <QCursor>
+#include <QDBusConnection>
 #include <QDesktopServices>
 #include <QDrag>
+#include <QFutureWatcher>
 #include <QGuiApplication>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -29,6 +34,7 @@
 #include <QTimer>
 #include <QUrlQuery>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 
 ImgUploaderBase::ImgUploaderBase(const QPixmap& capture, QWidget* parent)
   : QWidget(parent)
@@ -95,6 +101,123 @@ void ImgUploaderBase::setInfoLabelText(const QString& text)
     m_infoLabel->setText(text);
 }
 
+void ImgUploaderBase::enqueueUpload(const QString& storage)
+{
+    m_uploadJobId = UploadQueue::createJobId();
+    if (FlameshotDaemon::instance()) {
+        UploadQueue* queue = UploadQueue::instance();
+        connect(queue,
+                &UploadQueue::uploadProgress,
+                this,
+                &ImgUploaderBase::uploadProgress);
+        connect(
+          queue,
+          &UploadQueue::uploaded,
+          this,
+          [this](const QString& id, const QUrl& url, const QString& name) {
+              uploadFinished(id, url.toString(), name);
+          });
+        connect(
+          queue, &UploadQueue::failed, this, &ImgUploaderBase::uploadFailed);
+    } else {
+        const QString service = QStringLiteral("org.flameshot.Flameshot");
+        QDBusConnection sessionBus = QDBusConnection::sessionBus();
+        sessionBus.connect(service,
+                           QStringLiteral("/"),
+                           service,
+                           QStringLiteral("uploadProgress"),
+                           this,
+                           SLOT(uploadProgress(QString, qint64, qint64)));
+        sessionBus.connect(service,
+                           QStringLiteral("/"),
+                           service,
+                           QStringLiteral("uploadFinished"),
+                           this,
+                           SLOT(uploadFinished(QString, QString, QString)));
+        sessionBus.connect(service,
+                           QStringLiteral("/"),
+                           service,
+                           QStringLiteral("uploadFailed"),
+                           this,
+                           SLOT(uploadFailed(QString, QString)));
+    }
+
+    // Named now, the job may run in another process, after a restart
+    const QString name = FileNameHandler().parsedPattern(
+      FileNameHandler::captureContext(m_pixmap));
+    // QPixmap can only be used in the GUI thread
+    const QImage image = m_pixmap.toImage();
+    auto* watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher, &QFutureWatcher<QByteArray>::finished, this, [=]() {
+        watcher->deleteLater();
+        const QByteArray png = watcher->result();
+        if (m_uploadJobId.isEmpty()) {
+            // Closed in the meantime
+            return;
+        }
+        if (png.isEmpty()) {
+            uploadFailed(m_uploadJobId, tr("Unable to encode the screenshot"));
+            return;
+        }
+        FlameshotDaemon::upload(m_uploadJobId, storage, name, png);
+    });
+    watcher->setFuture(QtConcurrent::run([image]() {
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        if (!image.save(&buffer, "PNG")) {
+            png.clear();
+        }
+        return png;
+    }));
+}
+
+void ImgUploaderBase::closeEvent(QCloseEvent* event)
+{
+    // Nobody would see the result, the files of the job are deleted
+    if (!m_uploadJobId.isEmpty()) {
+        FlameshotDaemon::cancelUpload(m_uploadJobId);
+        m_uploadJobId.clear();
+    }
+    QWidget::closeEvent(event);
+}
+
+void ImgUploaderBase::uploadProgress(const QString& id,
+                                     qint64 sent,
+                                     qint64 total)
+{
+    if (id == m_uploadJobId && total > 0) {
+        setInfoLabelText(tr("Uploading Image (%1%)").arg(sent * 100 / total));
+    }
+}
+
+void ImgUploaderBase::uploadFinished(const QString& id,
+                                     const QString& url,
+                                     const QString& historyName)
+{
+    if (id.isEmpty() || id != m_uploadJobId) {
+        return;
+    }
+    m_uploadJobId.clear();
+    m_spinner->deleteLater();
+    setImageURL(QUrl(url));
+    m_currentImageName = historyName;
+    new QShortcut(Qt::Key_Escape, this, SLOT(close()));
+    emit uploadOk(imageURL());
+}
+
+void ImgUploaderBase::uploadFailed(const QString& id, const QString& error)
+{
+    if (id.isEmpty() || id != m_uploadJobId) {
+        return;
+    }
+    m_uploadJobId.clear();
+    m_spinner->deleteLater();
+    m_currentImageName.clear();
+    setInfoLabelText(error);
+    new QShortcut(Qt::Key_Escape, this, SLOT(close()));
+}
+
 void ImgUploaderBase::startDrag()
 {
     auto* mimeData = new QMimeData;
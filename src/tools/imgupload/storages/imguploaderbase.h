@@ -42,7 +42,20 @@ signals:
 public slots:
     void showPostUploadDialog();
 
+protected:
+    // Queues the pixmap on the UploadQueue of the daemon and reports the
+    // progress and result of the job. Closing the widget cancels the job.
+    void enqueueUpload(const QString& storage);
+    void closeEvent(QCloseEvent* event) override;
+
 private slots:
+    // The job is followed through the D-Bus signals of the daemon when it
+    // runs in another process
+    void uploadProgress(const QString& id, qint64 sent, qint64 total);
+    void uploadFinished(const QString& id,
+                        const QString& url,
+                        const QString& historyName);
+    void uploadFailed(const QString& id, const QString& error);
     void startDrag();
     void openURL();
     void copyURL();
@@ -66,6 +79,7 @@ private:
     QPushButton* m_saveToFilesystemButton;
     QUrl m_imageURL;
     NotificationWidget* m_notification;
+    QString m_uploadJobId;
 
 public:
     QString m_currentImageName;
@@ -3,84 +3,66 @@
 
 #include "imguruploader.h"
 #include "src/utils/confighandler.h"
-#include "src/utils/filenamehandler.h"
-#include "src/utils/history.h"
-#include "src/widgets/loadspinner.h"
 #include "src/widgets/notificationwidget.h"
-#include <QBuffer>
 #include <QDesktopServices>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
-#include <QShortcut>
 #include <QUrlQuery>
 
+#define IMGUR_API_URL_VARIABLE "FLAMESHOT_IMGUR_API_URL"
+
 ImgurUploader::ImgurUploader(const QPixmap& capture, QWidget* parent)
   : ImgUploaderBase(capture, parent)
-{
-    m_NetworkAM = new QNetworkAccessManager(this);
-    connect(m_NetworkAM,
-            &QNetworkAccessManager::finished,
-            this,
-            &ImgurUploader::handleReply);
-}
+{}
 
-void ImgurUploader::handleReply(QNetworkReply* reply)
+void ImgurUploader::upload()
 {
-    spinner()->deleteLater();
-    m_currentImageName.clear();
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonDocument response = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject json = response.object();
-        QJsonObject data = json[QStringLiteral("data")].toObject();
-        setImageURL(data[QStringLiteral("link")].toString());
-
-        auto deleteToken = data[QStringLiteral("deletehash")].toString();
-
-        // save history
-        m_currentImageName = imageURL().toString();
-        int lastSlash = m_currentImageName.lastIndexOf("/");
-        if (lastSlash >= 0) {
-            m_currentImageName = m_currentImageName.mid(lastSlash + 1);
-        }
-
-        // save image to history
-        History history;
-        m_currentImageName =
-          history.packFileName("imgur", deleteToken, m_currentImageName);
-        history.save(pixmap(), m_currentImageName);
-
-        emit uploadOk(imageURL());
-    } else {
-        setInfoLabelText(reply->errorString());
-    }
-    new QShortcut(Qt::Key_Escape, this, SLOT(close()));
+    enqueueUpload(QStringLiteral("imgur"));
 }
 
-void ImgurUploader::upload()
+QNetworkReply* ImgurUploader::send(QNetworkAccessManager* network,
+                                   QIODevice* body,
+                                   const QString& name)
 {
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    pixmap().save(&buffer, "PNG");
-
     QUrlQuery urlQuery;
     urlQuery.addQueryItem(QStringLiteral("title"), QStringLiteral(""));
-    QString description = FileNameHandler().parsedPattern();
-    urlQuery.addQueryItem(QStringLiteral("description"), description);
+    urlQuery.addQueryItem(QStringLiteral("description"), name);
 
-    QUrl url(QStringLiteral("https://api.imgur.com/3/image"));
+    // Allows testing against a local server
+    QUrl url(qEnvironmentVariableIsSet(IMGUR_API_URL_VARIABLE)
+               ? QString::fromLocal8Bit(qgetenv(IMGUR_API_URL_VARIABLE))
+               : QStringLiteral("https://api.imgur.com/3/image"));
     url.setQuery(urlQuery);
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader,
                       "application/application/x-www-form-urlencoded");
+    request.setHeader(QNetworkRequest::ContentLengthHeader, body->size());
     request.setRawHeader("Authorization",
                          QStringLiteral("Client-ID %1")
                            .arg(ConfigHandler().uploadClientSecret())
                            .toUtf8());
 
-    m_NetworkAM->post(request, byteArray);
+    return network->post(request, body);
+}
+
+bool ImgurUploader::parseReply(QNetworkReply* reply,
+                               QUrl& url,
+                               QString& deleteToken,
+                               QString& error)
+{
+    QJsonDocument response = QJsonDocument::fromJson(reply->readAll());
+    QJsonObject json = response.object();
+    QJsonObject jsonData = json[QStringLiteral("data")].toObject();
+    url = QUrl(jsonData[QStringLiteral("link")].toString());
+    deleteToken = jsonData[QStringLiteral("deletehash")].toString();
+    if (!url.isValid() || url.isEmpty()) {
+        error = tr("Unexpected response from the server");
+        return false;
+    }
+    return true;
 }
 
 void ImgurUploader::deleteImage(const QString& fileName,
@@ -7,6 +7,7 @@
 #include <QUrl>
 #include <QWidget>
 
+class QIODevice;
 class QNetworkReply;
 class QNetworkAccessManager;
 class QUrl;
@@ -18,12 +19,15 @@ public:
     explicit ImgurUploader(const QPixmap& capture, QWidget* parent = nullptr);
     void deleteImage(const QString& fileName, const QString& deleteToken);
 
-private slots:
-    void handleReply(QNetworkReply* reply);
+    // The PNG encoded capture is streamed from body, name is its description
+    static QNetworkReply* send(QNetworkAccessManager* network,
+                               QIODevice* body,
+                               const QString& name);
+    static bool parseReply(QNetworkReply* reply,
+                           QUrl& url,
+                           QString& deleteToken,
+                           QString& error);
 
 private:
     void upload();
-
-private:
-    QNetworkAccessManager* m_NetworkAM;
 };
@@ -0,0 +1,428 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "uploadqueue.h"
+#include "imguploadermanager.h"
+#include "src/utils/abstractlogger.h"
+#include "src/utils/filenamehandler.h"
+#include "src/utils/history.h"
+#include <QApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLockFile>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPixmap>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QtConcurrent>
+
+// Uploads running at the same time
+#define MAX_CONCURRENT_UPLOADS 3
+// Attempts before a job is abandoned
+#define MAX_UPLOAD_ATTEMPTS 5
+// Delay before the first retry, doubled for each of the next ones (ms)
+#define UPLOAD_RETRY_DELAY 2000
+#define MAX_UPLOAD_RETRY_DELAY (5 * 60 * 1000)
+// An upload is aborted when no data was transferred for that long (ms)
+#define UPLOAD_TRANSFER_TIMEOUT 30000
+
+namespace {
+
+// Worth trying again later, as opposed to a rejected request
+bool isTransient(QNetworkReply* reply)
+{
+    const int status =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 0) {
+        // No HTTP response: connection refused or reset, DNS, timeout...
+        return reply->error() != QNetworkReply::NoError;
+    }
+    return status == 408 || status == 429 || status >= 500;
+}
+
+} // unnamed namespace
+
+UploadQueue::UploadQueue(QObject* parent)
+  : QObject(parent)
+  , m_network(new QNetworkAccessManager(this))
+  , m_retryDelay(UPLOAD_RETRY_DELAY)
+{
+    m_directory =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+      QStringLiteral("/uploads/");
+    QDir().mkpath(m_directory);
+}
+
+UploadQueue* UploadQueue::instance()
+{
+    static auto* queue = new UploadQueue(qApp);
+    return queue;
+}
+
+QString UploadQueue::createJobId()
+{
+    static QAtomicInt nextId;
+    // Sorted by creation time, so that resumed jobs keep their order
+    return QStringLiteral("%1-%2-%3")
+      .arg(QDateTime::currentMSecsSinceEpoch())
+      .arg(QCoreApplication::applicationPid())
+      .arg(nextId.fetchAndAddRelaxed(1));
+}
+
+void UploadQueue::enqueue(const QString& id,
+                          const QString& storage,
+                          const QString& name,
+                          const QByteArray& png)
+{
+    Job job;
+    job.id = id;
+    job.storage = storage;
+    job.name = name;
+    if (find(id) == nullptr) {
+        job.lock = lock(id);
+    }
+    if (job.lock.isNull()) {
+        emit failed(id,
+                    tr("Unable to write the upload to %1").arg(m_directory));
+        return;
+    }
+    m_jobs << job;
+    emit activityChanged();
+
+    const QString path = filePath(id, QStringLiteral("png"));
+    auto* watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [=]() {
+        watcher->deleteLater();
+        encoded(id, watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run([png, path]() {
+        QSaveFile file(path);
+        return !png.isEmpty() && file.open(QIODevice::WriteOnly) &&
+               file.write(png) == png.size() && file.commit();
+    }));
+}
+
+void UploadQueue::cancel(const QString& id)
+{
+    Job* job = find(id);
+    if (job == nullptr) {
+        return;
+    }
+    if (QNetworkReply* reply = job->reply) {
+        // Deleted now, so that its body no longer holds the file
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        delete reply;
+    }
+    remove(id);
+    schedule();
+}
+
+void UploadQueue::cancelAll()
+{
+    QStringList ids;
+    for (const Job& job : qAsConst(m_jobs)) {
+        ids << job.id;
+    }
+    for (const QString& id : qAsConst(ids)) {
+        cancel(id);
+    }
+}
+
+void UploadQueue::resume()
+{
+    QDir dir(m_directory);
+    const QStringList descriptions = dir.entryList(
+      { QStringLiteral("*.json") }, QDir::Files, QDir::Name);
+    for (const QString& name : descriptions) {
+        const QString id = QFileInfo(name).completeBaseName();
+        if (find(id) != nullptr) {
+            continue;
+        }
+        // Run by a live process
+        QSharedPointer<QLockFile> lock = this->lock(id);
+        if (lock.isNull()) {
+            continue;
+        }
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        const QJsonObject json =
+          QJsonDocument::fromJson(file.readAll()).object();
+        Job job;
+        job.id = id;
+        job.storage = json[QStringLiteral("storage")].toString();
+        job.name = json[QStringLiteral("name")].toString();
+        if (job.name.isEmpty()) {
+            job.name = FileNameHandler().parsedPattern();
+        }
+        job.attempts = json[QStringLiteral("attempts")].toInt();
+        job.ready = true;
+        job.resumed = true;
+        job.lock = lock;
+        if (job.storage.isEmpty() ||
+            !QFile::exists(filePath(id, QStringLiteral("png")))) {
+            remove(id);
+            continue;
+        }
+        m_jobs << job;
+    }
+    schedule();
+}
+
+bool UploadQueue::isIdle() const
+{
+    return m_jobs.isEmpty();
+}
+
+int UploadQueue::pendingCount() const
+{
+    return m_jobs.size();
+}
+
+void UploadQueue::progress(qint64& sent, qint64& total) const
+{
+    sent = 0;
+    total = 0;
+    for (const Job& job : m_jobs) {
+        if (job.running) {
+            sent += job.sent;
+            total += job.total;
+        }
+    }
+}
+
+void UploadQueue::setRetryDelay(int msecs)
+{
+    m_retryDelay = msecs;
+}
+
+UploadQueue::Job* UploadQueue::find(const QString& id)
+{
+    for (Job& job : m_jobs) {
+        if (job.id == id) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+
+QString UploadQueue::filePath(const QString& id, const QString& suffix) const
+{
+    return m_directory + id + QStringLiteral(".") + suffix;
+}
+
+// Null when the job is locked by another live process
+QSharedPointer<QLockFile> UploadQueue::lock(const QString& id) const
+{
+    QSharedPointer<QLockFile> lock(
+      new QLockFile(filePath(id, QStringLiteral("lock"))));
+    // Held for the whole upload, only a dead owner makes it stale
+    lock->setStaleLockTime(0);
+    if (!lock->tryLock(0)) {
+        return {};
+    }
+    return lock;
+}
+
+bool UploadQueue::writeDescription(const Job& job) const
+{
+    QJsonObject json;
+    json[QStringLiteral("storage")] = job.storage;
+    json[QStringLiteral("name")] = job.name;
+    json[QStringLiteral("attempts")] = job.attempts;
+    QSaveFile file(filePath(job.id, QStringLiteral("json")));
+    return file.open(QIODevice::WriteOnly) &&
+           file.write(QJsonDocument(json).toJson()) >= 0 && file.commit();
+}
+
+void UploadQueue::remove(const QString& id)
+{
+    QFile::remove(filePath(id, QStringLiteral("json")));
+    QFile::remove(filePath(id, QStringLiteral("png")));
+    // Removing the job releases its lock
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        if (m_jobs[i].id == id) {
+            m_jobs.removeAt(i);
+            break;
+        }
+    }
+    emit activityChanged();
+}
+
+void UploadQueue::encoded(const QString& id, bool ok)
+{
+    Job* job = find(id);
+    if (job == nullptr) {
+        // Canceled while its file was written
+        QFile::remove(filePath(id, QStringLiteral("png")));
+        return;
+    }
+    // The description is written last, a job is only resumed when complete
+    if (!ok || !writeDescription(*job)) {
+        remove(id);
+        emit failed(id,
+                    tr("Unable to write the upload to %1").arg(m_directory));
+        return;
+    }
+    job->ready = true;
+    schedule();
+}
+
+void UploadQueue::schedule()
+{
+    int running = 0;
+    QStringList startable;
+    for (const Job& job : m_jobs) {
+        if (job.running) {
+            ++running;
+        } else if (job.ready && !job.waiting) {
+            startable << job.id;
+        }
+    }
+    // start() removes the jobs which can't be sent
+    for (const QString& id : startable) {
+        if (running >= MAX_CONCURRENT_UPLOADS) {
+            break;
+        }
+        if (Job* job = find(id)) {
+            start(*job);
+            ++running;
+        }
+    }
+}
+
+void UploadQueue::start(Job& job)
+{
+    auto* body = new QFile(filePath(job.id, QStringLiteral("png")));
+    if (!body->open(QIODevice::ReadOnly)) {
+        delete body;
+        const QString id = job.id;
+        remove(id);
+        emit failed(id, tr("Unable to read the upload"));
+        return;
+    }
+    QNetworkReply* reply =
+      ImgUploaderManager::sendUpload(job.storage, job.name, m_network, body);
+    if (reply == nullptr) {
+        delete body;
+        const QString id = job.id;
+        remove(id);
+        emit failed(id,
+                    tr("Unable to upload to the \"%1\" storage, please check "
+                       "its configuration")
+                      .arg(job.storage));
+        return;
+    }
+    body->setParent(reply);
+    job.reply = reply;
+    job.running = true;
+    job.sent = 0;
+    job.total = body->size();
+    ++job.attempts;
+    writeDescription(job);
+
+    // QNetworkRequest::setTransferTimeout() needs Qt 5.15. Data in either
+    // direction restarts it, a reply received slowly once the whole body is
+    // sent isn't aborted.
+    auto* timeout = new QTimer(reply);
+    timeout->setSingleShot(true);
+    timeout->setInterval(UPLOAD_TRANSFER_TIMEOUT);
+    timeout->start();
+    connect(timeout, &QTimer::timeout, reply, &QNetworkReply::abort);
+    connect(reply, &QNetworkReply::metaDataChanged, timeout, [timeout]() {
+        timeout->start();
+    });
+    connect(reply, &QNetworkReply::downloadProgress, timeout, [timeout]() {
+        timeout->start();
+    });
+
+    const QString id = job.id;
+    connect(reply,
+            &QNetworkReply::uploadProgress,
+            this,
+            [this, id, timeout](qint64 sent, qint64 total) {
+                timeout->start();
+                Job* job = find(id);
+                if (job != nullptr && total > 0) {
+                    job->sent = sent;
+                    job->total = total;
+                }
+                emit uploadProgress(id, sent, total);
+                emit activityChanged();
+            });
+    connect(reply, &QNetworkReply::finished, this, [this, id, reply]() {
+        handleReply(id, reply);
+    });
+    emit activityChanged();
+}
+
+void UploadQueue::handleReply(const QString& id, QNetworkReply* reply)
+{
+    reply->deleteLater();
+    Job* job = find(id);
+    if (job == nullptr) {
+        return;
+    }
+    job->running = false;
+    job->reply = nullptr;
+
+    QUrl url;
+    QString deleteToken;
+    QString error;
+    if (reply->error() == QNetworkReply::NoError &&
+        ImgUploaderManager::parseUploadReply(
+          job->storage, reply, url, deleteToken, error)) {
+        QString name;
+        if (ImgUploaderManager::keepsHistory(job->storage)) {
+            name = url.toString();
+            name = name.mid(name.lastIndexOf('/') + 1);
+            History history;
+            name = history.packFileName(job->storage, deleteToken, name);
+            history.save(QPixmap(filePath(id, QStringLiteral("png"))), name);
+        }
+        if (job->resumed) {
+            AbstractLogger::info()
+              << tr("Screenshot uploaded: %1").arg(url.toString());
+        }
+        remove(id);
+        emit uploaded(id, url, name);
+        schedule();
+        return;
+    }
+
+    if (error.isEmpty()) {
+        error = reply->errorString();
+    }
+    if (isTransient(reply) && job->attempts < MAX_UPLOAD_ATTEMPTS) {
+        job->waiting = true;
+        const int delay = qMin<qint64>(
+          qint64(m_retryDelay) << (job->attempts - 1),
+          MAX_UPLOAD_RETRY_DELAY);
+        QTimer::singleShot(delay, this, [this, id]() {
+            Job* job = find(id);
+            if (job != nullptr) {
+                job->waiting = false;
+                schedule();
+            }
+        });
+        emit activityChanged();
+        schedule();
+        return;
+    }
+
+    if (job->resumed) {
+        AbstractLogger::error() << tr("Unable to upload the screenshot: %1")
+                                     .arg(error);
+    }
+    remove(id);
+    emit failed(id, error);
+    schedule();
+}
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QUrl>
+
+class QLockFile;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Uploads of the captures, in the background of the daemon. The other
+// processes send their captures to it with FlameshotDaemon::upload() and
+// follow them through the D-Bus signals of FlameshotDBusAdapter, so the tray
+// shows all the uploads and the daemon stays alive until they are done.
+//
+// Each job is written to a file of the application data directory, along
+// with a small JSON description, so that the jobs left by a previous daemon
+// are resumed by resume(). A job is locked by the process which runs it, the
+// jobs of a live process are never resumed by another one. The body is
+// streamed from the file. A few jobs run concurrently over a single
+// QNetworkAccessManager, which keeps the connections alive between uploads.
+// Network errors, timeouts and server errors are retried with an exponential
+// backoff.
+class UploadQueue : public QObject
+{
+    Q_OBJECT
+public:
+    static UploadQueue* instance();
+
+    // Unique among the processes, so that a client can follow its job before
+    // the daemon gets it
+    static QString createJobId();
+
+    // png is the encoded capture, id is used by the signals. name comes from
+    // the file name pattern, for the storages which name the uploads.
+    void enqueue(const QString& id,
+                 const QString& storage,
+                 const QString& name,
+                 const QByteArray& png);
+    // Stops the job and deletes its files, without signal
+    void cancel(const QString& id);
+    void cancelAll();
+    void resume();
+
+    bool isIdle() const;
+    int pendingCount() const;
+    // Bytes sent and to send by the running uploads
+    void progress(qint64& sent, qint64& total) const;
+    // Delay before the first retry of a job, doubled for each of the next
+    // ones. Exposed for testing.
+    void setRetryDelay(int msecs);
+
+signals:
+    void uploadProgress(const QString& id, qint64 sent, qint64 total);
+    // historyName is the name of the upload in the History
+    void uploaded(const QString& id,
+                  const QUrl& url,
+                  const QString& historyName);
+    // The job is abandoned
+    void failed(const QString& id, const QString& error);
+    void activityChanged();
+
+private:
+    struct Job
+    {
+        QString id;
+        QString storage;
+        QString name;
+        int attempts = 0;
+        bool ready = false;
+        bool running = false;
+        bool waiting = false;
+        // Resumed from a previous process, nobody is waiting for the result
+        bool resumed = false;
+        qint64 sent = 0;
+        qint64 total = 0;
+        QSharedPointer<QLockFile> lock;
+        QPointer<QNetworkReply> reply;
+    };
+
+    explicit UploadQueue(QObject* parent = nullptr);
+
+    Job* find(const QString& id);
+    QString filePath(const QString& id, const QString& suffix) const;
+    QSharedPointer<QLockFile> lock(const QString& id) const;
+    bool writeDescription(const Job& job) const;
+    void remove(const QString& id);
+    void encoded(const QString& id, bool ok);
+    void schedule();
+    void start(Job& job);
+    void handleReply(const QString& id, QNetworkReply* reply);
+
+    QNetworkAccessManager* m_network;
+    int m_retryDelay;
+    QString m_directory;
+    QList<Job> m_jobs;
+};
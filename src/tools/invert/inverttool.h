@@ -18,6 +18,9 @@ public:
 
     CaptureTool* copy(QObject* parent = nullptr) override;
     void process(QPainter& painter, const QPixmap& pixmap) override;
+    bool isProcessThreadSafe() const override { return false; }
+    // Reads the pixels below the object
+    bool isSpriteCacheable() const override { return false; }
     void drawSearchArea(QPainter& painter, const QPixmap& pixmap) override;
     void paintMousePreview(QPainter& painter,
                            const CaptureContext& context) override;
@@ -4,6 +4,7 @@
 #include "applauncherwidget.h"
 #include "src/tools/launcher/launcheritemdelegate.h"
 #include "src/utils/confighandler.h"
+#include "src/utils/desktopentryindex.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
 #include "terminallauncher.h"
@@ -44,16 +45,20 @@ AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
 
     m_keepOpen = ConfigHandler().keepOpenAppLauncher();
 
-    QString dirLocal = QDir::homePath() + "/.local/share/applications/";
-    QDir appsDirLocal(dirLocal);
-    m_parser.processDirectory(appsDirLocal);
-
-    QString dir = QStringLiteral("/usr/share/applications/");
-    QDir appsDir(dir);
-    m_parser.processDirectory(appsDir);
+    // The entries of the previous scan are shown right away, and replaced if
+    // the application directories changed since
+    DesktopEntryIndex* index = DesktopEntryIndex::instance();
+    connect(index,
+            &DesktopEntryIndex::updated,
+            this,
+            &AppLauncherWidget::reloadApps);
+    index->refresh();
 
+    m_tabWidget = new QTabWidget;
+    const int size = GlobalValues::buttonBaseSize();
+    m_tabWidget->setIconSize(QSize(size, size));
     initAppMap();
-    initListWidget();
+    fillListWidget();
 
     m_terminalCheckbox = new QCheckBox(tr("Launch in terminal"), this);
     m_keepOpenCheckbox = new QCheckBox(tr("Keep open after selection"), this);
@@ -88,7 +93,7 @@ void AppLauncherWidget::launch(const QModelIndex& index)
 {
     if (!QFileInfo(m_tempFile).isReadable()) {
         m_tempFile =
-          FileNameHandler().properScreenshotPath(QDir::tempPath(), "png");
+          FileNameHandler().proposeScreenshotPath(QDir::tempPath(), "png");
         bool ok = m_pixmap.save(m_tempFile);
         if (!ok) {
             QMessageBox::about(
@@ -153,12 +158,25 @@ void AppLauncherWidget::searchChanged(const QString& text)
     }
 }
 
-void AppLauncherWidget::initListWidget()
+void AppLauncherWidget::reloadApps()
 {
-    m_tabWidget = new QTabWidget;
-    const int size = GlobalValues::buttonBaseSize();
-    m_tabWidget->setIconSize(QSize(size, size));
+    const int currentIndex = m_tabWidget->currentIndex();
+    const int count = m_tabWidget->count();
+    while (m_tabWidget->count() > 0) {
+        QWidget* page = m_tabWidget->widget(0);
+        m_tabWidget->removeTab(0);
+        page->deleteLater();
+    }
+    initAppMap();
+    fillListWidget();
+    if (m_tabWidget->count() == count) {
+        m_tabWidget->setCurrentIndex(currentIndex);
+    }
+    searchChanged(m_lineEdit->text());
+}
 
+void AppLauncherWidget::fillListWidget()
+{
     for (auto const& i : catIconNames.toStdMap()) {
         const QString& cat = i.first;
         const QString& iconName = i.second;
@@ -196,7 +214,8 @@ void AppLauncherWidget::initAppMap()
                              "System",
                              "Utility" });
 
-    m_appsMap = m_parser.getAppsByCategory(categories);
+    m_appsMap = DesktopFileParser::getAppsByCategory(
+      DesktopEntryIndex::instance()->apps(), categories);
 
     // Unify multimedia.
     QVector<DesktopAppData> multimediaList;
@@ -235,15 +254,15 @@ void AppLauncherWidget::addAppsToListWidget(
 {
     for (const DesktopAppData& app : appList) {
         auto* buttonItem = new QListWidgetItem(widget);
-        buttonItem->setData(Qt::DecorationRole, app.icon);
         buttonItem->setData(Qt::DisplayRole, app.name);
         buttonItem->setData(Qt::UserRole, app.exec);
         buttonItem->setData(Qt::UserRole + 1, app.showInTerminal);
+        // The icon is only looked up when the item is painted
+        buttonItem->setData(LauncherItemDelegate::IconNameRole, app.iconName);
         QColor foregroundColor =
           this->palette().color(QWidget::foregroundRole());
         buttonItem->setForeground(foregroundColor);
 
-        buttonItem->setIcon(app.icon);
         buttonItem->setText(app.name);
         buttonItem->setToolTip(app.description);
     }
@@ -23,16 +23,16 @@ private slots:
     void launch(const QModelIndex& index);
     void checkboxClicked(const bool enabled);
     void searchChanged(const QString& text);
+    void reloadApps();
 
 private:
-    void initListWidget();
+    void fillListWidget();
     void initAppMap();
     void configureListView(QListWidget* widget);
     void addAppsToListWidget(QListWidget* widget,
                              const QVector<DesktopAppData>& appList);
     void keyPressEvent(QKeyEvent* keyEvent) override;
 
-    DesktopFileParser m_parser;
     QPixmap m_pixmap;
     QString m_tempFile;
     bool m_keepOpen;
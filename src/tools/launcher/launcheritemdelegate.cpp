@@ -3,8 +3,27 @@
 
 #include "launcheritemdelegate.h"
 #include "src/utils/globalvalues.h"
+#include <QHash>
 #include <QPainter>
 
+namespace {
+
+// QIcon::fromTheme() looks the icon up in the theme directories, which is
+// only done once per icon and only for the items which are painted
+QIcon themeIcon(const QString& name)
+{
+    static QHash<QString, QIcon> icons;
+    auto it = icons.constFind(name);
+    if (it == icons.constEnd()) {
+        static const QIcon defaultIcon =
+          QIcon::fromTheme(QStringLiteral("application-x-executable"));
+        it = icons.insert(name, QIcon::fromTheme(name, defaultIcon));
+    }
+    return it.value();
+}
+
+} // unnamed namespace
+
 LauncherItemDelegate::LauncherItemDelegate(QObject* parent)
   : QStyledItemDelegate(parent)
 {}
@@ -22,7 +41,7 @@ void LauncherItemDelegate::paint(QPainter* painter,
           rect.x(), rect.y(), rect.width() - 1, rect.height() - 1);
         painter->restore();
     }
-    auto icon = index.data(Qt::DecorationRole).value<QIcon>();
+    const QIcon icon = themeIcon(index.data(IconNameRole).toString());
 
     const int iconSide = static_cast<int>(GlobalValues::buttonBaseSize() * 1.3);
     const int halfIcon = iconSide / 2;
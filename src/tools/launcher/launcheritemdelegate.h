@@ -12,6 +12,9 @@ class LauncherItemDelegate : public QStyledItemDelegate
 public:
     explicit LauncherItemDelegate(QObject* parent = nullptr);
 
+    // Theme name of the icon of an item
+    static const int IconNameRole = Qt::UserRole + 2;
+
     void paint(QPainter* painter,
                const QStyleOptionViewItem& option,
                const QModelIndex& index) const override;
@@ -23,7 +23,7 @@ void showOpenWithMenu(const QPixmap& capture)
 {
 #if defined(Q_OS_WIN)
     QString tempFile =
-      FileNameHandler().properScreenshotPath(QDir::tempPath(), "png");
+      FileNameHandler().proposeScreenshotPath(QDir::tempPath(), "png");
     bool ok = capture.save(tempFile);
     if (!ok) {
         QMessageBox::about(nullptr,
@@ -63,6 +63,13 @@ void MarkerTool::process(QPainter& painter, const QPixmap& pixmap)
     painter.setCompositionMode(compositionMode);
 }
 
+// The sprite holds the stroke at its opacity, it is multiplied with the
+// capture as process() does
+QPainter::CompositionMode MarkerTool::spriteCompositionMode() const
+{
+    return QPainter::CompositionMode_Multiply;
+}
+
 void MarkerTool::paintMousePreview(QPainter& painter,
                                    const CaptureContext& context)
 {
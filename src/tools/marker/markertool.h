@@ -23,6 +23,7 @@ public:
 
 protected:
     CaptureTool::Type type() const override;
+    QPainter::CompositionMode spriteCompositionMode() const override;
 
 public slots:
     void drawStart(const CaptureContext& context) override;
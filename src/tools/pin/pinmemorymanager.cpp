@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "pinmemorymanager.h"
+#include "pinwidget.h"
+#include "src/utils/confighandler.h"
+#include <QApplication>
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QPixmap>
+#include <QTemporaryFile>
+#include <QTimer>
+#include <QtConcurrent>
+#include <algorithm>
+
+// A pin not used for that long can be evicted while on screen (ms)
+#define PIN_IDLE_DELAY 60000
+// Interval of the budget checks while pins are open (ms)
+#define PIN_BUDGET_CHECK_INTERVAL 10000
+// Share of the budget the in-memory compressed copies can use
+#define COMPRESSED_BUDGET_DIVISOR 4
+// Maps to zlib level 1: fast, and screenshots still compress well
+#define PIN_PNG_QUALITY 80
+
+PinMemoryManager::PinMemoryManager(QObject* parent)
+  : QObject(parent)
+  , m_timer(new QTimer(this))
+{
+    m_timer->setInterval(PIN_BUDGET_CHECK_INTERVAL);
+    connect(
+      m_timer, &QTimer::timeout, this, &PinMemoryManager::enforceBudget);
+}
+
+PinMemoryManager* PinMemoryManager::instance()
+{
+    static auto* manager = new PinMemoryManager(qApp);
+    return manager;
+}
+
+void PinMemoryManager::add(PinWidget* pin)
+{
+    Entry entry;
+    entry.lastUse = QDateTime::currentMSecsSinceEpoch();
+    m_entries.insert(pin, entry);
+    m_timer->start();
+    // Once the new pin is shown, it would be evicted as a hidden pin
+    QTimer::singleShot(0, this, &PinMemoryManager::enforceBudget);
+}
+
+void PinMemoryManager::remove(PinWidget* pin)
+{
+    auto it = m_entries.find(pin);
+    if (it == m_entries.end()) {
+        return;
+    }
+    delete it->spill;
+    m_entries.erase(it);
+    if (m_entries.isEmpty()) {
+        m_timer->stop();
+    }
+}
+
+void PinMemoryManager::touch(PinWidget* pin)
+{
+    auto it = m_entries.find(pin);
+    if (it != m_entries.end()) {
+        it->lastUse = QDateTime::currentMSecsSinceEpoch();
+    }
+}
+
+QPixmap PinMemoryManager::restore(PinWidget* pin)
+{
+    auto it = m_entries.find(pin);
+    if (it == m_entries.end() || !it->evicted) {
+        return {};
+    }
+    Entry& entry = *it;
+    QImage image;
+    if (!entry.pending.isNull()) {
+        // Still being compressed, the copy is kept when it is done
+        image = entry.pending;
+    } else if (entry.spill != nullptr) {
+        entry.spill->seek(0);
+        image.loadFromData(entry.spill->readAll(), "PNG");
+    } else {
+        image.loadFromData(entry.compressed, "PNG");
+    }
+    // The compressed copy stays valid, the pixels of a pin never change: the
+    // next eviction only drops the pixels
+    entry.pending = QImage();
+    entry.evicted = false;
+    entry.lastUse = QDateTime::currentMSecsSinceEpoch();
+    // A hidden pin restored to be copied or saved is evicted again
+    QTimer::singleShot(0, this, &PinMemoryManager::enforceBudget);
+
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(entry.devicePixelRatio);
+    return pixmap;
+}
+
+qint64 PinMemoryManager::residentBytes() const
+{
+    qint64 bytes = 0;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        const QImage& pending = it->pending;
+        bytes += it.key()->pixelBytes() +
+                 qint64(pending.bytesPerLine()) * pending.height() +
+                 it->compressed.size();
+    }
+    return bytes;
+}
+
+qint64 PinMemoryManager::compressedBytes() const
+{
+    qint64 bytes = 0;
+    for (const Entry& entry : m_entries) {
+        bytes += entry.compressed.size();
+    }
+    return bytes;
+}
+
+qint64 PinMemoryManager::budget() const
+{
+    return qint64(ConfigHandler().pinMemoryBudget()) * 1024 * 1024;
+}
+
+void PinMemoryManager::enforceBudget()
+{
+    const qint64 budget = this->budget();
+    qint64 used = residentBytes();
+    if (used <= budget) {
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<PinWidget*> candidates;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        PinWidget* pin = it.key();
+        // The pin under the cursor is repainted on hover
+        if (!it->evicted && pin->reclaimableBytes() > 0 && !pin->underMouse() &&
+            (pin->isHidden() || now - it->lastUse >= PIN_IDLE_DELAY)) {
+            candidates << pin;
+        }
+    }
+    // Hidden pins first, then the least recently used
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [this](PinWidget* a, PinWidget* b) {
+                  if (a->isHidden() != b->isHidden()) {
+                      return a->isHidden();
+                  }
+                  return m_entries[a].lastUse < m_entries[b].lastUse;
+              });
+    for (PinWidget* pin : candidates) {
+        if (used <= budget) {
+            break;
+        }
+        used -= pin->reclaimableBytes();
+        evict(pin);
+    }
+}
+
+void PinMemoryManager::evict(PinWidget* pin)
+{
+    Entry& entry = m_entries[pin];
+    const QPixmap pixmap = pin->releasePixels();
+    entry.evicted = true;
+    entry.devicePixelRatio = pixmap.devicePixelRatio();
+    if (!entry.compressed.isEmpty() || entry.spill != nullptr) {
+        // Compressed by a previous eviction
+        return;
+    }
+    // QPixmap can only be used in the GUI thread
+    const QImage image = pixmap.toImage();
+    entry.pending = image;
+    if (entry.compressing) {
+        // Restored and evicted again before the end of the compression
+        return;
+    }
+    entry.compressing = true;
+    const int generation = ++m_generation;
+    entry.generation = generation;
+
+    auto* watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher,
+            &QFutureWatcher<QByteArray>::finished,
+            this,
+            [this, watcher, pin, generation]() {
+                store(pin, generation, watcher->result());
+                watcher->deleteLater();
+            });
+    watcher->setFuture(QtConcurrent::run([image]() {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        if (!image.save(&buffer, "PNG", PIN_PNG_QUALITY)) {
+            data.clear();
+        }
+        return data;
+    }));
+}
+
+void PinMemoryManager::store(PinWidget* pin,
+                             int generation,
+                             const QByteArray& data)
+{
+    // The pin may have been closed in the meantime
+    auto it = m_entries.find(pin);
+    if (it == m_entries.end() || it->generation != generation) {
+        return;
+    }
+    Entry& entry = *it;
+    entry.compressing = false;
+    if (data.isEmpty()) {
+        // An evicted pin keeps its pixels in pending, and is compressed
+        // again by its next eviction once restored
+        return;
+    }
+    if (compressedBytes() + data.size() >
+        budget() / COMPRESSED_BUDGET_DIVISOR) {
+        auto* file = new QTemporaryFile(
+          QDir::temp().filePath(QStringLiteral("flameshot-pin-XXXXXX.png")));
+        if (file->open() && file->write(data) == data.size() &&
+            file->flush()) {
+            entry.spill = file;
+            entry.pending = QImage();
+            return;
+        }
+        // Kept in memory when the file can't be written
+        delete file;
+    }
+    entry.compressed = data;
+    entry.pending = QImage();
+}
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+
+class PinWidget;
+class QTemporaryFile;
+class QTimer;
+
+// Keeps the memory used by the pins of the daemon around pinMemoryBudget.
+//
+// When the pixels of the pins exceed the budget, the hidden pins and then the
+// pins that were not used for a while are evicted, least recently used first:
+// their full resolution pixmap is compressed to PNG on the thread pool. A
+// zoomed pin keeps the surface on screen, an unzoomed one draws the full
+// resolution pixmap itself and gives it up too. Once the compressed copies
+// themselves exceed a quarter of the budget, the next ones are spilled to
+// temporary files. The pixels are decompressed when the pin needs them again,
+// to paint, zoom, copy or save, and the compressed copy is kept so that the
+// next eviction of the pin is free. The pin under the cursor is not evicted.
+class PinMemoryManager : public QObject
+{
+    Q_OBJECT
+public:
+    static PinMemoryManager* instance();
+
+    void add(PinWidget* pin);
+    void remove(PinWidget* pin);
+    // The pin is used, it is evicted last
+    void touch(PinWidget* pin);
+    // Full resolution pixels of an evicted pin, null if they can't be decoded
+    QPixmap restore(PinWidget* pin);
+
+    // Pixels of the pins, and compressed copies kept in memory
+    qint64 residentBytes() const;
+
+private:
+    struct Entry
+    {
+        qint64 lastUse = 0;
+        bool evicted = false;
+        // Unique to each compression, to discard the ones of a closed pin
+        int generation = 0;
+        bool compressing = false;
+        // Pixels being compressed
+        QImage pending;
+        qreal devicePixelRatio = 1;
+        QByteArray compressed;
+        QTemporaryFile* spill = nullptr;
+    };
+
+    explicit PinMemoryManager(QObject* parent = nullptr);
+    void enforceBudget();
+    void evict(PinWidget* pin);
+    void store(PinWidget* pin, int generation, const QByteArray& data);
+    qint64 compressedBytes() const;
+    qint64 budget() const;
+
+    QHash<PinWidget*, Entry> m_entries;
+    QTimer* m_timer;
+    int m_generation = 0;
+};
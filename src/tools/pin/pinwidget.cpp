@@ -1,37 +1,113 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
-#include <QGraphicsDropShadowEffect>
 #include <QPinchGesture>
 
 #include "pinwidget.h"
+#include "pinmemorymanager.h"
 #include "qguiappcurrentscreen.h"
 #include "screenshotsaver.h"
+#include "src/utils/abstractlogger.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/globalvalues.h"
 
-#include <QLabel>
 #include <QMenu>
+#include <QPainter>
+#include <QPixmapCache>
 #include <QScreen>
 #include <QShortcut>
-#include <QVBoxLayout>
+#include <QTimer>
 #include <QWheelEvent>
+#include <qdrawutil.h>
 
 namespace {
 constexpr int MARGIN = 7;
-constexpr int BLUR_RADIUS = 2 * MARGIN;
 constexpr qreal STEP = 0.03;
 constexpr qreal MIN_SIZE = 100.0;
+// Time without zoom steps after which the pin is resampled in high quality
+constexpr int REFINE_DELAY = 150;
+// Three box blurs approximate a gaussian blur, which spreads over MARGIN
+constexpr int SHADOW_BLUR_RADIUS = 2;
+constexpr int SHADOW_BLUR_PASSES = 3;
+// Size of the corners of the shadow nine-patch, the middle of its sides is
+// out of reach of the blur of the corners
+constexpr int SHADOW_CORNER = 2 * MARGIN;
+
+void boxBlur(QVector<int>& values, int size, int radius)
+{
+    QVector<int> line(size);
+    const int window = 2 * radius + 1;
+    for (int horizontal = 0; horizontal < 2; ++horizontal) {
+        for (int i = 0; i < size; ++i) {
+            auto at = [&](int j) -> int& {
+                return horizontal ? values[i * size + j] : values[j * size + i];
+            };
+            for (int j = 0; j < size; ++j) {
+                int sum = 0;
+                for (int k = j - radius; k <= j + radius; ++k) {
+                    sum += (k >= 0 && k < size) ? at(k) : 0;
+                }
+                line[j] = sum / window;
+            }
+            for (int j = 0; j < size; ++j) {
+                at(j) = line[j];
+            }
+        }
+    }
+}
+
+// Replaces a QGraphicsDropShadowEffect, which blurred the whole widget on
+// every repaint. Only depends on the color, so it is rendered once.
+QPixmap shadowPatch(const QColor& color)
+{
+    const QString key =
+      QStringLiteral("flameshot-pin-shadow:") + color.name(QColor::HexArgb);
+    QPixmap pixmap;
+    if (QPixmapCache::find(key, &pixmap)) {
+        return pixmap;
+    }
+
+    // Shadow of a square whose border is MARGIN away from the patch border
+    const int size = 2 * SHADOW_CORNER + 1;
+    QVector<int> alpha(size * size, 0);
+    for (int y = MARGIN; y < size - MARGIN; ++y) {
+        for (int x = MARGIN; x < size - MARGIN; ++x) {
+            alpha[y * size + x] = color.alpha();
+        }
+    }
+    for (int i = 0; i < SHADOW_BLUR_PASSES; ++i) {
+        boxBlur(alpha, size, SHADOW_BLUR_RADIUS);
+    }
+
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < size; ++y) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < size; ++x) {
+            line[x] = qPremultiply(qRgba(
+              color.red(), color.green(), color.blue(), alpha[y * size + x]));
+        }
+    }
+    pixmap = QPixmap::fromImage(image);
+    QPixmapCache::insert(key, pixmap);
+    return pixmap;
+}
+
+qint64 pixmapBytes(const QPixmap& pixmap)
+{
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
 }
+} // unnamed namespace
 
 PinWidget::PinWidget(const QPixmap& pixmap,
                      const QRect& geometry,
                      QWidget* parent)
   : QWidget(parent)
   , m_pixmap(pixmap)
-  , m_layout(new QVBoxLayout(this))
-  , m_label(new QLabel())
-  , m_shadowEffect(new QGraphicsDropShadowEffect(this))
+  , m_pixmapSize(pixmap.size())
+  , m_pixelRatio(pixmap.devicePixelRatio())
+  , m_scaled(pixmap)
+  , m_imageSize(pixmap.size())
+  , m_refineTimer(new QTimer(this))
 {
     setWindowIcon(QIcon(GlobalValues::iconPath()));
     setWindowFlags(Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint);
@@ -43,15 +119,9 @@ PinWidget::PinWidget(const QPixmap& pixmap,
     m_baseColor = conf.uiColor();
     m_hoverColor = conf.contrastUiColor();
 
-    m_layout->setContentsMargins(MARGIN, MARGIN, MARGIN, MARGIN);
-
-    m_shadowEffect->setColor(m_baseColor);
-    m_shadowEffect->setBlurRadius(BLUR_RADIUS);
-    m_shadowEffect->setOffset(0, 0);
-    setGraphicsEffect(m_shadowEffect);
-
-    m_label->setPixmap(m_pixmap);
-    m_layout->addWidget(m_label);
+    m_refineTimer->setSingleShot(true);
+    m_refineTimer->setInterval(REFINE_DELAY);
+    connect(m_refineTimer, &QTimer::timeout, this, &PinWidget::refineZoom);
 
     new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_Q), this, SLOT(close()));
     new QShortcut(Qt::Key_Escape, this, SLOT(close()));
@@ -81,7 +151,7 @@ PinWidget::PinWidget(const QPixmap& pixmap,
                           topLeft.y());
         adjusted_pos.setWidth(adjusted_pos.size().width() / devicePixelRatio);
         adjusted_pos.setHeight(adjusted_pos.size().height() / devicePixelRatio);
-        resize(0, 0);
+        resize(sizeHint());
         move(adjusted_pos.x(), adjusted_pos.y());
     }
 #endif
@@ -93,6 +163,77 @@ PinWidget::PinWidget(const QPixmap& pixmap,
             &QWidget::customContextMenuRequested,
             this,
             &PinWidget::showContextMenu);
+
+    PinMemoryManager::instance()->add(this);
+}
+
+PinWidget::~PinWidget()
+{
+    PinMemoryManager::instance()->remove(this);
+}
+
+QSize PinWidget::sizeHint() const
+{
+    return QSize(qRound(m_imageSize.width() / m_pixelRatio),
+                 qRound(m_imageSize.height() / m_pixelRatio)) +
+           QSize(2 * MARGIN, 2 * MARGIN);
+}
+
+qint64 PinWidget::pixelBytes() const
+{
+    qint64 bytes = pixmapBytes(m_pixmap);
+    for (int i = 1; i < m_mipmaps.size(); ++i) {
+        bytes += pixmapBytes(m_mipmaps[i]);
+    }
+    if (m_scaled.cacheKey() != m_pixmap.cacheKey()) {
+        bytes += pixmapBytes(m_scaled);
+    }
+    return bytes;
+}
+
+qint64 PinWidget::reclaimableBytes() const
+{
+    // An unzoomed pin draws the full resolution pixmap itself
+    if (isHidden() || m_scaled.cacheKey() == m_pixmap.cacheKey()) {
+        return pixelBytes();
+    }
+    return pixelBytes() - pixmapBytes(m_scaled);
+}
+
+QPixmap PinWidget::releasePixels()
+{
+    const bool releaseSurface =
+      isHidden() || m_scaled.cacheKey() == m_pixmap.cacheKey();
+    QPixmap pixmap = m_pixmap;
+    m_pixmap = QPixmap();
+    m_mipmaps.clear();
+    if (releaseSurface) {
+        m_scaled = QPixmap();
+        m_surfaceReleased = true;
+    }
+    return pixmap;
+}
+
+const QPixmap& PinWidget::pixels()
+{
+    if (m_pixmap.isNull()) {
+        m_pixmap = PinMemoryManager::instance()->restore(this);
+    }
+    if (m_pixmap.isNull()) {
+        AbstractLogger::error() << tr("Unable to restore the pinned image");
+        // The pin keeps what it shows, so that it isn't restored again
+        if (!m_scaled.isNull()) {
+            m_pixmap = m_scaled.scaled(
+              m_pixmapSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        } else {
+            QImage empty(m_pixmapSize, QImage::Format_ARGB32_Premultiplied);
+            empty.fill(Qt::transparent);
+            m_pixmap = QPixmap::fromImage(empty);
+        }
+        m_pixmap.setDevicePixelRatio(m_pixelRatio);
+    }
+    PinMemoryManager::instance()->touch(this);
+    return m_pixmap;
 }
 
 bool PinWidget::scrollEvent(QWheelEvent* event)
@@ -124,19 +265,21 @@ bool PinWidget::scrollEvent(QWheelEvent* event)
         m_expanding = false;
     }
 
-    m_sizeChanged = true;
-    update();
+    applyZoom();
     return true;
 }
 
 void PinWidget::enterEvent(QEvent*)
 {
-    m_shadowEffect->setColor(m_hoverColor);
+    PinMemoryManager::instance()->touch(this);
+    m_hovered = true;
+    update();
 }
 
 void PinWidget::leaveEvent(QEvent*)
 {
-    m_shadowEffect->setColor(m_baseColor);
+    m_hovered = false;
+    update();
 }
 
 void PinWidget::mouseDoubleClickEvent(QMouseEvent*)
@@ -147,6 +290,7 @@ void PinWidget::mouseDoubleClickEvent(QMouseEvent*)
 
 void PinWidget::mousePressEvent(QMouseEvent* e)
 {
+    PinMemoryManager::instance()->touch(this);
     m_dragStart = e->globalPos();
     m_offsetX = e->localPos().x() / width();
     m_offsetY = e->localPos().y() / height();
@@ -181,27 +325,100 @@ bool PinWidget::event(QEvent* event)
 
 void PinWidget::paintEvent(QPaintEvent* event)
 {
-    if (m_sizeChanged) {
-        const auto aspectRatio =
-          m_expanding ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio;
-        const auto transformType = ConfigHandler().antialiasingPinZoom()
-                                     ? Qt::SmoothTransformation
-                                     : Qt::FastTransformation;
-        const qreal iw = m_pixmap.width();
-        const qreal ih = m_pixmap.height();
-        const qreal nw = qBound(MIN_SIZE,
-                                iw * m_currentStepScaleFactor * m_scaleFactor,
-                                static_cast<qreal>(maximumWidth()));
-        const qreal nh = qBound(MIN_SIZE,
-                                ih * m_currentStepScaleFactor * m_scaleFactor,
-                                static_cast<qreal>(maximumHeight()));
+    QPainter painter(this);
+    const int corner = SHADOW_CORNER;
+    qDrawBorderPixmap(&painter,
+                      rect(),
+                      QMargins(corner, corner, corner, corner),
+                      shadowPatch(m_hovered ? m_hoverColor : m_baseColor));
+
+    const QRect target = rect().adjusted(MARGIN, MARGIN, -MARGIN, -MARGIN);
+    if (m_scaled.isNull() && m_surfaceReleased) {
+        // Evicted by PinMemoryManager, the pixels are decoded again
+        updateScaled();
+    }
+    if (!m_scaled.isNull()) {
+        painter.drawPixmap(target.topLeft(), m_scaled);
+    } else {
+        // While zooming: nearest neighbour from a mipmap at most twice as
+        // large as the target, refined by refineZoom() once it settles
+        painter.drawPixmap(target, mipmap(m_imageSize));
+    }
+}
+
+// The pin is resized right away, and drawn from the mipmaps until the zoom
+// stops changing
+void PinWidget::applyZoom()
+{
+    const auto aspectRatio =
+      m_expanding ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio;
+    const qreal iw = m_pixmapSize.width();
+    const qreal ih = m_pixmapSize.height();
+    const qreal nw = qBound(MIN_SIZE,
+                            iw * m_currentStepScaleFactor * m_scaleFactor,
+                            static_cast<qreal>(maximumWidth()));
+    const qreal nh = qBound(MIN_SIZE,
+                            ih * m_currentStepScaleFactor * m_scaleFactor,
+                            static_cast<qreal>(maximumHeight()));
+    const QSize size =
+      m_pixmapSize.scaled(qRound(nw), qRound(nh), aspectRatio);
+    if (size != m_imageSize) {
+        m_imageSize = size;
+        m_scaled = QPixmap();
+        resize(sizeHint());
+        update();
+    }
+    if (m_scaled.isNull()) {
+        m_refineTimer->start();
+    }
+}
 
-        const QPixmap pix = m_pixmap.scaled(nw, nh, aspectRatio, transformType);
+void PinWidget::refineZoom()
+{
+    updateScaled();
+    update();
+}
 
-        m_label->setPixmap(pix);
-        adjustSize();
-        m_sizeChanged = false;
+void PinWidget::updateScaled()
+{
+    m_surfaceReleased = false;
+    if (m_imageSize == m_pixmapSize) {
+        m_scaled = pixels();
+        return;
     }
+    if (ConfigHandler().antialiasingPinZoom()) {
+        m_scaled = mipmap(m_imageSize)
+                     .scaled(m_imageSize,
+                             Qt::IgnoreAspectRatio,
+                             Qt::SmoothTransformation);
+    } else {
+        m_scaled = pixels().scaled(
+          m_imageSize, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    }
+    m_scaled.setDevicePixelRatio(m_pixelRatio);
+}
+
+// Smallest level at least as large as size
+const QPixmap& PinWidget::mipmap(const QSize& size)
+{
+    if (m_mipmaps.isEmpty()) {
+        m_mipmaps << pixels();
+        QImage level = m_pixmap.toImage();
+        while (level.width() / 2 >= MIN_SIZE &&
+               level.height() / 2 >= MIN_SIZE) {
+            level = level.scaled(level.size() / 2,
+                                 Qt::IgnoreAspectRatio,
+                                 Qt::SmoothTransformation);
+            m_mipmaps << QPixmap::fromImage(level);
+        }
+    }
+    int i = 0;
+    while (i + 1 < m_mipmaps.size() &&
+           m_mipmaps[i + 1].width() >= size.width() &&
+           m_mipmaps[i + 1].height() >= size.height()) {
+        ++i;
+    }
+    return m_mipmaps[i];
 }
 
 void PinWidget::pinchTriggered(QPinchGesture* gesture)
@@ -216,8 +433,7 @@ void PinWidget::pinchTriggered(QPinchGesture* gesture)
         m_currentStepScaleFactor = 1;
         m_expanding = false;
     }
-    m_sizeChanged = true;
-    update();
+    applyZoom();
 }
 
 void PinWidget::showContextMenu(const QPoint& pos)
@@ -241,9 +457,9 @@ void PinWidget::showContextMenu(const QPoint& pos)
 
 void PinWidget::copyToClipboard()
 {
-    saveToClipboard(m_pixmap);
+    saveToClipboard(pixels());
 }
 void PinWidget::saveToFile()
 {
-    saveToFilesystemGUI(m_pixmap);
+    saveToFilesystemGUI(pixels());
 }
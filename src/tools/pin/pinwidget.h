@@ -3,13 +3,12 @@
 
 #pragma once
 
+#include <QVector>
 #include <QWidget>
 
-class QLabel;
-class QVBoxLayout;
 class QGestureEvent;
 class QPinchGesture;
-class QGraphicsDropShadowEffect;
+class QTimer;
 
 class PinWidget : public QWidget
 {
@@ -18,6 +17,18 @@ public:
     explicit PinWidget(const QPixmap& pixmap,
                        const QRect& geometry,
                        QWidget* parent = nullptr);
+    ~PinWidget() override;
+
+    QSize sizeHint() const override;
+
+    // Used by PinMemoryManager
+    qint64 pixelBytes() const;
+    // What releasePixels() would free
+    qint64 reclaimableBytes() const;
+    // Drops the full resolution pixels and returns them. Zoomed visible pins
+    // keep the surface drawn on screen, the other pins decode their pixels
+    // again when they are painted.
+    QPixmap releasePixels();
 
 protected:
     void mouseDoubleClickEvent(QMouseEvent*) override;
@@ -33,19 +44,34 @@ private:
     bool gestureEvent(QGestureEvent* event);
     bool scrollEvent(QWheelEvent* e);
     void pinchTriggered(QPinchGesture*);
+    void applyZoom();
+    void refineZoom();
+    // Resamples m_scaled to m_imageSize
+    void updateScaled();
+    const QPixmap& mipmap(const QSize& size);
+    // m_pixmap, restored first if it was released
+    const QPixmap& pixels();
 
     QPixmap m_pixmap;
-    QVBoxLayout* m_layout;
-    QLabel* m_label;
+    QSize m_pixmapSize;
+    qreal m_pixelRatio;
+    // Halved successively from m_pixmap, built on the first zoom
+    QVector<QPixmap> m_mipmaps;
+    // m_pixmap resampled to m_imageSize, null until the zoom settles
+    QPixmap m_scaled;
+    // m_scaled was dropped by releasePixels()
+    bool m_surfaceReleased{ false };
+    // Displayed size, in pixels of m_pixmap
+    QSize m_imageSize;
+    QTimer* m_refineTimer;
     QPoint m_dragStart;
     qreal m_offsetX{}, m_offsetY{};
-    QGraphicsDropShadowEffect* m_shadowEffect;
     QColor m_baseColor, m_hoverColor;
+    bool m_hovered{ false };
 
     bool m_expanding{ false };
     qreal m_scaleFactor{ 1 };
     qreal m_currentStepScaleFactor{ 1 };
-    bool m_sizeChanged{ false };
 
 private slots:
     void showContextMenu(const QPoint& pos);
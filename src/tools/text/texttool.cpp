@@ -8,11 +8,15 @@
 
 #define BASE_POINT_SIZE 8
 #define MAX_INFO_LENGTH 24
+#define TEXT_MARGIN 5
 
 TextTool::TextTool(QObject* parent)
   : CaptureTool(parent)
   , m_size(1)
+  , m_layoutDirty(true)
 {
+    m_layout.setTextFormat(Qt::PlainText);
+    m_layout.setPerformanceHint(QStaticText::AggressiveCaching);
     QString fontFamily = ConfigHandler().fontFamily();
     if (!fontFamily.isEmpty()) {
         m_font.setFamily(ConfigHandler().fontFamily());
@@ -34,6 +38,8 @@ void TextTool::copyParams(const TextTool* from, TextTool* to)
     to->m_size = from->m_size;
     to->m_color = from->m_color;
     to->m_textArea = from->m_textArea;
+    to->m_layout = from->m_layout;
+    to->m_layoutDirty = from->m_layoutDirty;
     to->m_currentPos = from->m_currentPos;
 }
 
@@ -103,6 +109,7 @@ QWidget* TextTool::widget()
     m_widget = new TextWidget();
     m_widget->setTextColor(m_color);
     m_font.setPointSize(m_size + BASE_POINT_SIZE);
+    invalidateLayout();
     m_widget->setFont(m_font);
     m_widget->setAlignment(m_alignment);
     m_widget->setText(m_text);
@@ -199,20 +206,16 @@ void TextTool::process(QPainter& painter, const QPixmap& pixmap)
     if (m_text.isEmpty()) {
         return;
     }
-    const int val = 5;
+    const int val = TEXT_MARGIN;
     QFont orig_font = painter.font();
     QPen orig_pen = painter.pen();
-    QFontMetrics fm(m_font);
-    QSize size(fm.boundingRect(QRect(), 0, m_text).size());
-    size.setWidth(size.width() + val * 2);
-    size.setHeight(size.height() + val * 2);
-    m_textArea.setSize(size);
+    updateTextArea();
     // draw text
     painter.setFont(m_font);
     painter.setPen(m_color);
     if (!editMode()) {
-        painter.drawText(
-          m_textArea + QMargins(-val, -val, val, val), m_alignment, m_text);
+        painter.drawStaticText(m_textArea.topLeft() + QPoint(val, val),
+                               m_layout);
     }
     painter.setFont(orig_font);
     painter.setPen(orig_pen);
@@ -222,6 +225,39 @@ void TextTool::process(QPainter& painter, const QPixmap& pixmap)
     }
 }
 
+void TextTool::updateTextArea()
+{
+    if (!m_layoutDirty) {
+        return;
+    }
+    m_layoutDirty = false;
+    QFontMetrics fm(m_font);
+    QSize size(fm.boundingRect(QRect(), 0, m_text).size());
+    // As QPainter::drawText() would, the lines are aligned within the width
+    // of the longest one
+    QString text = m_text;
+    text.replace(QLatin1Char('\n'), QChar::LineSeparator);
+    QTextOption option(m_alignment);
+    option.setWrapMode(QTextOption::NoWrap);
+    m_layout.setText(text);
+    m_layout.setTextWidth(size.width());
+    m_layout.setTextOption(option);
+    size.setWidth(size.width() + TEXT_MARGIN * 2);
+    size.setHeight(size.height() + TEXT_MARGIN * 2);
+    m_textArea.setSize(size);
+}
+
+void TextTool::updateBoundingRect()
+{
+    updateTextArea();
+}
+
+void TextTool::invalidateLayout()
+{
+    m_layoutDirty = true;
+    invalidateSprite();
+}
+
 void TextTool::drawObjectSelection(QPainter& painter)
 {
     if (m_text.isEmpty()) {
@@ -262,6 +298,7 @@ void TextTool::pressed(CaptureContext& context)
 void TextTool::onColorChanged(const QColor& color)
 {
     m_color = color;
+    invalidateSprite();
     if (m_widget != nullptr) {
         m_widget->setTextColor(color);
     }
@@ -271,6 +308,7 @@ void TextTool::onSizeChanged(int size)
 {
     m_size = size;
     m_font.setPointSize(m_size + BASE_POINT_SIZE);
+    invalidateLayout();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -279,11 +317,13 @@ void TextTool::onSizeChanged(int size)
 void TextTool::updateText(const QString& newText)
 {
     m_text = newText;
+    invalidateLayout();
 }
 
 void TextTool::updateFamily(const QString& text)
 {
     m_font.setFamily(text);
+    invalidateLayout();
     if (m_textOld.isEmpty()) {
         ConfigHandler().setFontFamily(m_font.family());
     }
@@ -295,6 +335,7 @@ void TextTool::updateFamily(const QString& text)
 void TextTool::updateFontUnderline(const bool underlined)
 {
     m_font.setUnderline(underlined);
+    invalidateLayout();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -303,6 +344,7 @@ void TextTool::updateFontUnderline(const bool underlined)
 void TextTool::updateFontStrikeOut(const bool strikeout)
 {
     m_font.setStrikeOut(strikeout);
+    invalidateLayout();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -311,6 +353,7 @@ void TextTool::updateFontStrikeOut(const bool strikeout)
 void TextTool::updateFontWeight(const QFont::Weight weight)
 {
     m_font.setWeight(weight);
+    invalidateLayout();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -319,6 +362,7 @@ void TextTool::updateFontWeight(const QFont::Weight weight)
 void TextTool::updateFontItalic(const bool italic)
 {
     m_font.setItalic(italic);
+    invalidateLayout();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -332,6 +376,7 @@ void TextTool::move(const QPoint& pos)
 void TextTool::updateAlignment(Qt::AlignmentFlag alignment)
 {
     m_alignment = alignment;
+    invalidateLayout();
     if (m_widget != nullptr) {
         m_widget->setAlignment(m_alignment);
     }
@@ -349,9 +394,45 @@ void TextTool::setEditMode(bool editMode)
         m_textOld = m_text;
     }
     CaptureTool::setEditMode(editMode);
+    // The text isn't drawn while it is edited
+    invalidateSprite();
 }
 
 bool TextTool::isChanged()
 {
     return QString::compare(m_text, m_textOld, Qt::CaseInsensitive) != 0;
 }
+
+void TextTool::saveState(QVariantMap& state) const
+{
+    CaptureTool::saveState(state);
+    state[QStringLiteral("text")] = m_text;
+    state[QStringLiteral("color")] = m_color.name(QColor::HexArgb);
+    state[QStringLiteral("size")] = m_size;
+    state[QStringLiteral("font")] = m_font.toString();
+    state[QStringLiteral("alignment")] = static_cast<int>(m_alignment);
+    state[QStringLiteral("pos")] = pointToVariant(m_textArea.topLeft());
+}
+
+bool TextTool::loadState(const QVariantMap& state)
+{
+    const QString text = state.value(QStringLiteral("text")).toString();
+    const QColor color(state.value(QStringLiteral("color")).toString());
+    if (text.isEmpty() || !color.isValid() || !CaptureTool::loadState(state)) {
+        return false;
+    }
+    m_text = text;
+    m_color = color;
+    m_size = qMax(1, state.value(QStringLiteral("size"), 1).toInt());
+    if (state.contains(QStringLiteral("font"))) {
+        m_font.fromString(state.value(QStringLiteral("font")).toString());
+    }
+    m_font.setPointSize(m_size + BASE_POINT_SIZE);
+    m_alignment = static_cast<Qt::AlignmentFlag>(
+      state.value(QStringLiteral("alignment"), static_cast<int>(Qt::AlignLeft))
+        .toInt());
+    m_textArea.moveTo(variantToPoint(state.value(QStringLiteral("pos"))));
+    invalidateLayout();
+    updateTextArea();
+    return true;
+}
@@ -7,6 +7,7 @@
 #include "textconfig.h"
 #include <QPoint>
 #include <QPointer>
+#include <QStaticText>
 class TextWidget;
 class TextConfig;
 
@@ -22,6 +23,7 @@ public:
     [[nodiscard]] bool isSelectable() const override;
     [[nodiscard]] bool showMousePreview() const override;
     [[nodiscard]] QRect boundingRect() const override;
+    [[nodiscard]] bool isSpriteCacheable() const override { return true; }
 
     [[nodiscard]] QIcon icon(const QColor& background,
                              bool inEditor) const override;
@@ -43,9 +45,13 @@ public:
     void setEditMode(bool editMode) override;
     bool isChanged() override;
 
+    void saveState(QVariantMap& state) const override;
+    bool loadState(const QVariantMap& state) override;
+
 protected:
     void copyParams(const TextTool* from, TextTool* to);
     [[nodiscard]] CaptureTool::Type type() const override;
+    void updateBoundingRect() override;
 
 public slots:
     void drawEnd(const QPoint& point) override;
@@ -67,6 +73,8 @@ private slots:
 
 private:
     void closeEditor();
+    void updateTextArea();
+    void invalidateLayout();
 
     QFont m_font;
     Qt::AlignmentFlag m_alignment;
@@ -75,6 +83,10 @@ private:
     int m_size;
     QColor m_color;
     QRect m_textArea;
+    // Glyphs of m_text, laid out again by updateTextArea() only when the
+    // text, the font or the alignment changed. Copies of the tool share them.
+    QStaticText m_layout;
+    bool m_layoutDirty;
     QPointer<TextWidget> m_widget;
     QPointer<TextConfig> m_confW;
     QPoint m_currentPos;
@@ -1,18 +1,41 @@
 #include "abstractlogger.h"
+#include "logbuffer.h"
 #include "systemnotification.h"
+#include "src/utils/confighandler.h"
+#include <atomic>
 #include <cassert>
 
 #include <QFileInfo>
 
-AbstractLogger::AbstractLogger(Channel channel, int targets)
-  : m_defaultChannel(channel)
-  , m_targets(targets)
+namespace {
+
+// ConfigHandler::logToFile(), checked for every message sent to stderr. It
+// is read with the first message, and again when the config file changes.
+std::atomic<bool> logToFileEnabled(false);
+std::atomic<bool> logToFileWatched(false);
+
+bool logToFile()
 {
-    if (targets & LogFile) {
-        // TODO
+    // Reading the config may log its errors, which come back here
+    if (!logToFileWatched.exchange(true)) {
+        // Without a context object the update runs in the GUI thread, which
+        // emits the signal
+        QObject::connect(
+          ConfigHandler::getInstance(), &ConfigHandler::fileChanged, []() {
+              logToFileEnabled = ConfigHandler().logToFile();
+          });
+        logToFileEnabled = ConfigHandler().logToFile();
     }
+    return logToFileEnabled;
 }
 
+} // unnamed namespace
+
+AbstractLogger::AbstractLogger(Channel channel, int targets)
+  : m_defaultChannel(channel)
+  , m_targets(targets)
+{}
+
 /**
  * @brief Construct an AbstractLogger with output to a string.
  * @param additionalChannels Optional additional targets to output to.
@@ -48,24 +71,46 @@ AbstractLogger AbstractLogger::error(int targets)
 AbstractLogger& AbstractLogger::sendMessage(QString msg, Channel channel)
 {
     if (m_targets & Notification) {
-        SystemNotification().sendMessage(
-          msg, messageHeader(channel, Notification), m_notificationPath);
+        SystemNotification::Type type = SystemNotification::Info;
+        if (channel == Warning) {
+            type = SystemNotification::Warning;
+        } else if (channel == Error) {
+            type = SystemNotification::Error;
+        }
+        SystemNotification().sendMessage(msg,
+                                         messageHeader(channel, Notification),
+                                         m_notificationPath,
+                                         type);
     }
     if (!m_textStreams.isEmpty()) {
         foreach (auto* stream, m_textStreams) {
             *stream << messageHeader(channel, String) << msg << "\n";
         }
     }
-    if (m_targets & LogFile) {
-        // TODO
-    }
+    // Written by a background thread, errors are written before returning
+    int outputs = 0;
     if (m_targets & Stderr) {
-        QTextStream stream(stderr);
-        stream << messageHeader(channel, Stderr) << msg << "\n";
+        outputs |= LogBuffer::Stderr;
+    }
+    if ((m_targets & LogFile) ||
+        ((m_targets & Stderr) && logToFile())) {
+        outputs |= LogBuffer::LogFile;
+    }
+    if (outputs != 0) {
+        LogBuffer::push(
+          outputs, channel == Error, messageHeader(channel, Stderr), msg);
     }
     return *this;
 }
 
+/**
+ * @brief Number of messages lost because the log buffer was full.
+ */
+quint64 AbstractLogger::droppedMessages()
+{
+    return LogBuffer::droppedMessages();
+}
+
 /**
  * @brief Send a message to the default channel of this logger.
  * @param msg
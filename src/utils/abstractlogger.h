@@ -15,7 +15,9 @@ public:
         Stderr = 0x02,
         LogFile = 0x08,
         String = 0x10,
-        Default = Notification | LogFile | Stderr,
+        // Messages sent to Stderr also go to the log file when the user
+        // enabled it, see ConfigHandler::logToFile()
+        Default = Notification | Stderr,
     };
 
     enum Channel
@@ -36,6 +38,8 @@ public:
     static AbstractLogger warning(int targets = Default);
     static AbstractLogger error(int targets = Default);
 
+    static quint64 droppedMessages();
+
     AbstractLogger& sendMessage(QString msg, Channel channel);
     AbstractLogger& operator<<(QString msg);
     AbstractLogger& addOutputString(QString& str);
@@ -0,0 +1,444 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "animationencoder.h"
+#include <QFileInfo>
+#include <QIODevice>
+#include <QVector>
+#include <QtEndian>
+#include <algorithm>
+#include <climits>
+
+// Colors of a GIF frame, the last index being kept for transparency
+#define GIF_TRANSPARENT_INDEX 255
+// Codes of the GIF LZW dictionary, and size of its hash table (a prime)
+#define LZW_MAX_CODES 4096
+#define LZW_HASH_SIZE 5003
+// Frames are compressed while the recording runs, speed matters more than
+// size
+#define APNG_COMPRESSION_LEVEL 3
+
+namespace {
+
+void appendLittleEndian16(QByteArray& data, int value)
+{
+    data.append(char(value & 0xff));
+    data.append(char((value >> 8) & 0xff));
+}
+
+void appendBigEndian32(QByteArray& data, quint32 value)
+{
+    char bytes[4];
+    qToBigEndian(value, bytes);
+    data.append(bytes, 4);
+}
+
+// Palette of at most 255 colors made of the most frequent colors, reduced to
+// 15 bits. Screen content rarely has more, so this is close to lossless and
+// much cheaper than a median cut. Transparent pixels get
+// GIF_TRANSPARENT_INDEX.
+void quantize(const QImage& frame,
+              QVector<QRgb>& palette,
+              QByteArray& indices,
+              bool& transparent)
+{
+    const int buckets = 1 << 15;
+    auto bucketOf = [](QRgb p) {
+        return ((qRed(p) >> 3) << 10) | ((qGreen(p) >> 3) << 5) |
+               (qBlue(p) >> 3);
+    };
+    QVector<quint32> counts(buckets, 0);
+    // Sums of the channels of each bucket, for their average color
+    QVector<quint32> sums(buckets * 3, 0);
+    transparent = false;
+    for (int y = 0; y < frame.height(); ++y) {
+        const auto* line =
+          reinterpret_cast<const QRgb*>(frame.constScanLine(y));
+        for (int x = 0; x < frame.width(); ++x) {
+            const QRgb p = line[x];
+            if (qAlpha(p) == 0) {
+                transparent = true;
+                continue;
+            }
+            const int bucket = bucketOf(p);
+            ++counts[bucket];
+            sums[bucket * 3] += qRed(p);
+            sums[bucket * 3 + 1] += qGreen(p);
+            sums[bucket * 3 + 2] += qBlue(p);
+        }
+    }
+
+    QVector<int> used;
+    for (int bucket = 0; bucket < buckets; ++bucket) {
+        if (counts[bucket] > 0) {
+            used << bucket;
+        }
+    }
+    if (used.size() > GIF_TRANSPARENT_INDEX) {
+        std::partial_sort(used.begin(),
+                          used.begin() + GIF_TRANSPARENT_INDEX,
+                          used.end(),
+                          [&counts](int a, int b) {
+                              return counts[a] > counts[b];
+                          });
+        used.resize(GIF_TRANSPARENT_INDEX);
+    }
+    // Palette index of each bucket, -1 until it is looked up
+    QVector<short> lookup(buckets, -1);
+    palette.clear();
+    for (int bucket : used) {
+        const quint32 n = counts[bucket];
+        lookup[bucket] = short(palette.size());
+        palette << qRgb(sums[bucket * 3] / n,
+                        sums[bucket * 3 + 1] / n,
+                        sums[bucket * 3 + 2] / n);
+    }
+    if (palette.isEmpty()) {
+        palette << qRgb(0, 0, 0);
+    }
+
+    indices.resize(frame.width() * frame.height());
+    char* out = indices.data();
+    for (int y = 0; y < frame.height(); ++y) {
+        const auto* line =
+          reinterpret_cast<const QRgb*>(frame.constScanLine(y));
+        for (int x = 0; x < frame.width(); ++x) {
+            const QRgb p = line[x];
+            if (qAlpha(p) == 0) {
+                *out++ = char(GIF_TRANSPARENT_INDEX);
+                continue;
+            }
+            short& index = lookup[bucketOf(p)];
+            if (index < 0) {
+                // Nearest color of the palette, once per bucket
+                int best = INT_MAX;
+                for (int i = 0; i < palette.size(); ++i) {
+                    const int dr = qRed(palette[i]) - qRed(p);
+                    const int dg = qGreen(palette[i]) - qGreen(p);
+                    const int db = qBlue(palette[i]) - qBlue(p);
+                    const int distance = dr * dr + dg * dg + db * db;
+                    if (distance < best) {
+                        best = distance;
+                        index = short(i);
+                    }
+                }
+            }
+            *out++ = char(index);
+        }
+    }
+}
+
+// GIF flavor of LZW, with 8 bits symbols and variable length codes packed
+// in sub-blocks of at most 255 bytes. The dictionary is an open addressing
+// hash table, as in the classic GIFENCOD.
+void appendLzw(const QByteArray& indices, QByteArray& out)
+{
+    const int minCodeSize = 8;
+    const int clearCode = 1 << minCodeSize;
+    const int endCode = clearCode + 1;
+    QVector<int> keys(LZW_HASH_SIZE, -1);
+    QVector<int> codes(LZW_HASH_SIZE, 0);
+    int codeSize = minCodeSize + 1;
+    int maxCode = (1 << codeSize) - 1;
+    int nextCode = clearCode + 2;
+
+    QByteArray block;
+    quint32 bits = 0;
+    int bitCount = 0;
+    auto flushBlock = [&]() {
+        if (!block.isEmpty()) {
+            out.append(char(block.size()));
+            out.append(block);
+            block.clear();
+        }
+    };
+    auto writeCode = [&](int code) {
+        bits |= quint32(code) << bitCount;
+        bitCount += codeSize;
+        while (bitCount >= 8) {
+            block.append(char(bits & 0xff));
+            bits >>= 8;
+            bitCount -= 8;
+            if (block.size() == 255) {
+                flushBlock();
+            }
+        }
+    };
+    // The decoder adds a code to its dictionary after each code it reads
+    auto growCodeSize = [&]() {
+        if (nextCode > maxCode) {
+            ++codeSize;
+            maxCode = codeSize == 12 ? LZW_MAX_CODES : (1 << codeSize) - 1;
+        }
+    };
+
+    out.append(char(minCodeSize));
+    writeCode(clearCode);
+    int prefix = uchar(indices[0]);
+    for (int i = 1; i < indices.size(); ++i) {
+        const int symbol = uchar(indices[i]);
+        const int key = (symbol << 12) + prefix;
+        int slot = (symbol << 4) ^ prefix;
+        const int step = slot == 0 ? 1 : LZW_HASH_SIZE - slot;
+        bool found = false;
+        while (keys[slot] >= 0) {
+            if (keys[slot] == key) {
+                prefix = codes[slot];
+                found = true;
+                break;
+            }
+            slot -= step;
+            if (slot < 0) {
+                slot += LZW_HASH_SIZE;
+            }
+        }
+        if (found) {
+            continue;
+        }
+        writeCode(prefix);
+        growCodeSize();
+        prefix = symbol;
+        if (nextCode < LZW_MAX_CODES) {
+            keys[slot] = key;
+            codes[slot] = nextCode++;
+        } else {
+            // The dictionary is full, start over
+            writeCode(clearCode);
+            keys.fill(-1);
+            nextCode = clearCode + 2;
+            codeSize = minCodeSize + 1;
+            maxCode = (1 << codeSize) - 1;
+        }
+    }
+    writeCode(prefix);
+    growCodeSize();
+    writeCode(endCode);
+    if (bitCount > 0) {
+        block.append(char(bits & 0xff));
+    }
+    flushBlock();
+    out.append('\0');
+}
+
+class GifEncoder : public AnimationEncoder
+{
+public:
+    bool open(QIODevice* device, const QSize& size) override
+    {
+        m_device = device;
+        QByteArray data("GIF89a");
+        // Logical screen descriptor, without global color table
+        appendLittleEndian16(data, size.width());
+        appendLittleEndian16(data, size.height());
+        data.append(3, '\0');
+        // Loop forever
+        data.append("\x21\xFF\x0BNETSCAPE2.0\x03\x01", 16);
+        appendLittleEndian16(data, 0);
+        data.append('\0');
+        return m_device->write(data) == data.size();
+    }
+
+    bool addFrame(const QImage& frame,
+                  const QPoint& position,
+                  int delay) override
+    {
+        QVector<QRgb> palette;
+        QByteArray indices;
+        bool transparent;
+        quantize(frame, palette, indices, transparent);
+
+        // In hundredths of a second, rounded on the total time so that the
+        // rounding errors don't accumulate
+        m_elapsed += delay;
+        const qint64 end = (m_elapsed + 5) / 10;
+        const int centiseconds = int(qMin<qint64>(end - m_written, 0xffff));
+        m_written = end;
+
+        QByteArray data;
+        // Graphic control extension: drawn over the previous frames
+        data.append("\x21\xF9\x04", 3);
+        data.append(char((1 << 2) | (transparent ? 1 : 0)));
+        appendLittleEndian16(data, centiseconds);
+        data.append(char(transparent ? GIF_TRANSPARENT_INDEX : 0));
+        data.append('\0');
+        // Image descriptor, with a local color table of 256 colors
+        data.append('\x2C');
+        appendLittleEndian16(data, position.x());
+        appendLittleEndian16(data, position.y());
+        appendLittleEndian16(data, frame.width());
+        appendLittleEndian16(data, frame.height());
+        data.append(char(0x80 | 7));
+        for (int i = 0; i < 256; ++i) {
+            const QRgb color = i < palette.size() ? palette[i] : 0;
+            data.append(char(qRed(color)));
+            data.append(char(qGreen(color)));
+            data.append(char(qBlue(color)));
+        }
+        appendLzw(indices, data);
+        return m_device->write(data) == data.size();
+    }
+
+    bool finish() override { return m_device->write("\x3B", 1) == 1; }
+
+private:
+    QIODevice* m_device = nullptr;
+    qint64 m_elapsed = 0;
+    qint64 m_written = 0;
+};
+
+quint32 crc32(const QByteArray& data)
+{
+    static const QVector<quint32> table = []() {
+        QVector<quint32> t(256);
+        for (quint32 n = 0; n < 256; ++n) {
+            quint32 c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            t[n] = c;
+        }
+        return t;
+    }();
+    quint32 crc = 0xffffffffu;
+    for (char byte : data) {
+        crc = table[(crc ^ uchar(byte)) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+// APNG: a PNG whose frames are described by fcTL chunks. The first frame is
+// the IDAT image, the next ones are in fdAT chunks.
+class ApngEncoder : public AnimationEncoder
+{
+public:
+    bool open(QIODevice* device, const QSize& size) override
+    {
+        m_device = device;
+        if (m_device->write("\x89PNG\r\n\x1a\n", 8) != 8) {
+            return false;
+        }
+        QByteArray header;
+        appendBigEndian32(header, size.width());
+        appendBigEndian32(header, size.height());
+        // 8 bits RGBA, no interlacing
+        header.append("\x08\x06\x00\x00\x00", 5);
+        if (!writeChunk("IHDR", header)) {
+            return false;
+        }
+        // The frame count is written by finish()
+        m_animationControlPos = m_device->pos();
+        return writeChunk("acTL", animationControl());
+    }
+
+    bool addFrame(const QImage& frame,
+                  const QPoint& position,
+                  int delay) override
+    {
+        QByteArray control;
+        appendBigEndian32(control, m_sequence++);
+        appendBigEndian32(control, frame.width());
+        appendBigEndian32(control, frame.height());
+        appendBigEndian32(control, position.x());
+        appendBigEndian32(control, position.y());
+        char fraction[2];
+        qToBigEndian(quint16(qBound(1, delay, 0xffff)), fraction);
+        control.append(fraction, 2);
+        qToBigEndian(quint16(1000), fraction);
+        control.append(fraction, 2);
+        // Not disposed, the first frame replaces the canvas and the next
+        // ones are blended over it
+        control.append('\0');
+        control.append(char(m_frames == 0 ? 0 : 1));
+        if (!writeChunk("fcTL", control)) {
+            return false;
+        }
+
+        const QByteArray pixels = compress(frame);
+        bool ok;
+        if (m_frames == 0) {
+            ok = writeChunk("IDAT", pixels);
+        } else {
+            QByteArray data;
+            appendBigEndian32(data, m_sequence++);
+            data.append(pixels);
+            ok = writeChunk("fdAT", data);
+        }
+        ++m_frames;
+        return ok;
+    }
+
+    bool finish() override
+    {
+        if (!writeChunk("IEND", QByteArray())) {
+            return false;
+        }
+        const qint64 end = m_device->pos();
+        const bool ok = m_device->seek(m_animationControlPos) &&
+                        writeChunk("acTL", animationControl());
+        return m_device->seek(end) && ok;
+    }
+
+private:
+    QByteArray animationControl() const
+    {
+        QByteArray data;
+        appendBigEndian32(data, m_frames);
+        // Loop forever
+        appendBigEndian32(data, 0);
+        return data;
+    }
+
+    bool writeChunk(const char* type, const QByteArray& data)
+    {
+        QByteArray chunk;
+        appendBigEndian32(chunk, data.size());
+        QByteArray content(type, 4);
+        content.append(data);
+        chunk.append(content);
+        appendBigEndian32(chunk, crc32(content));
+        return m_device->write(chunk) == chunk.size();
+    }
+
+    // Rows with the Sub filter, deflated
+    static QByteArray compress(const QImage& frame)
+    {
+        const QImage image = frame.convertToFormat(QImage::Format_RGBA8888);
+        const int rowBytes = image.width() * 4;
+        QByteArray raw;
+        raw.resize((rowBytes + 1) * image.height());
+        char* out = raw.data();
+        for (int y = 0; y < image.height(); ++y) {
+            const uchar* line = image.constScanLine(y);
+            *out++ = 1;
+            for (int i = 0; i < rowBytes; ++i) {
+                *out++ = char(i < 4 ? line[i] : line[i] - line[i - 4]);
+            }
+        }
+        // qCompress prefixes the zlib stream with its uncompressed size
+        return qCompress(raw, APNG_COMPRESSION_LEVEL).mid(4);
+    }
+
+    QIODevice* m_device = nullptr;
+    qint64 m_animationControlPos = 0;
+    quint32 m_sequence = 0;
+    quint32 m_frames = 0;
+};
+
+} // unnamed namespace
+
+AnimationEncoder::Format AnimationEncoder::formatForPath(const QString& path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == QLatin1String("png") || suffix == QLatin1String("apng")) {
+        return APNG;
+    }
+    return GIF;
+}
+
+AnimationEncoder* AnimationEncoder::create(Format format)
+{
+    if (format == APNG) {
+        return new ApngEncoder();
+    }
+    return new GifEncoder();
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+class QIODevice;
+
+// Writes an animated GIF or APNG frame by frame, so that a recording is
+// never held in memory.
+//
+// The first frame covers the whole animation. The next ones only cover the
+// rectangle that changed since the previous frame, and are transparent where
+// the pixels did not change: they are drawn over the previous frames.
+class AnimationEncoder
+{
+public:
+    enum Format
+    {
+        GIF,
+        APNG,
+    };
+
+    // APNG for .png and .apng files, GIF otherwise
+    static Format formatForPath(const QString& path);
+    static AnimationEncoder* create(Format format);
+    virtual ~AnimationEncoder() = default;
+
+    virtual bool open(QIODevice* device, const QSize& size) = 0;
+    // delay is the time the frame stays on screen, in milliseconds
+    virtual bool addFrame(const QImage& frame,
+                          const QPoint& position,
+                          int delay) = 0;
+    virtual bool finish() = 0;
+};
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "animationrecorder.h"
+#include <QtConcurrent>
+#include <cstring>
+
+// Side of the tiles compared between two frames
+#define RECORD_TILE_SIZE 32
+// Frames waiting for the encoder. A full 1080p frame takes 8 MiB, but most
+// frames only hold a few changed tiles.
+#define RECORD_MAX_QUEUED_FRAMES 8
+
+namespace {
+
+bool tileChanged(const QImage& previous, const QImage& next, const QRect& tile)
+{
+    const int offset = tile.x() * 4;
+    const int bytes = tile.width() * 4;
+    for (int y = tile.top(); y <= tile.bottom(); ++y) {
+        if (std::memcmp(previous.constScanLine(y) + offset,
+                        next.constScanLine(y) + offset,
+                        bytes) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Bounding rectangle of the tiles that differ, empty if none does
+QRect changedRect(const QImage& previous, const QImage& next)
+{
+    const QRect bounds = next.rect();
+    QRect changed;
+    for (int y = 0; y < bounds.height(); y += RECORD_TILE_SIZE) {
+        bool rowChanged = false;
+        for (int x = 0; x < bounds.width(); x += RECORD_TILE_SIZE) {
+            // Tiles within the rectangle can't grow it any further
+            if (rowChanged && x >= changed.left() && x <= changed.right()) {
+                continue;
+            }
+            const QRect tile =
+              QRect(x, y, RECORD_TILE_SIZE, RECORD_TILE_SIZE) & bounds;
+            if (tileChanged(previous, next, tile)) {
+                changed |= tile;
+                rowChanged = true;
+            }
+        }
+    }
+    return changed;
+}
+
+// The rectangle of next, transparent where it didn't change
+QImage transparentDelta(const QImage& previous,
+                        const QImage& next,
+                        const QRect& rect)
+{
+    QImage delta(rect.size(), QImage::Format_ARGB32);
+    for (int y = 0; y < rect.height(); ++y) {
+        const auto* before =
+          reinterpret_cast<const QRgb*>(previous.constScanLine(rect.y() + y)) +
+          rect.x();
+        const auto* after =
+          reinterpret_cast<const QRgb*>(next.constScanLine(rect.y() + y)) +
+          rect.x();
+        auto* out = reinterpret_cast<QRgb*>(delta.scanLine(y));
+        for (int x = 0; x < rect.width(); ++x) {
+            out[x] = after[x] == before[x] ? 0 : after[x] | 0xff000000u;
+        }
+    }
+    return delta;
+}
+
+} // unnamed namespace
+
+AnimationRecorder::AnimationRecorder()
+  : m_dropped(0)
+  , m_pendingTimestamp(0)
+  , m_failed(false)
+{
+    // A single thread keeps the frames in order
+    m_pool.setMaxThreadCount(1);
+}
+
+AnimationRecorder::~AnimationRecorder()
+{
+    m_pool.waitForDone();
+}
+
+bool AnimationRecorder::start(const QString& path)
+{
+    m_file.setFileName(path);
+    return m_file.open(QIODevice::WriteOnly);
+}
+
+bool AnimationRecorder::addFrame(const QImage& frame, qint64 timestamp)
+{
+    if (m_queued.loadAcquire() >= RECORD_MAX_QUEUED_FRAMES) {
+        ++m_dropped;
+        return false;
+    }
+    const QImage image = frame.convertToFormat(QImage::Format_RGB32);
+    QImage delta;
+    QPoint position;
+    if (m_encoder == nullptr) {
+        m_encoder.reset(AnimationEncoder::create(
+          AnimationEncoder::formatForPath(m_file.fileName())));
+        m_failed = !m_encoder->open(&m_file, image.size());
+        delta = image.convertToFormat(QImage::Format_ARGB32);
+    } else if (image.size() != m_previous.size()) {
+        // The region is on a screen whose scale changed
+        ++m_dropped;
+        return false;
+    } else {
+        const QRect changed = changedRect(m_previous, image);
+        if (changed.isEmpty()) {
+            // The previous frame just lasts longer
+            return true;
+        }
+        delta = transparentDelta(m_previous, image, changed);
+        position = changed.topLeft();
+    }
+    m_previous = image;
+
+    m_queued.ref();
+    QtConcurrent::run(&m_pool, [this, delta, position, timestamp]() {
+        encode(delta, position, timestamp);
+        m_queued.deref();
+    });
+    return true;
+}
+
+void AnimationRecorder::encode(const QImage& delta,
+                               const QPoint& position,
+                               qint64 timestamp)
+{
+    if (!m_pending.isNull() && !m_failed) {
+        const int delay = int(timestamp - m_pendingTimestamp);
+        m_failed = !m_encoder->addFrame(m_pending, m_pendingPosition, delay);
+    }
+    m_pending = delta;
+    m_pendingPosition = position;
+    m_pendingTimestamp = timestamp;
+}
+
+bool AnimationRecorder::finish(qint64 timestamp)
+{
+    m_pool.waitForDone();
+    bool ok = false;
+    if (m_encoder != nullptr) {
+        encode(QImage(), QPoint(), timestamp);
+        ok = !m_failed && m_encoder->finish();
+    }
+    m_file.close();
+    if (!ok) {
+        m_file.remove();
+    }
+    return ok;
+}
+
+int AnimationRecorder::droppedFrames() const
+{
+    return m_dropped;
+}
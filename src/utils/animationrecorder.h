@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/animationencoder.h"
+#include <QAtomicInt>
+#include <QFile>
+#include <QImage>
+#include <QThreadPool>
+#include <memory>
+
+// Turns the frames of a recording into an animation file while they come in.
+//
+// Each frame is compared with the previous one by tiles, and only the
+// rectangle covering the changed tiles is queued. The encoding, palette
+// quantization included, runs on a thread of its own. Frames are dropped
+// while it is behind, so the memory used doesn't depend on the length of the
+// recording.
+class AnimationRecorder
+{
+public:
+    AnimationRecorder();
+    ~AnimationRecorder();
+
+    // The format is given by the suffix of path
+    bool start(const QString& path);
+    // timestamp is in milliseconds since the start of the recording. False
+    // when the frame was dropped.
+    bool addFrame(const QImage& frame, qint64 timestamp);
+    // Encodes the queued frames, the last one staying until timestamp
+    bool finish(qint64 timestamp);
+    int droppedFrames() const;
+
+private:
+    // Run by m_pool: a frame is written when the next one arrives, which
+    // gives its delay
+    void encode(const QImage& delta, const QPoint& position, qint64 timestamp);
+
+    QFile m_file;
+    std::unique_ptr<AnimationEncoder> m_encoder;
+    QThreadPool m_pool;
+    QAtomicInt m_queued;
+    QImage m_previous;
+    int m_dropped;
+
+    // Only used by m_pool
+    QImage m_pending;
+    QPoint m_pendingPosition;
+    qint64 m_pendingTimestamp;
+    bool m_failed;
+};
@@ -6,10 +6,14 @@
 #include "src/tools/capturetool.h"
 #include "valuehandler.h"
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QFileSystemWatcher>
+#include <QHash>
 #include <QKeySequence>
 #include <QMap>
 #include <QSharedPointer>
@@ -77,12 +81,14 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     OPTION("showHelp"                    ,Bool               ( true          )),
     OPTION("showSidePanelButton"         ,Bool               ( true          )),
     OPTION("showDesktopNotification"     ,Bool               ( true          )),
+    OPTION("logToFile"                   ,Bool               ( false         )),
     OPTION("disabledTrayIcon"            ,Bool               ( false         )),
     OPTION("historyConfirmationToDelete" ,Bool               ( true          )),
     OPTION("checkForUpdates"             ,Bool               ( true          )),
     OPTION("allowMultipleGuiInstances"   ,Bool               ( false         )),
     OPTION("showMagnifier"               ,Bool               ( false         )),
     OPTION("squareMagnifier"             ,Bool               ( false         )),
+    OPTION("smartSelection"              ,Bool               ( false         )),
 #if !defined(Q_OS_WIN)
     OPTION("autoCloseIdleDaemon"         ,Bool               ( false         )),
 #endif
@@ -95,6 +101,7 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     OPTION("copyAndCloseAfterUpload"     ,Bool               ( true          )),
     OPTION("copyPathAfterSave"           ,Bool               ( false         )),
     OPTION("antialiasingPinZoom"         ,Bool               ( true          )),
+    OPTION("pinMemoryBudget"             ,LowerBoundedInt    (0, 512              )),
     OPTION("useJpgForClipboard"          ,Bool               ( false         )),
     OPTION("uploadWithoutConfirmation"   ,Bool               ( false         )),
     OPTION("saveAfterCopy"               ,Bool               ( false         )),
@@ -124,6 +131,14 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     // drawFontSize, remember to update ConfigHandler::toolSize
     OPTION("copyOnDoubleClick"           ,Bool               ( false         )),
     OPTION("uploadClientSecret"          ,String             ( "313baf0c7b4d3ff"            )),
+    // "imgur" or "http"
+    OPTION("uploadStorage"               ,String             ( "imgur"       )),
+    // Generic HTTP storage
+    OPTION("httpUploadUrl"               ,String             ( ""            )),
+    OPTION("httpUploadMethod"            ,String             ( "POST"        )),
+    OPTION("httpUploadMultipart"         ,Bool               ( true          )),
+    OPTION("httpUploadHeaders"           ,StringList         (               )),
+    OPTION("httpUploadUrlPath"           ,String             ( ""            )),
 };
 
 static QMap<QString, QSharedPointer<KeySequence>> recognizedShortcuts = {
@@ -155,6 +170,7 @@ static QMap<QString, QSharedPointer<KeySequence>> recognizedShortcuts = {
     SHORTCUT("TYPE_RESIZE_UP"           ,   "Shift+Up"              ),
     SHORTCUT("TYPE_RESIZE_DOWN"         ,   "Shift+Down"            ),
     SHORTCUT("TYPE_SELECT_ALL"          ,   "Ctrl+A"                ),
+    SHORTCUT("TYPE_SAVE_PROJECT"        ,   "Ctrl+Shift+S"          ),
     SHORTCUT("TYPE_MOVE_LEFT"           ,   "Left"                  ),
     SHORTCUT("TYPE_MOVE_RIGHT"          ,   "Right"                 ),
     SHORTCUT("TYPE_MOVE_UP"             ,   "Up"                    ),
@@ -175,6 +191,29 @@ static QMap<QString, QSharedPointer<KeySequence>> recognizedShortcuts = {
 };
 // clang-format on
 
+// VALIDATION CACHE
+
+namespace {
+
+// Result of the checks of the config file, kept while the file doesn't
+// change. When it does, only the keys whose value changed are checked again.
+struct ValidationCache
+{
+    // Signature of the file when it was last checked
+    QDateTime modified;
+    qint64 size = -1;
+    QByteArray hash;
+    // Value of each key when it was checked
+    QHash<QString, QVariant> values;
+    // Keys that are unrecognized or have a bad value
+    QSet<QString> invalidKeys;
+    bool shortcutConflict = false;
+};
+
+ValidationCache validationCache;
+
+} // unnamed namespace
+
 // CLASS CONFIGHANDLER
 
 ConfigHandler::ConfigHandler()
@@ -196,6 +235,9 @@ ConfigHandler::ConfigHandler()
                              if (QFile(fileName).exists()) {
                                  m_configWatcher->addPath(fileName);
                              }
+                             // The file may change without its size and
+                             // modification time changing
+                             validationCache.size = -1;
                              if (m_skipNextErrorCheck) {
                                  m_skipNextErrorCheck = false;
                                  return;
@@ -651,6 +693,103 @@ bool ConfigHandler::checkSemantics(AbstractLogger* log,
     return ok;
 }
 
+/**
+ * @brief Whether the config has unrecognized settings or bad values.
+ *
+ * Same result as `checkUnrecognizedSettings` and `checkSemantics`, but the
+ * keys are only checked again when their value changes.
+ */
+bool ConfigHandler::hasInvalidSettings() const
+{
+    updateValidationCache();
+    return !validationCache.invalidKeys.isEmpty();
+}
+
+/**
+ * @brief Cached result of `checkShortcutConflicts`.
+ */
+bool ConfigHandler::hasShortcutConflicts() const
+{
+    updateValidationCache();
+    return validationCache.shortcutConflict;
+}
+
+/**
+ * @brief Check the keys of the config file that changed since the last call.
+ *
+ * The file is only read when its size or modification time changed, and the
+ * keys are only checked when its content changed.
+ */
+void ConfigHandler::updateValidationCache() const
+{
+    ValidationCache& cache = validationCache;
+    const QFileInfo info(m_settings.fileName());
+    if (info.size() == cache.size && info.lastModified() == cache.modified) {
+        return;
+    }
+    cache.size = info.size();
+    cache.modified = info.lastModified();
+    QFile file(info.filePath());
+    file.open(QIODevice::ReadOnly);
+    const QByteArray hash =
+      QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+    if (hash == cache.hash) {
+        return;
+    }
+    cache.hash = hash;
+
+    QHash<QString, QVariant> values;
+    bool shortcutsChanged = cache.values.isEmpty();
+    for (const QString& key : m_settings.allKeys()) {
+        const QVariant value = m_settings.value(key);
+        values.insert(key, value);
+        auto previous = cache.values.constFind(key);
+        if (previous != cache.values.constEnd() && *previous == value) {
+            continue;
+        }
+        shortcutsChanged |= isShortcut(key);
+        if (isValidSetting(key, value)) {
+            cache.invalidKeys.remove(key);
+        } else {
+            cache.invalidKeys.insert(key);
+        }
+    }
+    // Removed keys
+    for (auto it = cache.values.constBegin(); it != cache.values.constEnd();
+         ++it) {
+        if (!values.contains(it.key())) {
+            shortcutsChanged |= isShortcut(it.key());
+            cache.invalidKeys.remove(it.key());
+        }
+    }
+    cache.values = values;
+    if (shortcutsChanged) {
+        cache.shortcutConflict = !checkShortcutConflicts();
+    }
+}
+
+/**
+ * @brief Whether a key would pass `checkUnrecognizedSettings` and
+ * `checkSemantics`.
+ */
+bool ConfigHandler::isValidSetting(const QString& key,
+                                   const QVariant& value) const
+{
+    if (!key.contains('/')) {
+        if (!recognizedGeneralOptions().contains(key)) {
+            return false;
+        }
+    } else if (isShortcut(key)) {
+        if (!recognizedShortcutNames().contains(baseName(key))) {
+            return false;
+        }
+    } else {
+        // Other groups are not checked
+        return true;
+    }
+    return !value.isValid() || valueHandler(key)->check(value);
+}
+
 /**
  * @brief Parse the configuration to find any errors in it.
  *
@@ -664,7 +803,7 @@ void ConfigHandler::checkAndHandleError() const
     if (!QFile(m_settings.fileName()).exists()) {
         setErrorState(false);
     } else {
-        setErrorState(!checkForErrors());
+        setErrorState(hasInvalidSettings() || hasShortcutConflicts());
     }
 
     ensureFileWatched();
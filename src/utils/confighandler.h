@@ -81,6 +81,7 @@ public:
     CONFIG_GETTER_SETTER(showDesktopNotification,
                          setShowDesktopNotification,
                          bool)
+    CONFIG_GETTER_SETTER(logToFile, setLogToFile, bool)
     CONFIG_GETTER_SETTER(filenamePattern, setFilenamePattern, QString)
     CONFIG_GETTER_SETTER(disabledTrayIcon, setDisabledTrayIcon, bool)
     CONFIG_GETTER_SETTER(drawThickness, setDrawThickness, int)
@@ -106,6 +107,7 @@ public:
     CONFIG_GETTER_SETTER(copyPathAfterSave, setCopyPathAfterSave, bool)
     CONFIG_GETTER_SETTER(saveAsFileExtension, setSaveAsFileExtension, QString)
     CONFIG_GETTER_SETTER(antialiasingPinZoom, setAntialiasingPinZoom, bool)
+    CONFIG_GETTER_SETTER(pinMemoryBudget, setPinMemoryBudget, int)
     CONFIG_GETTER_SETTER(useJpgForClipboard, setUseJpgForClipboard, bool)
     CONFIG_GETTER_SETTER(uploadWithoutConfirmation,
                          setUploadWithoutConfirmation,
@@ -117,8 +119,17 @@ public:
     CONFIG_GETTER_SETTER(buttons, setButtons, QList<CaptureTool::Type>)
     CONFIG_GETTER_SETTER(showMagnifier, setShowMagnifier, bool)
     CONFIG_GETTER_SETTER(squareMagnifier, setSquareMagnifier, bool)
+    CONFIG_GETTER_SETTER(smartSelection, setSmartSelection, bool)
     CONFIG_GETTER_SETTER(copyOnDoubleClick, setCopyOnDoubleClick, bool)
     CONFIG_GETTER_SETTER(uploadClientSecret, setUploadClientSecret, QString)
+    CONFIG_GETTER_SETTER(uploadStorage, setUploadStorage, QString)
+    CONFIG_GETTER_SETTER(httpUploadUrl, setHttpUploadUrl, QString)
+    CONFIG_GETTER_SETTER(httpUploadMethod, setHttpUploadMethod, QString)
+    CONFIG_GETTER_SETTER(httpUploadMultipart, setHttpUploadMultipart, bool)
+    CONFIG_GETTER_SETTER(httpUploadHeaders,
+                         setHttpUploadHeaders,
+                         QStringList)
+    CONFIG_GETTER_SETTER(httpUploadUrlPath, setHttpUploadUrlPath, QString)
 
     // SPECIAL CASES
     bool startupLaunch();
@@ -152,6 +163,8 @@ public:
     bool checkShortcutConflicts(AbstractLogger* log = nullptr) const;
     bool checkSemantics(AbstractLogger* log = nullptr,
                         QList<QString>* offenders = nullptr) const;
+    bool hasInvalidSettings() const;
+    bool hasShortcutConflicts() const;
     void checkAndHandleError() const;
     void setErrorState(bool error) const;
     bool hasError() const;
@@ -169,6 +182,8 @@ private:
     static QSharedPointer<QFileSystemWatcher> m_configWatcher;
 
     void ensureFileWatched() const;
+    void updateValidationCache() const;
+    bool isValidSetting(const QString& key, const QVariant& value) const;
     QSharedPointer<ValueHandler> valueHandler(const QString& key) const;
     void assertKeyRecognized(const QString& key) const;
     bool isShortcut(const QString& key) const;
@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "desktopentryindex.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QLocale>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+// Found by argument-dependent lookup from the QMap and QVector operators
+QDataStream& operator<<(QDataStream& out, const DesktopEntryIndex::Entry& e)
+{
+    return out << e.modified << e.size << e.ok << e.app.name
+               << e.app.description << e.app.exec << e.app.categories
+               << e.app.iconName << e.app.showInTerminal;
+}
+
+QDataStream& operator>>(QDataStream& in, DesktopEntryIndex::Entry& e)
+{
+    return in >> e.modified >> e.size >> e.ok >> e.app.name >>
+           e.app.description >> e.app.exec >> e.app.categories >>
+           e.app.iconName >> e.app.showInTerminal;
+}
+
+QDataStream& operator<<(QDataStream& out,
+                        const DesktopEntryIndex::Directory& d)
+{
+    return out << d.path << d.entries;
+}
+
+QDataStream& operator>>(QDataStream& in, DesktopEntryIndex::Directory& d)
+{
+    return in >> d.path >> d.entries;
+}
+
+namespace {
+
+const quint32 INDEX_MAGIC = 0x49454446; // "FDEI"
+const quint32 INDEX_VERSION = 1;
+
+QStringList applicationDirectories()
+{
+    return { QDir::homePath() + "/.local/share/applications/",
+             QStringLiteral("/usr/share/applications/") };
+}
+
+// The parsed names and descriptions depend on the locale
+QVector<DesktopEntryIndex::Directory> load(const QString& path)
+{
+    QVector<DesktopEntryIndex::Directory> directories;
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return directories;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0, version = 0;
+    QString locale;
+    in >> magic >> version >> locale;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION ||
+        locale != QLocale().name()) {
+        return directories;
+    }
+    in >> directories;
+    if (in.status() != QDataStream::Ok) {
+        directories.clear();
+    }
+    return directories;
+}
+
+void save(const QString& path,
+          const QVector<DesktopEntryIndex::Directory>& directories)
+{
+    if (path.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << INDEX_MAGIC << INDEX_VERSION << QLocale().name() << directories;
+    file.commit();
+}
+
+// Runs on the thread pool, only the changed files are parsed
+QVector<DesktopEntryIndex::Directory> scan(
+  const QVector<DesktopEntryIndex::Directory>& previous,
+  const QString& cachePath)
+{
+    DesktopFileParser parser;
+    QVector<DesktopEntryIndex::Directory> directories;
+    bool changed = false;
+    for (const QString& path : applicationDirectories()) {
+        DesktopEntryIndex::Directory old;
+        for (const auto& d : previous) {
+            if (d.path == path) {
+                old = d;
+                break;
+            }
+        }
+
+        DesktopEntryIndex::Directory directory;
+        directory.path = path;
+        const QFileInfoList files =
+          QDir(path).entryInfoList(QDir::NoDotAndDotDot | QDir::Files);
+        for (const QFileInfo& info : files) {
+            const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+            auto it = old.entries.constFind(info.fileName());
+            if (it != old.entries.constEnd() && it->modified == modified &&
+                it->size == info.size()) {
+                directory.entries.insert(info.fileName(), *it);
+                continue;
+            }
+            DesktopEntryIndex::Entry entry;
+            entry.modified = modified;
+            entry.size = info.size();
+            entry.app =
+              parser.parseDesktopFile(info.absoluteFilePath(), entry.ok);
+            directory.entries.insert(info.fileName(), entry);
+            changed = true;
+        }
+        changed = changed || directory.entries.size() != old.entries.size();
+        directories << directory;
+    }
+    if (changed) {
+        save(cachePath, directories);
+    }
+    return directories;
+}
+
+} // unnamed namespace
+
+DesktopEntryIndex::DesktopEntryIndex(QObject* parent)
+  : QObject(parent)
+{
+    const QString dir =
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!dir.isEmpty()) {
+        m_cachePath = dir + QStringLiteral("/desktop-entries.index");
+    }
+    m_directories = load(m_cachePath);
+    connect(&m_watcher,
+            &QFutureWatcher<QVector<Directory>>::finished,
+            this,
+            &DesktopEntryIndex::scanFinished);
+}
+
+DesktopEntryIndex* DesktopEntryIndex::instance()
+{
+    static auto* index = new DesktopEntryIndex(qApp);
+    return index;
+}
+
+QVector<DesktopAppData> DesktopEntryIndex::apps() const
+{
+    QVector<DesktopAppData> apps;
+    for (const Directory& directory : m_directories) {
+        for (const Entry& entry : directory.entries) {
+            if (entry.ok) {
+                apps << entry.app;
+            }
+        }
+    }
+    return apps;
+}
+
+void DesktopEntryIndex::refresh()
+{
+    if (m_watcher.isRunning()) {
+        return;
+    }
+    m_watcher.setFuture(QtConcurrent::run(scan, m_directories, m_cachePath));
+}
+
+void DesktopEntryIndex::scanFinished()
+{
+    const QVector<DesktopAppData> before = apps();
+    m_directories = m_watcher.result();
+    const QVector<DesktopAppData> after = apps();
+    // DesktopAppData::operator== only compares the names
+    bool changed = before.size() != after.size();
+    for (int i = 0; !changed && i < before.size(); ++i) {
+        const DesktopAppData& a = before[i];
+        const DesktopAppData& b = after[i];
+        changed = a.name != b.name || a.description != b.description ||
+                  a.exec != b.exec || a.categories != b.categories ||
+                  a.iconName != b.iconName ||
+                  a.showInTerminal != b.showInTerminal;
+    }
+    if (changed) {
+        emit updated();
+    }
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/desktopfileparse.h"
+#include <QFutureWatcher>
+#include <QObject>
+
+// Index of the desktop entries of the application directories, shared by the
+// "Open With" windows.
+//
+// The index is stored in the cache directory, so the entries are available
+// as soon as the index is created. refresh() checks the directories in the
+// background and only parses the files whose modification time or size
+// changed since the last scan.
+class DesktopEntryIndex : public QObject
+{
+    Q_OBJECT
+public:
+    static DesktopEntryIndex* instance();
+
+    // Entries of the last scan, in the order of the directories
+    QVector<DesktopAppData> apps() const;
+    // Does nothing while a scan is running
+    void refresh();
+
+    struct Entry
+    {
+        qint64 modified = 0;
+        qint64 size = -1;
+        bool ok = false;
+        DesktopAppData app;
+    };
+
+    struct Directory
+    {
+        QString path;
+        // Keyed by file name
+        QMap<QString, Entry> entries;
+    };
+
+signals:
+    // The entries changed after a refresh
+    void updated();
+
+private:
+    explicit DesktopEntryIndex(QObject* parent = nullptr);
+
+    void scanFinished();
+
+    QString m_cachePath;
+    QVector<Directory> m_directories;
+    QFutureWatcher<QVector<Directory>> m_watcher;
+};
@@ -16,8 +16,6 @@ DesktopFileParser::DesktopFileParser()
     m_localeDescription = QStringLiteral("Comment[%1]").arg(locale);
     m_localeNameShort = QStringLiteral("Name[%1]").arg(localeShort);
     m_localeDescriptionShort = QStringLiteral("Comment[%1]").arg(localeShort);
-    m_defaultIcon =
-      QIcon::fromTheme(QStringLiteral("application-x-executable"));
 }
 
 DesktopAppData DesktopFileParser::parseDesktopFile(const QString& fileName,
@@ -41,9 +39,8 @@ DesktopAppData DesktopFileParser::parseDesktopFile(const QString& fileName,
     while (!in.atEnd()) {
         QString line = in.readLine();
         if (line.startsWith(QLatin1String("Icon"))) {
-            res.icon = QIcon::fromTheme(
-              line.mid(line.indexOf(QLatin1String("=")) + 1).trimmed(),
-              m_defaultIcon);
+            res.iconName =
+              line.mid(line.indexOf(QLatin1String("=")) + 1).trimmed();
         } else if (!nameLocaleSet && line.startsWith(QLatin1String("Name"))) {
             if (line.startsWith(m_localeName) ||
                 line.startsWith(m_localeNameShort)) {
@@ -126,9 +123,16 @@ QVector<DesktopAppData> DesktopFileParser::getAppsByCategory(
 
 QMap<QString, QVector<DesktopAppData>> DesktopFileParser::getAppsByCategory(
   const QStringList& categories)
+{
+    return getAppsByCategory(m_appList, categories);
+}
+
+QMap<QString, QVector<DesktopAppData>> DesktopFileParser::getAppsByCategory(
+  const QVector<DesktopAppData>& apps,
+  const QStringList& categories)
 {
     QMap<QString, QVector<DesktopAppData>> res;
-    for (const DesktopAppData& app : m_appList) {
+    for (const DesktopAppData& app : apps) {
         for (const QString& category : categories) {
             if (app.categories.contains(category)) {
                 res[category].append(app);
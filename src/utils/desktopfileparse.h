@@ -3,9 +3,9 @@
 
 #pragma once
 
-#include <QIcon>
 #include <QMap>
 #include <QStringList>
+#include <QVector>
 
 class QDir;
 class QString;
@@ -20,11 +20,11 @@ struct DesktopAppData
     DesktopAppData(const QString& name,
                    const QString& description,
                    const QString& exec,
-                   QIcon icon)
+                   const QString& iconName)
       : name(name)
       , description(description)
       , exec(exec)
-      , icon(icon)
+      , iconName(iconName)
       , showInTerminal(false)
     {}
 
@@ -37,7 +37,8 @@ struct DesktopAppData
     QString description;
     QString exec;
     QStringList categories;
-    QIcon icon;
+    // Resolved with QIcon::fromTheme() when the entry is displayed
+    QString iconName;
     bool showInTerminal;
 };
 
@@ -50,6 +51,9 @@ struct DesktopFileParser
     QVector<DesktopAppData> getAppsByCategory(const QString& category);
     QMap<QString, QVector<DesktopAppData>> getAppsByCategory(
       const QStringList& categories);
+    static QMap<QString, QVector<DesktopAppData>> getAppsByCategory(
+      const QVector<DesktopAppData>& apps,
+      const QStringList& categories);
 
 private:
     QString m_localeName;
@@ -57,6 +61,5 @@ private:
     QString m_localeNameShort;
     QString m_localeDescriptionShort;
 
-    QIcon m_defaultIcon;
     QVector<DesktopAppData> m_appList;
 };
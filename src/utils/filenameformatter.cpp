@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "filenameformatter.h"
+
+// Longest text of a strftime specifier, such as a localized month name
+#define TIME_TEXT_SIZE 100
+
+namespace {
+
+// strftime specifiers that can be used in file names
+const char timeSpecifiers[] = "aAbBcCdDeFgGhHIjmMnprRStTuUVwWxXyYzZ";
+
+bool isTimeSpecifier(QChar c)
+{
+    for (const char* s = timeSpecifiers; *s != '\0'; ++s) {
+        if (c == QLatin1Char(*s)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Appends the decimal digits of value without a temporary string
+void appendNumber(QString& out, int value)
+{
+    QChar digits[12];
+    int first = 12;
+    do {
+        digits[--first] = QLatin1Char(char('0' + value % 10));
+        value /= 10;
+    } while (value > 0);
+    out.append(digits + first, 12 - first);
+}
+
+} // unnamed namespace
+
+FileNameFormatter::FileNameFormatter(const QString& pattern)
+  : m_pattern(pattern)
+  , m_hasTime(false)
+  , m_hasCounter(false)
+  , m_time(-1)
+{
+    QString literal;
+    auto addToken = [this, &literal](TokenType type, char specifier) {
+        if (!literal.isEmpty()) {
+            m_tokens << Token{ LITERAL, literal, 0 };
+            literal.clear();
+        }
+        m_tokens << Token{ type, QString(), specifier };
+    };
+    for (int i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] != QLatin1Char('%')) {
+            literal += pattern[i];
+            continue;
+        }
+        if (i + 1 == pattern.size()) {
+            // A trailing '%' is dropped
+            break;
+        }
+        const QChar next = pattern[i + 1];
+        if (isTimeSpecifier(next)) {
+            addToken(TIME, next.toLatin1());
+            m_hasTime = true;
+            ++i;
+            continue;
+        }
+        const int end = next == QLatin1Char('{')
+                          ? pattern.indexOf(QLatin1Char('}'), i + 2)
+                          : -1;
+        if (end > 0) {
+            const QStringRef name = pattern.midRef(i + 2, end - i - 2);
+            TokenType type = LITERAL;
+            if (name == QLatin1String("counter")) {
+                type = COUNTER;
+                m_hasCounter = true;
+            } else if (name == QLatin1String("screen")) {
+                type = SCREEN;
+            } else if (name == QLatin1String("size")) {
+                type = SIZE;
+            }
+            if (type != LITERAL) {
+                addToken(type, 0);
+                i = end;
+                continue;
+            }
+        }
+        // Unknown specifiers are kept as they are
+        literal += pattern[i];
+    }
+    if (!literal.isEmpty()) {
+        m_tokens << Token{ LITERAL, literal, 0 };
+    }
+}
+
+const QString& FileNameFormatter::pattern() const
+{
+    return m_pattern;
+}
+
+bool FileNameFormatter::hasCounter() const
+{
+    return m_hasCounter;
+}
+
+void FileNameFormatter::updateTime() const
+{
+    const std::time_t now = std::time(nullptr);
+    if (now == m_time) {
+        return;
+    }
+    m_time = now;
+    const std::tm* local = std::localtime(&now);
+    char text[TIME_TEXT_SIZE];
+    for (Token& token : m_tokens) {
+        if (token.type == TIME) {
+            const char format[] = { '%', token.specifier, '\0' };
+            const size_t size =
+              std::strftime(text, sizeof(text), format, local);
+            token.text = QString::fromUtf8(text, int(size));
+        }
+    }
+}
+
+void FileNameFormatter::format(QString& name, const Context& context) const
+{
+    if (m_hasTime) {
+        updateTime();
+    }
+    // Unlike clear(), keeps the allocated storage
+    name.resize(0);
+    for (const Token& token : qAsConst(m_tokens)) {
+        switch (token.type) {
+            case LITERAL:
+            case TIME:
+                name += token.text;
+                break;
+            case COUNTER:
+                appendNumber(name, context.counter);
+                break;
+            case SCREEN:
+                name += context.screen;
+                break;
+            case SIZE:
+                if (!context.size.isEmpty()) {
+                    appendNumber(name, context.size.width());
+                    name += QLatin1Char('x');
+                    appendNumber(name, context.size.height());
+                }
+                break;
+        }
+    }
+    // add the parsed pattern in a correct format for the filesystem
+    name.replace(QLatin1Char('/'), QChar(0x2044))
+      .replace(QLatin1Char(':'), QLatin1Char('-'));
+}
+
+QString FileNameFormatter::format(const Context& context) const
+{
+    QString name;
+    format(name, context);
+    return name;
+}
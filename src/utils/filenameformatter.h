@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QSize>
+#include <QString>
+#include <QVector>
+#include <ctime>
+
+// A file name pattern compiled into a list of tokens: literal text, strftime
+// specifiers such as %Y, and the flameshot tokens %{counter}, %{screen} and
+// %{size}. The strftime specifiers are only formatted once per second, so a
+// burst of captures doesn't call strftime for each of them.
+//
+// Not thread safe, format() updates the cached time.
+class FileNameFormatter
+{
+public:
+    // Values of the tokens that don't come from the clock
+    struct Context
+    {
+        Context()
+          : counter(0)
+        {}
+
+        // Name of the screen of the capture
+        QString screen;
+        // Size of the capture in pixels
+        QSize size;
+        // Number of the capture. FileNameHandler replaces 0 by the number of
+        // the next saved capture.
+        int counter;
+    };
+
+    explicit FileNameFormatter(const QString& pattern = QString());
+
+    const QString& pattern() const;
+    // Whether the pattern contains %{counter}
+    bool hasCounter() const;
+    // Replaces the content of name
+    void format(QString& name, const Context& context = Context()) const;
+    QString format(const Context& context = Context()) const;
+
+private:
+    enum TokenType
+    {
+        LITERAL,
+        TIME,
+        COUNTER,
+        SCREEN,
+        SIZE,
+    };
+    struct Token
+    {
+        TokenType type;
+        // The literal text, or the formatted time of a TIME token
+        QString text;
+        // The strftime specifier of a TIME token
+        char specifier;
+    };
+
+    void updateTime() const;
+
+    QString m_pattern;
+    mutable QVector<Token> m_tokens;
+    bool m_hasTime;
+    bool m_hasCounter;
+    mutable std::time_t m_time;
+};
@@ -3,13 +3,141 @@
 
 #include "filenamehandler.h"
 #include "abstractlogger.h"
+#include "src/core/qguiappcurrentscreen.h"
 #include "src/utils/confighandler.h"
-#include "src/utils/strfparse.h"
 #include <QDir>
-#include <ctime>
+#include <QDirIterator>
+#include <QFile>
+#include <QHash>
+#include <QLockFile>
+#include <QMutex>
+#include <QPixmap>
+#include <QSaveFile>
+#include <QScreen>
+#include <QStandardPaths>
 #include <exception>
 #include <locale>
 
+namespace {
+
+// The configured pattern, compiled with the first name and again when the
+// config file changes
+FileNameFormatter configuredFormatter;
+bool configuredFormatterLoaded = false;
+QMutex configuredFormatterMutex;
+// Serializes the updates of the capture counter by this process
+QMutex captureCounterMutex;
+
+// Next number to give to the duplicates of each path. It is initialized from
+// a single listing of the directory, so that a burst of captures with the
+// same name doesn't test _1, _2, ... for each of them.
+QHash<QString, int> nextNumbers;
+QMutex nextNumbersMutex;
+
+// Creates an empty file at path, false if it already exists. The check and
+// the creation are atomic, so concurrent saves can't get the same file.
+bool createNewFile(const QString& path)
+{
+    QFile file(path);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
+    return file.open(QIODevice::WriteOnly | QIODevice::NewOnly);
+#else
+    return !file.exists() && file.open(QIODevice::WriteOnly);
+#endif
+}
+
+// Highest NUM among the files of directory named <baseName>_NUM<suffix>
+int highestNumber(const QString& directory,
+                  const QString& baseName,
+                  const QString& suffix)
+{
+    const QString prefix = baseName + QLatin1String("_");
+    int highest = 0;
+    QDirIterator it(directory, QDir::Files | QDir::Hidden | QDir::System);
+    while (it.hasNext()) {
+        it.next();
+        const QString name = it.fileName();
+        if (name.size() <= prefix.size() + suffix.size() ||
+            !name.startsWith(prefix) || !name.endsWith(suffix)) {
+            continue;
+        }
+        const int digits = name.size() - prefix.size() - suffix.size();
+        bool ok;
+        const int number = name.midRef(prefix.size(), digits).toInt(&ok);
+        if (ok && number > highest) {
+            highest = number;
+        }
+    }
+    return highest;
+}
+
+// Called with configuredFormatterMutex locked
+void loadConfiguredFormatter()
+{
+    if (configuredFormatterLoaded) {
+        return;
+    }
+    configuredFormatterLoaded = true;
+    configuredFormatter = FileNameFormatter(ConfigHandler().filenamePattern());
+    QObject::connect(
+      ConfigHandler::getInstance(), &ConfigHandler::fileChanged, []() {
+          const QString pattern = ConfigHandler().filenamePattern();
+          QMutexLocker locker(&configuredFormatterMutex);
+          if (configuredFormatter.pattern() != pattern) {
+              configuredFormatter = FileNameFormatter(pattern);
+          }
+      });
+}
+
+bool usesCounter()
+{
+    QMutexLocker locker(&configuredFormatterMutex);
+    loadConfiguredFormatter();
+    return configuredFormatter.hasCounter();
+}
+
+// The number of the last saved capture is kept in a state file rather than
+// in the settings: saving a capture must not rewrite the config file, which
+// would make every process reload it.
+QString captureCounterPath()
+{
+    return QStandardPaths::writableLocation(
+             QStandardPaths::AppLocalDataLocation) +
+           QStringLiteral("/capture-counter");
+}
+
+int lastCaptureNumber()
+{
+    QFile file(captureCounterPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    return qMax(0, file.readAll().trimmed().toInt());
+}
+
+// Number of a new saved capture, which goes on across the `flameshot gui`
+// processes and restarts
+int takeCaptureNumber()
+{
+    QMutexLocker locker(&captureCounterMutex);
+    const QString path = captureCounterPath();
+    QDir().mkpath(QFileInfo(path).path());
+    // Held by the process which takes a number
+    QLockFile lock(path + QStringLiteral(".lock"));
+    lock.lock();
+    const int number = lastCaptureNumber() + 1;
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(QByteArray::number(number)) < 0 || !file.commit()) {
+        AbstractLogger::warning(AbstractLogger::Stderr)
+          << QObject::tr("Unable to save the capture counter in %1")
+               .arg(path);
+    }
+    return number;
+}
+
+} // unnamed namespace
+
 FileNameHandler::FileNameHandler(QObject* parent)
   : QObject(parent)
 {
@@ -24,30 +152,38 @@ FileNameHandler::FileNameHandler(QObject* parent)
     }
 }
 
-QString FileNameHandler::parsedPattern()
+QString FileNameHandler::parsedPattern(
+  const FileNameFormatter::Context& context)
 {
-    return parseFilename(ConfigHandler().filenamePattern());
+    QMutexLocker locker(&configuredFormatterMutex);
+    loadConfiguredFormatter();
+    FileNameFormatter::Context numbered = context;
+    if (numbered.counter == 0 && configuredFormatter.hasCounter()) {
+        // Only the saved captures take a number
+        numbered.counter = lastCaptureNumber() + 1;
+    }
+    return configuredFormatter.format(numbered);
 }
 
-QString FileNameHandler::parseFilename(const QString& name)
+FileNameFormatter::Context FileNameHandler::captureContext(
+  const QPixmap& capture)
 {
-    QString res = name;
-    if (name.isEmpty()) {
-        res = ConfigHandler().filenamePatternDefault();
+    FileNameFormatter::Context context;
+    QScreen* screen = QGuiAppCurrentScreen().currentScreen();
+    if (screen != nullptr) {
+        context.screen = screen->name();
     }
+    context.size = capture.size();
+    return context;
+}
 
-    // remove trailing characters '%' in the pattern
-    while (res.endsWith('%')) {
-        res.chop(1);
+QString FileNameHandler::parseFilename(const QString& name)
+{
+    if (name.isEmpty()) {
+        return FileNameFormatter(ConfigHandler().filenamePatternDefault())
+          .format();
     }
-
-    res =
-      QString::fromStdString(strfparse::format_time_string(name.toStdString()));
-
-    // add the parsed pattern in a correct format for the filesystem
-    res = res.replace(QLatin1String("/"), QStringLiteral("⁄"))
-            .replace(QLatin1String(":"), QLatin1String("-"));
-    return res;
+    return FileNameFormatter(name).format();
 }
 
 /**
@@ -60,25 +196,86 @@ QString FileNameHandler::parseFilename(const QString& name)
  * suffix matching the specified `format`.
  * @note
  * - If `path` points to a directory, the file name will be generated from the
- *   formatted file name from the user configuration
+ *   formatted file name from the user configuration, with the next number of
+ *   the %{counter} token
  * - If `path` points to a file, its suffix will be changed to match `format`
  * - If `format` is not given, the suffix will remain untouched, unless `path`
  *   has no suffix, in which case it will be given the "png" suffix
  * - If the path generated by the previous steps points to an existing file,
- *   "_NUM" will be appended to its base name, where NUM is the first
- * available number that produces a non-existent path (starting from 1).
+ *   "_NUM" will be appended to its base name, where NUM is above the numbers
+ *   of the existing duplicates (starting from 1).
+ * - Nothing is created and no number is taken, two proposals can be the same
  * @param path Possibly incomplete file name to transform
  * @param format Desired output file suffix (excluding an initial '.' character)
+ * @param context Values of the tokens of the pattern describing the capture
  */
-QString FileNameHandler::properScreenshotPath(QString path,
-                                              const QString& format)
+QString FileNameHandler::proposeScreenshotPath(
+  QString path,
+  const QString& format,
+  const FileNameFormatter::Context& context)
+{
+    path = completePath(path, format, context);
+    if (!QFileInfo::exists(path)) {
+        return path;
+    }
+    QFileInfo info(path);
+    QString suffix = info.suffix();
+    if (!suffix.isEmpty()) {
+        suffix = QStringLiteral(".") + suffix;
+    }
+    const QString directory = info.dir().absolutePath();
+    const QString baseName = info.completeBaseName();
+    return directory + "/" + baseName + QLatin1String("_") +
+           QString::number(highestNumber(directory, baseName, suffix) + 1) +
+           suffix;
+}
+
+/**
+ * @brief Same path as proposeScreenshotPath(), for a capture which is
+ * written right away.
+ * @note
+ * - If `path` points to a directory, the capture takes the next number of the
+ *   %{counter} token
+ * - The file is created empty, so that other saves, from this process or
+ *   another one, can't pick the same path. Callers that don't write it must
+ *   remove it.
+ */
+QString FileNameHandler::reserveScreenshotPath(
+  QString path,
+  const QString& format,
+  const FileNameFormatter::Context& context)
+{
+    FileNameFormatter::Context numbered = context;
+    if (numbered.counter == 0 && QFileInfo(path).isDir() && usesCounter()) {
+        numbered.counter = takeCaptureNumber();
+    }
+    path = completePath(path, format, numbered);
+    if (createNewFile(path) || !QFileInfo::exists(path)) {
+        // When the file can't be created, saving it reports the error
+        return path;
+    }
+    return autoNumerateDuplicate(path);
+}
+
+void FileNameHandler::takeProposedNumber()
+{
+    if (usesCounter()) {
+        takeCaptureNumber();
+    }
+}
+
+// path with the file name and suffix, before the duplicates are numbered
+QString FileNameHandler::completePath(QString path,
+                                      const QString& format,
+                                      const FileNameFormatter::Context& context)
 {
     QFileInfo info(path);
     QString suffix = info.suffix();
 
     if (info.isDir()) {
         // path is a directory => generate filename from configured pattern
-        path = QDir(QDir(path).absolutePath() + "/" + parsedPattern()).path();
+        path = QDir(QDir(path).absolutePath() + "/" + parsedPattern(context))
+                 .path();
     } else {
         // path points to a file => strip it of its suffix for now
         path = QDir(info.dir().absolutePath() + "/" + info.completeBaseName())
@@ -94,37 +291,33 @@ QString FileNameHandler::properScreenshotPath(QString path,
     } else {
         path += ".png";
     }
-
-    if (!QFileInfo::exists(path)) {
-        return path;
-    } else {
-        return autoNumerateDuplicate(path);
-    }
+    return path;
 }
 
-QString FileNameHandler::autoNumerateDuplicate(QString path)
+QString FileNameHandler::autoNumerateDuplicate(const QString& path)
 {
     // add numeration in case of repeated filename in the directory
-    // find unused name adding _n where n is a number
-    QFileInfo checkFile(path);
-    QString directory = checkFile.dir().absolutePath(),
-            filename = checkFile.completeBaseName(),
-            suffix = checkFile.suffix();
+    QFileInfo info(path);
+    const QString directory = info.dir().absolutePath();
+    const QString baseName = info.completeBaseName();
+    QString suffix = info.suffix();
     if (!suffix.isEmpty()) {
         suffix = QStringLiteral(".") + suffix;
     }
-    if (checkFile.exists()) {
-        filename += QLatin1String("_");
-        int i = 1;
-        while (true) {
-            checkFile.setFile(directory + "/" + filename + QString::number(i) +
-                              suffix);
-            if (!checkFile.exists()) {
-                filename += QString::number(i);
-                break;
-            }
-            ++i;
+
+    QMutexLocker locker(&nextNumbersMutex);
+    auto next = nextNumbers.find(path);
+    if (next == nextNumbers.end()) {
+        next = nextNumbers.insert(
+          path, highestNumber(directory, baseName, suffix) + 1);
+    }
+    while (true) {
+        const QString candidate = directory + "/" + baseName +
+                                  QLatin1String("_") +
+                                  QString::number((*next)++) + suffix;
+        // Taken by another process since the directory was listed
+        if (createNewFile(candidate) || !QFileInfo::exists(candidate)) {
+            return candidate;
         }
     }
-    return checkFile.filePath();
 }
@@ -3,22 +3,47 @@
 
 #pragma once
 
+#include "src/utils/filenameformatter.h"
 #include <QObject>
 
+class QPixmap;
+
 class FileNameHandler : public QObject
 {
     Q_OBJECT
 public:
     explicit FileNameHandler(QObject* parent = nullptr);
 
-    QString parsedPattern();
+    // The configured pattern, compiled again only when the config file
+    // changes. Without a counter in context, %{counter} is the number the
+    // next saved capture will take.
+    QString parsedPattern(const FileNameFormatter::Context& context =
+                            FileNameFormatter::Context());
     QString parseFilename(const QString& name);
+    // Values of the %{screen} and %{size} tokens for capture
+    static FileNameFormatter::Context captureContext(const QPixmap& capture);
 
-    QString properScreenshotPath(QString filename,
-                                 const QString& format = QString());
+    // Destination of a capture, without side effect: the name proposed by
+    // the save dialog, or the one of a file which isn't a saved capture
+    QString proposeScreenshotPath(QString path,
+                                  const QString& format = QString(),
+                                  const FileNameFormatter::Context& context =
+                                    FileNameFormatter::Context());
+    // Destination of a capture about to be written: it takes its number and
+    // the file is created, so no other save can pick it
+    QString reserveScreenshotPath(QString path,
+                                  const QString& format = QString(),
+                                  const FileNameFormatter::Context& context =
+                                    FileNameFormatter::Context());
+    // The capture was saved under the name proposed by
+    // proposeScreenshotPath(), with the number it showed
+    static void takeProposedNumber();
 
     static const int MAX_CHARACTERS = 70;
 
 private:
-    QString autoNumerateDuplicate(QString path);
+    QString completePath(QString path,
+                         const QString& format,
+                         const FileNameFormatter::Context& context);
+    QString autoNumerateDuplicate(const QString& path);
 };
@@ -0,0 +1,345 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "iconcache.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QLockFile>
+#include <QPainter>
+#include <QPixmap>
+#include <QPixmapCache>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+
+namespace {
+
+const quint32 ATLAS_MAGIC = 0x41495346; // "FSIA"
+const quint32 ATLAS_VERSION = 2;
+// Keeps every image scanline suitably aligned
+const qint64 ATLAS_IMAGE_ALIGNMENT = 64;
+// Longest wait for another process appending to the atlas
+const int ATLAS_LOCK_TIMEOUT = 100;
+
+// Rasterizations of a given build are only valid for that build
+const QString ATLAS_BUILD_ID =
+  QStringLiteral(APP_VERSION " " FLAMESHOT_GIT_HASH);
+
+qint64 align(qint64 value, qint64 alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void writeRecord(QDataStream& stream, const QString& key, const QImage& image)
+{
+    QIODevice* device = stream.device();
+    stream << key << static_cast<qint32>(image.width())
+           << static_cast<qint32>(image.height())
+           << static_cast<qint32>(image.bytesPerLine())
+           << static_cast<double>(image.devicePixelRatio());
+    const qint64 pos = device->pos();
+    device->write(
+      QByteArray(int(align(pos, ATLAS_IMAGE_ALIGNMENT) - pos), '\0'));
+    device->write(reinterpret_cast<const char*>(image.constBits()),
+                  qint64(image.bytesPerLine()) * image.height());
+}
+
+class IconAtlas;
+
+// Deleted by IconCache::reset()
+IconAtlas*& atlasInstance()
+{
+    static IconAtlas* instance = nullptr;
+    return instance;
+}
+
+// The atlas file is a header followed by records, each one the description
+// of an image and its aligned pixels. Running processes map the file, so it
+// is never truncated or rewritten in place: new rasterizations are appended,
+// and a damaged atlas is replaced by a new file, the mappings keep the old
+// one. Each build has its own file.
+class IconAtlas
+{
+public:
+    IconAtlas();
+    ~IconAtlas();
+
+    bool find(const QString& key, QImage& image) const;
+    void insert(const QString& key, const QImage& image);
+    void save();
+    QString path() const;
+
+private:
+    void load();
+    bool append(const QStringList& keys);
+    bool replace();
+
+    QString m_path;
+    QFile m_file;
+    uchar* m_map;
+    // Size of the file when it was loaded, and of its valid part
+    qint64 m_loadedSize;
+    qint64 m_validSize;
+    // Images loaded from the atlas reference the mapped file
+    QHash<QString, QImage> m_images;
+    // Keys of the images not written yet
+    QStringList m_pending;
+};
+
+IconAtlas::IconAtlas()
+  : m_map(nullptr)
+  , m_loadedSize(0)
+  , m_validSize(0)
+{
+    QString dir =
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!dir.isEmpty()) {
+        QString build = ATLAS_BUILD_ID;
+        build.replace(QRegularExpression(QStringLiteral("[^0-9A-Za-z.]")),
+                      QStringLiteral("_"));
+        m_path = dir + QStringLiteral("/icons-%1.atlas").arg(build);
+        load();
+    }
+}
+
+IconAtlas::~IconAtlas()
+{
+    if (m_map != nullptr) {
+        m_file.unmap(m_map);
+    }
+}
+
+bool IconAtlas::find(const QString& key, QImage& image) const
+{
+    auto it = m_images.constFind(key);
+    if (it == m_images.constEnd()) {
+        return false;
+    }
+    image = it.value();
+    return true;
+}
+
+void IconAtlas::insert(const QString& key, const QImage& image)
+{
+    m_images.insert(key, image);
+    if (m_path.isEmpty()) {
+        return;
+    }
+    if (m_pending.isEmpty()) {
+        // All the icons of an overlay are requested during its construction,
+        // append them at once
+        QTimer::singleShot(0, []() {
+            if (IconAtlas* instance = atlasInstance()) {
+                instance->save();
+            }
+        });
+    }
+    m_pending << key;
+}
+
+void IconAtlas::load()
+{
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const qint64 fileSize = m_file.size();
+    m_loadedSize = fileSize;
+    m_map = m_file.map(0, fileSize);
+    if (m_map == nullptr) {
+        m_file.close();
+        return;
+    }
+
+    QDataStream stream(QByteArray::fromRawData(
+      reinterpret_cast<const char*>(m_map), static_cast<int>(fileSize)));
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0, version = 0;
+    QString buildId;
+    stream >> magic >> version >> buildId;
+    if (stream.status() != QDataStream::Ok || magic != ATLAS_MAGIC ||
+        version != ATLAS_VERSION || buildId != ATLAS_BUILD_ID) {
+        return;
+    }
+    m_validSize = stream.device()->pos();
+
+    // A record cut by a crash ends the valid part of the file
+    while (!stream.atEnd()) {
+        QString key;
+        qint32 width = 0, height = 0, bytesPerLine = 0;
+        double dpr = 1;
+        stream >> key >> width >> height >> bytesPerLine >> dpr;
+        const qint64 offset =
+          align(stream.device()->pos(), ATLAS_IMAGE_ALIGNMENT);
+        const qint64 end = offset + qint64(bytesPerLine) * height;
+        if (stream.status() != QDataStream::Ok || width < 0 || height < 0 ||
+            bytesPerLine < width * 4 || end > fileSize) {
+            break;
+        }
+        QImage image;
+        if (width > 0 && height > 0) {
+            image = QImage(m_map + offset,
+                           width,
+                           height,
+                           bytesPerLine,
+                           QImage::Format_ARGB32_Premultiplied);
+            image.setDevicePixelRatio(dpr);
+        }
+        m_images.insert(key, image);
+        stream.device()->seek(end);
+        m_validSize = end;
+    }
+}
+
+QString IconAtlas::path() const
+{
+    return m_path;
+}
+
+void IconAtlas::save()
+{
+    if (m_pending.isEmpty()) {
+        return;
+    }
+    const QStringList keys = m_pending;
+    m_pending.clear();
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    // Serializes the writes of the daemon and of the other captures
+    QLockFile lock(m_path + QStringLiteral(".lock"));
+    if (!lock.tryLock(ATLAS_LOCK_TIMEOUT)) {
+        return;
+    }
+    const qint64 size = QFileInfo(m_path).size();
+    // Appended after records known to be complete: the ones this process
+    // loaded, or the ones another process wrote since
+    if (size > 0 && (size != m_loadedSize || m_validSize == m_loadedSize)) {
+        append(keys);
+    } else {
+        replace();
+    }
+}
+
+bool IconAtlas::append(const QStringList& keys)
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    for (const QString& key : keys) {
+        writeRecord(stream, key, m_images.value(key));
+    }
+    file.flush();
+    m_loadedSize = m_validSize = file.size();
+    return stream.status() == QDataStream::Ok;
+}
+
+// Writes all the known images to a new file, renamed over the atlas. The
+// processes which mapped the previous file keep it until they exit.
+bool IconAtlas::replace()
+{
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << ATLAS_MAGIC << ATLAS_VERSION << ATLAS_BUILD_ID;
+    for (auto it = m_images.constBegin(); it != m_images.constEnd(); ++it) {
+        writeRecord(stream, it.key(), it.value());
+    }
+    const qint64 size = file.pos();
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+        return false;
+    }
+    m_loadedSize = m_validSize = size;
+
+    // The atlases of the other builds, unlinked files stay mapped
+    const QFileInfo info(m_path);
+    const QStringList others =
+      info.dir().entryList({ QStringLiteral("icons*.atlas") }, QDir::Files);
+    for (const QString& name : others) {
+        if (name != info.fileName()) {
+            QFile::remove(info.dir().filePath(name));
+        }
+    }
+    return true;
+}
+
+IconAtlas& atlas()
+{
+    IconAtlas*& instance = atlasInstance();
+    if (instance == nullptr) {
+        instance = new IconAtlas();
+    }
+    return *instance;
+}
+QImage rasterize(const QIcon& icon, const QSize& size, qreal dpr)
+{
+    if (icon.isNull() || size.isEmpty()) {
+        return {};
+    }
+    QImage image(size * dpr, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    icon.paint(&painter, image.rect());
+    painter.end();
+    image.setDevicePixelRatio(dpr);
+    return image;
+}
+
+} // unnamed namespace
+
+namespace IconCache {
+
+QIcon icon(const QString& id,
+           const QSize& size,
+           qreal devicePixelRatio,
+           const std::function<QIcon()>& factory)
+{
+    const QString key = QStringLiteral("%1@%2x%3@%4")
+                          .arg(id)
+                          .arg(size.width())
+                          .arg(size.height())
+                          .arg(devicePixelRatio);
+    const QString pixmapKey = QStringLiteral("flameshot-icon:") + key;
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(pixmapKey, &pixmap)) {
+        QImage image;
+        if (!atlas().find(key, image)) {
+            image = rasterize(factory(), size, devicePixelRatio);
+            atlas().insert(key, image);
+        }
+        if (image.isNull()) {
+            return {};
+        }
+        pixmap = QPixmap::fromImage(image);
+        QPixmapCache::insert(pixmapKey, pixmap);
+    }
+    return QIcon(pixmap);
+}
+
+void reset(bool removeAtlas)
+{
+    QPixmapCache::clear();
+    IconAtlas*& instance = atlasInstance();
+    if (instance == nullptr) {
+        return;
+    }
+    instance->save();
+    if (removeAtlas) {
+        QFile::remove(instance->path());
+    }
+    delete instance;
+    instance = nullptr;
+}
+
+} // namespace
@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QIcon>
+#include <functional>
+
+// Pre-rasterized icons for the capture overlay.
+//
+// Icons are rendered once per (id, size, device pixel ratio) and kept in
+// QPixmapCache. The pixels are also appended to an atlas file in the cache
+// directory, which is memory-mapped on the next launches, so the SVG sources
+// only have to be parsed the first time a combination is displayed.
+//
+// The device pixel ratio is only known once a widget is on its screen,
+// widgets get their icons again when it changes.
+namespace IconCache {
+
+// The id must identify the icon returned by factory, including its color
+// variant. The factory is only called when no rasterization is cached.
+QIcon icon(const QString& id,
+           const QSize& size,
+           qreal devicePixelRatio,
+           const std::function<QIcon()>& factory);
+
+// Forgets the rasterizations kept in memory, and those of the atlas file if
+// removeAtlas, as if the process started again. Exposed for benchmarking.
+void reset(bool removeAtlas);
+
+} // namespace
@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "logbuffer.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QStandardPaths>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+// Number of slots of the ring buffer, a power of two
+#define LOG_BUFFER_CAPACITY 1024
+// UTF-16 code units per slot, header included
+#define LOG_SLOT_LENGTH 500
+// Longest wait of the flusher, in milliseconds
+#define LOG_FLUSH_INTERVAL 50
+// Size above which the log file is rotated when it is opened
+#define LOG_FILE_MAX_SIZE (1024 * 1024)
+
+namespace {
+
+struct Slot
+{
+    // Bounded MPSC queue (D. Vyukov): the slot is free for the producer
+    // claiming position p when sequence == p, and holds a message for the
+    // consumer when sequence == p + 1
+    std::atomic<quint64> sequence;
+    qint64 timestamp;
+    int outputs;
+    int length;
+    ushort text[LOG_SLOT_LENGTH];
+};
+
+// The flusher thread
+class Buffer : public QThread
+{
+public:
+    Buffer()
+      : m_slots(new Slot[LOG_BUFFER_CAPACITY])
+    {
+        for (quint64 i = 0; i < LOG_BUFFER_CAPACITY; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        start(QThread::LowPriority);
+    }
+
+    // Runs when the process exits, the last messages are written before
+    ~Buffer() override
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_stop = true;
+            m_wakeUp.wakeOne();
+        }
+        wait();
+        delete[] m_slots;
+    }
+
+    bool push(int outputs,
+              bool urgent,
+              const QString& header,
+              const QString& msg)
+    {
+        quint64 pos = m_head.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &m_slots[pos & (LOG_BUFFER_CAPACITY - 1)];
+            const quint64 seq = slot->sequence.load(std::memory_order_acquire);
+            const qint64 diff = qint64(seq) - qint64(pos);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(
+                      pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->timestamp = QDateTime::currentMSecsSinceEpoch();
+        slot->outputs = outputs;
+        const int headerLength = qMin(header.size(), LOG_SLOT_LENGTH);
+        int msgLength = qMin(msg.size(), LOG_SLOT_LENGTH - headerLength);
+        if (msgLength > 0 && msgLength < msg.size() &&
+            msg.at(msgLength - 1).isHighSurrogate()) {
+            --msgLength;
+        }
+        std::memcpy(slot->text, header.utf16(), headerLength * sizeof(ushort));
+        std::memcpy(slot->text + headerLength,
+                    msg.utf16(),
+                    msgLength * sizeof(ushort));
+        slot->length = headerLength + msgLength;
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        if (urgent) {
+            // Written before returning, with the messages queued before it,
+            // so that they are not lost if the process crashes. Another
+            // producer may still be copying into an earlier slot.
+            while (drain() <= pos) {
+                QThread::yieldCurrentThread();
+            }
+        }
+        return true;
+    }
+
+    quint64 dropped() const
+    {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void run() override
+    {
+        m_mutex.lock();
+        while (!m_stop) {
+            m_wakeUp.wait(&m_mutex, LOG_FLUSH_INTERVAL);
+            m_mutex.unlock();
+            drain();
+            m_mutex.lock();
+        }
+        m_mutex.unlock();
+        drain();
+    }
+
+private:
+    // Called by the flusher and by the threads logging an error, returns the
+    // position of the first message not written yet
+    quint64 drain()
+    {
+        QMutexLocker locker(&m_drainMutex);
+        QByteArray err, file;
+        quint64 pos = m_tail;
+        for (;;) {
+            Slot& slot = m_slots[pos & (LOG_BUFFER_CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            const QString text =
+              QString::fromUtf16(slot.text, slot.length) + QLatin1Char('\n');
+            if (slot.outputs & LogBuffer::Stderr) {
+                err += text.toLocal8Bit();
+            }
+            if (slot.outputs & LogBuffer::LogFile) {
+                file += QDateTime::fromMSecsSinceEpoch(slot.timestamp)
+                          .toString(Qt::ISODateWithMs)
+                          .toUtf8() +
+                        ' ' + text.toUtf8();
+            }
+            slot.sequence.store(pos + LOG_BUFFER_CAPACITY,
+                                std::memory_order_release);
+            ++pos;
+        }
+        m_tail = pos;
+
+        const quint64 dropped = this->dropped();
+        if (dropped != m_reportedDrops) {
+            const QByteArray warning =
+              "flameshot: warning: " +
+              QByteArray::number(dropped - m_reportedDrops) +
+              " log messages dropped\n";
+            err += warning;
+            // The log file is only written when the user enabled it
+            if (!file.isEmpty() || m_file.isOpen()) {
+                file += QDateTime::currentDateTime()
+                          .toString(Qt::ISODateWithMs)
+                          .toUtf8() +
+                        ' ' + warning;
+            }
+            m_reportedDrops = dropped;
+        }
+
+        if (!err.isEmpty()) {
+            std::fwrite(err.constData(), 1, err.size(), stderr);
+            std::fflush(stderr);
+        }
+        if (!file.isEmpty() && openLogFile()) {
+            m_file.write(file);
+            m_file.flush();
+        }
+        return pos;
+    }
+
+    bool openLogFile()
+    {
+        if (m_file.isOpen() || m_fileFailed) {
+            return m_file.isOpen();
+        }
+        const QString path = LogBuffer::logFilePath();
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        if (QFileInfo(path).size() > LOG_FILE_MAX_SIZE) {
+            QFile::remove(path + ".1");
+            QFile::rename(path, path + ".1");
+        }
+        m_file.setFileName(path);
+        m_fileFailed = !m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+        return !m_fileFailed;
+    }
+
+    Slot* m_slots;
+    std::atomic<quint64> m_head{ 0 };
+    std::atomic<quint64> m_dropped{ 0 };
+    // Guards m_stop
+    QMutex m_mutex;
+    QWaitCondition m_wakeUp;
+    bool m_stop = false;
+    // Guards the consumer side of the queue and the outputs
+    QMutex m_drainMutex;
+    quint64 m_tail = 0;
+    quint64 m_reportedDrops = 0;
+    QFile m_file;
+    bool m_fileFailed = false;
+};
+
+Buffer& instance()
+{
+    static Buffer buffer;
+    return buffer;
+}
+
+} // unnamed namespace
+
+namespace LogBuffer {
+
+bool push(int outputs, bool urgent, const QString& header, const QString& msg)
+{
+    return instance().push(outputs, urgent, header, msg);
+}
+
+quint64 droppedMessages()
+{
+    return instance().dropped();
+}
+
+QString logFilePath()
+{
+    return QStandardPaths::writableLocation(
+             QStandardPaths::AppLocalDataLocation) +
+           QStringLiteral("/flameshot.log");
+}
+
+} // namespace
@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QString>
+
+// Backend of the Stderr and LogFile targets of AbstractLogger.
+//
+// Messages are copied into a fixed size lock-free ring buffer, timestamped,
+// and written by a background thread, so logging never waits for the
+// terminal or the disk. Urgent messages are the exception, they are written
+// with the queued ones before push() returns. When the buffer is full the
+// message is dropped and counted, the flusher reports the drops on its next
+// pass. Messages longer than a slot are truncated.
+//
+// The log file is flameshot.log in the application data directory, it is
+// rotated to flameshot.log.1 when it grows too large.
+namespace LogBuffer {
+
+enum Output
+{
+    Stderr = 0x01,
+    LogFile = 0x02,
+};
+
+// outputs is a combination of Output values. Returns false when the message
+// was dropped.
+bool push(int outputs, bool urgent, const QString& header, const QString& msg);
+quint64 droppedMessages();
+QString logFilePath();
+
+} // namespace
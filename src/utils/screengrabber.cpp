@@ -6,6 +6,7 @@
 #include "src/core/qguiappcurrentscreen.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/systemnotification.h"
+#include "src/utils/tracing.h"
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QGuiApplication>
@@ -21,6 +22,8 @@
 #include <QUuid>
 #endif
 
+#define SCREENSHOT_FILE_VARIABLE "FLAMESHOT_SCREENSHOT_FILE"
+
 ScreenGrabber::ScreenGrabber(QObject* parent)
   : QObject(parent)
 {}
@@ -84,7 +87,14 @@ void ScreenGrabber::freeDesktopPortal(bool& ok, QPixmap& res)
 }
 QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
 {
+    TRACE_SPAN("ScreenGrabber::grabEntireDesktop");
     ok = true;
+    // Stand-in for the screen, to replay recorded sessions without a display
+    if (qEnvironmentVariableIsSet(SCREENSHOT_FILE_VARIABLE)) {
+        QPixmap p(QString::fromLocal8Bit(qgetenv(SCREENSHOT_FILE_VARIABLE)));
+        ok = !p.isNull();
+        return p;
+    }
 #if defined(Q_OS_MACOS)
     QScreen* currentScreen = QGuiAppCurrentScreen().currentScreen();
     QPixmap screenPixmap(
@@ -157,6 +167,7 @@ QRect ScreenGrabber::screenGeometry(QScreen* screen)
 
 QPixmap ScreenGrabber::grabScreen(QScreen* screen, bool& ok)
 {
+    TRACE_SPAN("ScreenGrabber::grabScreen");
     QPixmap p;
     QRect geometry = screenGeometry(screen);
     if (m_info.waylandDetected()) {
@@ -172,6 +183,29 @@ QPixmap ScreenGrabber::grabScreen(QScreen* screen, bool& ok)
     return p;
 }
 
+QPixmap ScreenGrabber::grabRegion(const QRect& region, bool& ok)
+{
+    TRACE_SPAN("ScreenGrabber::grabRegion");
+    ok = false;
+    // The portal only captures whole screens, and asks the user every time
+    if (m_info.waylandDetected()) {
+        return QPixmap();
+    }
+#if QT_VERSION > QT_VERSION_CHECK(5, 10, 0)
+    QScreen* screen = qApp->screenAt(region.center());
+#else
+    QScreen* screen =
+      qApp->screens()[qApp->desktop()->screenNumber(region.center())];
+#endif
+    if (screen == nullptr) {
+        return QPixmap();
+    }
+    QPixmap p = screen->grabWindow(
+      0, region.x(), region.y(), region.width(), region.height());
+    ok = !p.isNull();
+    return p;
+}
+
 QRect ScreenGrabber::desktopGeometry()
 {
     QRect geometry;
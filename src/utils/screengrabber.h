@@ -15,6 +15,8 @@ public:
     QPixmap grabEntireDesktop(bool& ok);
     QRect screenGeometry(QScreen* screen);
     QPixmap grabScreen(QScreen* screenNumber, bool& ok);
+    // Logical global coordinates, not supported on Wayland
+    QPixmap grabRegion(const QRect& region, bool& ok);
     void freeDesktopPortal(bool& ok, QPixmap& res);
     QRect desktopGeometry();
 
@@ -8,6 +8,7 @@
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/tracing.h"
 #include "utils/desktopinfo.h"
 
 #if USE_WAYLAND_CLIPBOARD
@@ -31,8 +32,11 @@ bool saveToFilesystem(const QPixmap& capture,
                       const QString& path,
                       const QString& messagePrefix)
 {
-    QString completePath = FileNameHandler().properScreenshotPath(
-      path, ConfigHandler().saveAsFileExtension());
+    TRACE_SPAN("saveToFilesystem");
+    QString completePath = FileNameHandler().reserveScreenshotPath(
+      path,
+      ConfigHandler().saveAsFileExtension(),
+      FileNameHandler::captureContext(capture));
     QFile file{ completePath };
     file.open(QIODevice::WriteOnly);
     bool okay = capture.save(&file);
@@ -54,6 +58,8 @@ bool saveToFilesystem(const QPixmap& capture,
         notificationPath = "";
         AbstractLogger::error().attachNotificationPath(notificationPath)
           << saveMessage;
+        // reserveScreenshotPath created it
+        file.remove();
     }
 
     return okay;
@@ -92,6 +98,7 @@ QString ShowSaveFileDialog(const QString& title, const QString& directory)
 
 void saveToClipboardMime(const QPixmap& capture, const QString& imageType)
 {
+    TRACE_SPAN("saveToClipboardMime");
     QByteArray array;
     QBuffer buffer{ &array };
     QImageWriter imageWriter{ &buffer, imageType.toUpper().toUtf8() };
@@ -123,10 +130,11 @@ void saveToClipboardMime(const QPixmap& capture, const QString& imageType)
     }
 }
 
-// If data is saved to the clipboard before the notification is sent via
-// dbus, the application freezes.
+// The notification is queued and sent over D-Bus asynchronously, so it can be
+// sent before or after the clipboard is set.
 void saveToClipboard(const QPixmap& capture)
 {
+    TRACE_SPAN("saveToClipboard");
     // If we are able to properly save the file, save the file and copy to
     // clipboard.
     if ((ConfigHandler().saveAfterCopy()) &&
@@ -156,6 +164,7 @@ void saveToClipboard(const QPixmap& capture)
 
 bool saveToFilesystemGUI(const QPixmap& capture)
 {
+    TRACE_SPAN("saveToFilesystemGUI");
     bool okay = false;
     ConfigHandler config;
     QString defaultSavePath = ConfigHandler().savePath();
@@ -164,8 +173,18 @@ bool saveToFilesystemGUI(const QPixmap& capture)
         defaultSavePath =
           QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
     }
-    QString savePath = FileNameHandler().properScreenshotPath(
-      defaultSavePath, ConfigHandler().saveAsFileExtension());
+    FileNameHandler nameHandler;
+    const FileNameFormatter::Context context =
+      FileNameHandler::captureContext(capture);
+    QString proposal;
+    QString savePath;
+    if (config.savePathFixed()) {
+        savePath = nameHandler.reserveScreenshotPath(
+          defaultSavePath, config.saveAsFileExtension(), context);
+    } else {
+        proposal = nameHandler.proposeScreenshotPath(
+          defaultSavePath, config.saveAsFileExtension(), context);
+    }
 #if defined(Q_OS_MACOS)
     for (QWidget* widget : qApp->topLevelWidgets()) {
         QString className(widget->metaObject()->className());
@@ -178,7 +197,7 @@ bool saveToFilesystemGUI(const QPixmap& capture)
     }
 #endif
     if (!config.savePathFixed()) {
-        savePath = ShowSaveFileDialog(QObject::tr("Save screenshot"), savePath);
+        savePath = ShowSaveFileDialog(QObject::tr("Save screenshot"), proposal);
     }
     if (savePath == "") {
         return okay;
@@ -194,6 +213,9 @@ bool saveToFilesystemGUI(const QPixmap& capture)
           savePath.left(savePath.lastIndexOf(QLatin1String("/")));
 
         ConfigHandler().setSavePath(pathNoFile);
+        if (savePath == proposal) {
+            FileNameHandler::takeProposedNumber();
+        }
 
         QString msg = QObject::tr("Capture saved as ") + savePath;
         AbstractLogger().attachNotificationPath(savePath) << msg;
@@ -209,6 +231,10 @@ bool saveToFilesystemGUI(const QPixmap& capture)
         if (file.error() != QFile::NoError) {
             msg += ": " + file.errorString();
         }
+        if (config.savePathFixed()) {
+            // reserveScreenshotPath created it
+            file.remove();
+        }
 
         QMessageBox saveErrBox(
           QMessageBox::Warning, QObject::tr("Save Error"), msg);
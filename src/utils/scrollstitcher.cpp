@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollstitcher.h"
+#include <QHash>
+#include <cstring>
+
+// Pixels hashed side by side, as independent lanes of a vector register
+#define HASH_LANES 8
+// Rows of a tile of the page
+#define SCROLL_TILE_HEIGHT 512
+// Below the 32767 pixels limit of X11 pixmaps
+#define SCROLL_MAX_HEIGHT 30000
+// Pixels of the page, which is held three times when the capture finishes:
+// in the tiles, in the result and in the pixmap made of it
+#define SCROLL_MAX_PIXELS (32 * 1024 * 1024)
+// Rows two consecutive frames must at least share
+#define MIN_OVERLAP_ROWS 16
+// Rows agreeing on an offset for it to be considered
+#define MIN_SHIFT_VOTES 4
+// Fraction of the overlapping rows explained by the offset or by not moving,
+// the others may be animated
+#define MIN_EXPLAINED_RATIO 0.9
+
+namespace {
+
+// Offset by which the content of previous moved up in next, or 0
+int findShift(const QVector<quint64>& previous, const QVector<quint64>& next)
+{
+    const int h = previous.size();
+    // Row of each hash of the previous frame, -1 if it is not unique. Blank
+    // or repeated rows would vote for every offset.
+    QHash<quint64, int> rows;
+    rows.reserve(h);
+    for (int y = 0; y < h; ++y) {
+        auto it = rows.find(previous[y]);
+        if (it == rows.end()) {
+            rows.insert(previous[y], y);
+        } else {
+            *it = -1;
+        }
+    }
+
+    QVector<int> votes(h, 0);
+    for (int y = 0; y < h; ++y) {
+        auto it = rows.constFind(next[y]);
+        if (it != rows.constEnd() && *it > y) {
+            ++votes[*it - y];
+        }
+    }
+    int shift = 0;
+    for (int d = 1; d <= h - MIN_OVERLAP_ROWS; ++d) {
+        if (votes[d] > votes[shift]) {
+            shift = d;
+        }
+    }
+    if (shift == 0 || votes[shift] < MIN_SHIFT_VOTES) {
+        return 0;
+    }
+
+    // Trailing rows that did not move: the rows above them in next are new
+    int footer = 0;
+    while (footer < h && next[h - 1 - footer] == previous[h - 1 - footer]) {
+        ++footer;
+    }
+    const int overlap = h - footer - shift;
+    if (overlap < MIN_OVERLAP_ROWS) {
+        return 0;
+    }
+    int explained = 0;
+    for (int y = 0; y < overlap; ++y) {
+        if (next[y] == previous[y + shift] || next[y] == previous[y]) {
+            ++explained;
+        }
+    }
+    return explained >= overlap * MIN_EXPLAINED_RATIO ? shift : 0;
+}
+
+} // unnamed namespace
+
+QVector<quint64> ScrollStitcher::rowHashes(const QImage& image)
+{
+    const int w = image.width();
+    QVector<quint64> hashes(image.height());
+    for (int y = 0; y < image.height(); ++y) {
+        const auto* pixels =
+          reinterpret_cast<const quint32*>(image.constScanLine(y));
+        // FNV-1a over interleaved lanes: the inner loop has no dependency
+        // between its iterations, so the compiler turns it into SIMD
+        // multiplications
+        quint32 lanes[HASH_LANES];
+        for (quint32& lane : lanes) {
+            lane = 2166136261u;
+        }
+        int x = 0;
+        for (; x + HASH_LANES <= w; x += HASH_LANES) {
+            for (int k = 0; k < HASH_LANES; ++k) {
+                lanes[k] = (lanes[k] ^ pixels[x + k]) * 16777619u;
+            }
+        }
+        for (; x < w; ++x) {
+            lanes[0] = (lanes[0] ^ pixels[x]) * 16777619u;
+        }
+        quint64 hash = 14695981039346656037ull;
+        for (quint32 lane : lanes) {
+            hash = (hash ^ lane) * 1099511628211ull;
+        }
+        hashes[y] = hash;
+    }
+    return hashes;
+}
+
+int ScrollStitcher::append(const QImage& frame)
+{
+    const QImage image = frame.convertToFormat(QImage::Format_RGB32);
+    if (m_last.isNull()) {
+        if (image.height() > maxHeight(image.width())) {
+            m_full = true;
+            return 0;
+        }
+        m_last = image;
+        m_lastHashes = rowHashes(image);
+        return image.height();
+    }
+    if (m_full || image.size() != m_last.size()) {
+        return 0;
+    }
+
+    const QVector<quint64> hashes = rowHashes(image);
+    if (hashes == m_lastHashes) {
+        return 0;
+    }
+    const int shift = findShift(m_lastHashes, hashes);
+    if (shift == 0) {
+        return 0;
+    }
+    if (height() + shift > maxHeight(m_last.width())) {
+        m_full = true;
+        return 0;
+    }
+
+    // Leading rows that did not move, kept out of the page as long as they
+    // stay in place
+    const int h = hashes.size();
+    int header = 0;
+    while (header < h - shift && hashes[header] == m_lastHashes[header]) {
+        ++header;
+    }
+    header = qMax(header, m_header - shift);
+    // The rows that scrolled out of view, the next frame has the others
+    commit(m_header, header + shift);
+    m_header = header;
+    m_last = image;
+    m_lastHashes = hashes;
+    return shift;
+}
+
+void ScrollStitcher::commit(int from, int to)
+{
+    const int rowBytes = m_last.width() * 4;
+    for (int y = from; y < to; ++y) {
+        const int row = m_committed % SCROLL_TILE_HEIGHT;
+        if (row == 0) {
+            m_tiles << QImage(
+              m_last.width(), SCROLL_TILE_HEIGHT, QImage::Format_RGB32);
+        }
+        std::memcpy(
+          m_tiles.last().scanLine(row), m_last.constScanLine(y), rowBytes);
+        ++m_committed;
+    }
+}
+
+int ScrollStitcher::height() const
+{
+    if (m_last.isNull()) {
+        return 0;
+    }
+    return m_committed + m_last.height() - m_header;
+}
+
+bool ScrollStitcher::isFull() const
+{
+    return m_full;
+}
+
+int ScrollStitcher::maxHeight(int width)
+{
+    return qMin(SCROLL_MAX_HEIGHT, SCROLL_MAX_PIXELS / qMax(width, 1));
+}
+
+QImage ScrollStitcher::result() const
+{
+    if (m_last.isNull()) {
+        return {};
+    }
+    QImage page(m_last.width(), height(), QImage::Format_RGB32);
+    const int rowBytes = m_last.width() * 4;
+    int y = 0;
+    for (; y < m_committed; ++y) {
+        const QImage& tile = m_tiles[y / SCROLL_TILE_HEIGHT];
+        std::memcpy(page.scanLine(y),
+                    tile.constScanLine(y % SCROLL_TILE_HEIGHT),
+                    rowBytes);
+    }
+    for (int row = m_header; row < m_last.height(); ++row, ++y) {
+        std::memcpy(page.scanLine(y), m_last.constScanLine(row), rowBytes);
+    }
+    page.setDevicePixelRatio(m_last.devicePixelRatio());
+    return page;
+}
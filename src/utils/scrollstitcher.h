@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QVector>
+
+// Assembles the frames of a scrolling capture into one tall image.
+//
+// Every row of a frame is reduced to a hash. The rows of the new frame whose
+// hash appears once in the previous frame vote for a vertical offset, and the
+// most voted offset is accepted when it explains most of the rows. Rows that
+// did not move (sticky headers and footers) are kept out of the stitched
+// page. The rows that scrolled out of the top of the view are appended to
+// fixed size tiles, so the page is never reallocated while it grows.
+//
+// Frames must all have the same size. Only downward scrolling is stitched:
+// frames that can't be matched to the previous one are ignored, so scrolling
+// back up and down again resumes where the page stopped.
+class ScrollStitcher
+{
+public:
+    // Returns the number of rows added to the page
+    int append(const QImage& frame);
+    // Height of the page in pixels, bounded by maxHeight()
+    int height() const;
+    bool isFull() const;
+    // Pages are shorter as they get wider, for their size to stay bounded
+    static int maxHeight(int width);
+    // The page, with the device pixel ratio of the frames
+    QImage result() const;
+
+    // Exposed for benchmarking
+    static QVector<quint64> rowHashes(const QImage& image);
+
+private:
+    // Rows of m_last[from, to) are moved to the tiles
+    void commit(int from, int to);
+
+    // The page is made of the committed rows of the tiles, followed by the
+    // rows of the last frame from m_header
+    QImage m_last;
+    QVector<quint64> m_lastHashes;
+    int m_header = 0;
+    QVector<QImage> m_tiles;
+    int m_committed = 0;
+    bool m_full = false;
+};
@@ -2,29 +2,214 @@
 #include "src/core/flameshot.h"
 #include "src/utils/confighandler.h"
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QList>
+#include <QThread>
+#include <QTimer>
 #include <QUrl>
 
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
 #include <QDBusConnection>
-#include <QDBusInterface>
 #include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
 #else
 #include "src/core/flameshotdaemon.h"
 #endif
 
-SystemNotification::SystemNotification(QObject* parent)
-  : QObject(parent)
-  , m_interface(nullptr)
+// Time to wait for related messages, which are shown as a single notification
+#define NOTIFICATION_BATCH_DELAY 100
+// Minimum time between two notifications
+#define NOTIFICATION_MIN_INTERVAL 500
+// Older messages are dropped when more are waiting
+#define MAX_PENDING_NOTIFICATIONS 16
+// Timeout of the D-Bus calls, when the notification server doesn't answer
+#define NOTIFY_CALL_TIMEOUT 5000
+// Time the application waits at exit for the last notifications to be sent
+#define NOTIFY_FLUSH_TIMEOUT 300
+
+namespace {
+
+struct Notification
 {
+    QString text;
+    QString title;
+    QString savePath;
+    SystemNotification::Type type;
+    int timeout;
+
+    // The drag and drop target of a notification is a single path
+    bool canMerge(const Notification& other) const
+    {
+        return type == other.type &&
+               (savePath.isEmpty() || other.savePath.isEmpty() ||
+                savePath == other.savePath);
+    }
+};
+
+// Sends the notifications from the event loop of the GUI thread, one at a
+// time and without waiting for the notification server, which can take
+// seconds to answer.
+class NotificationQueue : public QObject
+{
+public:
+    static NotificationQueue* instance()
+    {
+        // Never deleted, messages may still be sent during the shutdown
+        static auto* queue = new NotificationQueue();
+        return queue;
+    }
+
+    void enqueue(const Notification& notification)
+    {
+        if (QThread::currentThread() != thread()) {
+            QMetaObject::invokeMethod(
+              this,
+              [this, notification]() { enqueue(notification); },
+              Qt::QueuedConnection);
+            return;
+        }
+
+        if (!m_pending.isEmpty() && m_pending.last().canMerge(notification)) {
+            Notification& last = m_pending.last();
+            last.text += QStringLiteral("\n") + notification.text;
+            if (!notification.savePath.isEmpty()) {
+                last.savePath = notification.savePath;
+            }
+            last.timeout = qMax(last.timeout, notification.timeout);
+        } else {
+            if (m_pending.size() >= MAX_PENDING_NOTIFICATIONS) {
+                m_pending.removeFirst();
+            }
+            m_pending << notification;
+        }
+        schedule();
+    }
+
+    void flush()
+    {
+        m_timer.stop();
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
-    m_interface =
-      new QDBusInterface(QStringLiteral("org.freedesktop.Notifications"),
-                         QStringLiteral("/org/freedesktop/Notifications"),
-                         QStringLiteral("org.freedesktop.Notifications"),
-                         QDBusConnection::sessionBus(),
-                         this);
+        QList<QDBusPendingCall> calls;
 #endif
-}
+        while (!m_pending.isEmpty()) {
+            const Notification notification = m_pending.takeFirst();
+#if defined(Q_OS_MACOS) || defined(Q_OS_WIN)
+            if (FlameshotDaemon::instance()) {
+                FlameshotDaemon::instance()->sendTrayNotification(
+                  notification.text, notification.title, notification.timeout);
+            }
+#else
+            calls << QDBusConnection::sessionBus().asyncCall(
+              notifyMessage(notification), NOTIFY_FLUSH_TIMEOUT);
+#endif
+        }
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+        // The messages would be lost with the connection. The calls were all
+        // sent at once, so this waits NOTIFY_FLUSH_TIMEOUT at most.
+        for (QDBusPendingCall& call : calls) {
+            call.waitForFinished();
+        }
+#endif
+    }
+
+private:
+    NotificationQueue()
+    {
+        // The first message can come from a worker thread
+        moveToThread(QCoreApplication::instance()->thread());
+        m_timer.moveToThread(thread());
+        m_timer.setSingleShot(true);
+        QObject::connect(&m_timer, &QTimer::timeout, this, [this]() {
+            dispatch();
+        });
+        // Don't lose the last messages of a short-lived CLI invocation
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+            flush();
+        });
+    }
+
+    void schedule()
+    {
+        if (m_inFlight || m_timer.isActive() || m_pending.isEmpty()) {
+            return;
+        }
+        int delay = NOTIFICATION_BATCH_DELAY;
+        if (m_lastDispatch.isValid()) {
+            delay = qMax<qint64>(
+              delay, NOTIFICATION_MIN_INTERVAL - m_lastDispatch.elapsed());
+        }
+        m_timer.start(delay);
+    }
+
+    void dispatch()
+    {
+        if (m_pending.isEmpty()) {
+            return;
+        }
+        const Notification notification = m_pending.takeFirst();
+        m_lastDispatch.start();
+#if defined(Q_OS_MACOS) || defined(Q_OS_WIN)
+        if (FlameshotDaemon::instance()) {
+            FlameshotDaemon::instance()->sendTrayNotification(
+              notification.text, notification.title, notification.timeout);
+        }
+        schedule();
+#else
+        m_inFlight = true;
+        QDBusPendingCall call = QDBusConnection::sessionBus().asyncCall(
+          notifyMessage(notification), NOTIFY_CALL_TIMEOUT);
+        auto* watcher = new QDBusPendingCallWatcher(call, this);
+        QObject::connect(watcher,
+                         &QDBusPendingCallWatcher::finished,
+                         this,
+                         [this](QDBusPendingCallWatcher* watcher) {
+                             watcher->deleteLater();
+                             m_inFlight = false;
+                             schedule();
+                         });
+#endif
+    }
+
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+    static QDBusMessage notifyMessage(const Notification& notification)
+    {
+        QList<QVariant> args;
+        QVariantMap hintsMap;
+        if (!notification.savePath.isEmpty()) {
+            QUrl fullPath = QUrl::fromLocalFile(notification.savePath);
+            // allows the notification to be dragged and dropped
+            hintsMap[QStringLiteral("x-kde-urls")] =
+              QStringList({ fullPath.toString() });
+        }
+        args << (qAppName())                 // appname
+             << static_cast<unsigned int>(0) // id
+             << "flameshot"                  // icon
+             << notification.title           // summary
+             << notification.text            // body
+             << QStringList()                // actions
+             << hintsMap                     // hints
+             << notification.timeout;        // timeout
+        QDBusMessage message = QDBusMessage::createMethodCall(
+          QStringLiteral("org.freedesktop.Notifications"),
+          QStringLiteral("/org/freedesktop/Notifications"),
+          QStringLiteral("org.freedesktop.Notifications"),
+          QStringLiteral("Notify"));
+        message.setArguments(args);
+        return message;
+    }
+#endif
+
+    QList<Notification> m_pending;
+    QTimer m_timer;
+    QElapsedTimer m_lastDispatch;
+    bool m_inFlight = false;
+};
+
+} // unnamed namespace
+
+SystemNotification::SystemNotification(QObject* parent)
+  : QObject(parent)
+{}
 
 void SystemNotification::sendMessage(const QString& text,
                                      const QString& savePath)
@@ -35,41 +220,19 @@ void SystemNotification::sendMessage(const QString& text,
 void SystemNotification::sendMessage(const QString& text,
                                      const QString& title,
                                      const QString& savePath,
+                                     Type type,
                                      const int timeout)
 {
     if (!ConfigHandler().showDesktopNotification()) {
         return;
     }
+    // The queue also avoids a recursive static initialization of Flameshot
+    // and ConfigHandler on MacOS and Windows, the tray is reached later
+    NotificationQueue::instance()->enqueue(
+      { text, title, savePath, type, timeout });
+}
 
-#if defined(Q_OS_MACOS) || defined(Q_OS_WIN)
-    QMetaObject::invokeMethod(
-      this,
-      [&]() {
-          // The call is queued to avoid recursive static initialization of
-          // Flameshot and ConfigHandler.
-          if (FlameshotDaemon::instance())
-              FlameshotDaemon::instance()->sendTrayNotification(
-                text, title, timeout);
-      },
-      Qt::QueuedConnection);
-#else
-    QList<QVariant> args;
-    QVariantMap hintsMap;
-    if (!savePath.isEmpty()) {
-        QUrl fullPath = QUrl::fromLocalFile(savePath);
-        // allows the notification to be dragged and dropped
-        hintsMap[QStringLiteral("x-kde-urls")] =
-          QStringList({ fullPath.toString() });
-    }
-    args << (qAppName())                 // appname
-         << static_cast<unsigned int>(0) // id
-         << "flameshot"                  // icon
-         << title                        // summary
-         << text                         // body
-         << QStringList()                // actions
-         << hintsMap                     // hints
-         << timeout;                     // timeout
-    m_interface->callWithArgumentList(
-      QDBus::AutoDetect, QStringLiteral("Notify"), args);
-#endif
+void SystemNotification::flush()
+{
+    NotificationQueue::instance()->flush();
 }
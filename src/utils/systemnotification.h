@@ -5,12 +5,20 @@
 
 #include <QObject>
 
-class QDBusInterface;
-
+// Desktop notifications. The messages are queued and sent asynchronously, so
+// a slow notification server never blocks the caller. Messages of the same
+// type sent in a quick succession are shown as one notification.
 class SystemNotification : public QObject
 {
     Q_OBJECT
 public:
+    enum Type
+    {
+        Info,
+        Warning,
+        Error
+    };
+
     explicit SystemNotification(QObject* parent = nullptr);
 
     void sendMessage(const QString& text, const QString& savePath = {});
@@ -18,8 +26,10 @@ public:
     void sendMessage(const QString& text,
                      const QString& title,
                      const QString& savePath,
+                     Type type = Info,
                      const int timeout = 5000);
 
-private:
-    QDBusInterface* m_interface;
+    // Sends the queued messages right away and waits a bounded time for the
+    // notification server. Done when the application quits.
+    static void flush();
 };
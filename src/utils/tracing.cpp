@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <cstdlib>
+
+#define TRACE_FILE_VARIABLE "FLAMESHOT_TRACE_FILE"
+// Events buffered before they are written out, so that a long running daemon
+// does not grow its buffer without bound
+#define TRACE_MAX_EVENTS 4096
+
+namespace {
+
+struct Event
+{
+    const char* name;
+    qint64 begin;
+    qint64 end;
+    quintptr thread;
+};
+
+struct Trace
+{
+    QElapsedTimer clock;
+    QMutex mutex;
+    QVector<Event> events;
+    QFile file;
+    bool hasWritten = false;
+};
+
+void finishTrace();
+
+// The client and the daemon both trace, each process writes its own file
+// named after FLAMESHOT_TRACE_FILE with the pid inserted before the suffix
+QString tracePath()
+{
+    const QString path = QString::fromLocal8Bit(qgetenv(TRACE_FILE_VARIABLE));
+    const QString pid = QString::number(QCoreApplication::applicationPid());
+    const QFileInfo info(path);
+    const QString suffix = info.completeSuffix();
+    if (suffix.isEmpty()) {
+        return path + QStringLiteral(".") + pid;
+    }
+    return path.left(path.size() - suffix.size()) + pid + QStringLiteral(".") +
+           suffix;
+}
+
+// Only called once, when isEnabled() is first evaluated
+Trace* createTrace()
+{
+    if (!qEnvironmentVariableIsSet(TRACE_FILE_VARIABLE)) {
+        return nullptr;
+    }
+    auto* t = new Trace;
+    t->file.setFileName(tracePath());
+    t->events.reserve(TRACE_MAX_EVENTS);
+    t->clock.start();
+    std::atexit(finishTrace);
+    return t;
+}
+
+Trace* instance()
+{
+    static Trace* t = createTrace();
+    return t;
+}
+
+// Appends the buffered events to the file, t->mutex must be held. The file is
+// left open so that a process that crashes still leaves the events it wrote,
+// the trace viewers accept a trace without its closing brackets.
+void flushEvents(Trace* t)
+{
+    if (!t->file.isOpen()) {
+        if (!t->file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            t->events.clear();
+            return;
+        }
+        t->file.write("{\"traceEvents\":[\n");
+    }
+    const qint64 pid = QCoreApplication::applicationPid();
+    QByteArray data;
+    for (const Event& e : qAsConst(t->events)) {
+        // Timestamps are in microseconds
+        data += (t->hasWritten ? ",\n" : "") +
+                QByteArrayLiteral("{\"name\":\"") + e.name +
+                QByteArrayLiteral("\",\"ph\":\"X\",\"ts\":") +
+                QByteArray::number(e.begin / 1000.0, 'f', 3) +
+                QByteArrayLiteral(",\"dur\":") +
+                QByteArray::number((e.end - e.begin) / 1000.0, 'f', 3) +
+                QByteArrayLiteral(",\"pid\":") + QByteArray::number(pid) +
+                QByteArrayLiteral(",\"tid\":") +
+                QByteArray::number(quint64(e.thread)) + "}";
+        t->hasWritten = true;
+    }
+    t->events.clear();
+    t->file.write(data);
+    t->file.flush();
+}
+
+void finishTrace()
+{
+    Trace* t = instance();
+    QMutexLocker locker(&t->mutex);
+    flushEvents(t);
+    if (t->file.isOpen()) {
+        t->file.write("\n],\"displayTimeUnit\":\"ms\"}\n");
+        t->file.close();
+    }
+}
+
+} // unnamed namespace
+
+namespace Tracing {
+
+bool isEnabled()
+{
+    static const bool enabled = instance() != nullptr;
+    return enabled;
+}
+
+qint64 now()
+{
+    return instance()->clock.nsecsElapsed();
+}
+
+void addSpan(const char* name, qint64 begin, qint64 end)
+{
+    Trace* t = instance();
+    const auto thread = reinterpret_cast<quintptr>(QThread::currentThreadId());
+    QMutexLocker locker(&t->mutex);
+    t->events.append({ name, begin, end, thread });
+    if (t->events.size() >= TRACE_MAX_EVENTS) {
+        flushEvents(t);
+    }
+}
+
+} // namespace
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QtGlobal>
+
+// Timing of the capture lifecycle in the Chrome trace event format, which can
+// be opened in chrome://tracing or https://ui.perfetto.dev.
+//
+// Tracing is enabled by setting FLAMESHOT_TRACE_FILE to the path of the JSON
+// file to write, each process writes its own file with its pid inserted before
+// the suffix (trace.json gives trace.<pid>.json). The spans are buffered in
+// memory and written in batches and when the process exits. When disabled, a
+// span costs a test of a static flag.
+namespace Tracing {
+
+bool isEnabled();
+qint64 now();
+void addSpan(const char* name, qint64 begin, qint64 end);
+
+class Span
+{
+public:
+    // name must be a string literal, it is only stored as a pointer
+    explicit Span(const char* name)
+      : m_name(isEnabled() ? name : nullptr)
+      , m_begin(m_name ? now() : 0)
+    {}
+    ~Span()
+    {
+        if (m_name) {
+            addSpan(m_name, m_begin, now());
+        }
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* m_name;
+    qint64 m_begin;
+};
+
+} // namespace
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+// Traces the enclosing scope
+#define TRACE_SPAN(name)                                                       \
+    Tracing::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
@@ -87,6 +87,30 @@ QString String::expected()
     return QStringLiteral("string");
 }
 
+// STRING LIST
+
+bool StringList::check(const QVariant& val)
+{
+    // QSettings reads a single string when there is no comma
+    return val.canConvert<QStringList>();
+}
+
+QVariant StringList::process(const QVariant& val)
+{
+    return val.toStringList();
+}
+
+QVariant StringList::fallback()
+{
+    return QStringList();
+}
+
+QString StringList::expected()
+{
+    return QStringLiteral("comma separated list of strings, the strings "
+                          "containing a comma must be quoted");
+}
+
 // COLOR
 
 Color::Color(QColor def)
@@ -108,6 +108,17 @@ private:
     QString m_def;
 };
 
+// Comma separated in the config file, the strings containing a comma are
+// quoted
+class StringList : public ValueHandler
+{
+public:
+    bool check(const QVariant& val) override;
+    QVariant process(const QVariant& val) override;
+    QVariant fallback() override;
+    QString expected() override;
+};
+
 class Color : public ValueHandler
 {
 public:
@@ -7,6 +7,7 @@
 #include "src/utils/colorutils.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/iconcache.h"
 #include <QApplication>
 #include <QIcon>
 #include <QMouseEvent>
@@ -21,6 +22,7 @@ CaptureToolButton::CaptureToolButton(const CaptureTool::Type t, QWidget* parent)
   , m_buttonType(t)
   , m_tool(nullptr)
   , m_emergeAnimation(nullptr)
+  , m_iconDevicePixelRatio(0)
 {
     initButton();
     if (t == CaptureTool::TYPE_SELECTIONINDICATOR) {
@@ -81,8 +83,19 @@ void CaptureToolButton::initButton()
 
 void CaptureToolButton::updateIcon()
 {
-    setIcon(icon());
-    setIconSize(size() * 0.6);
+    QSize iconSize = size() * 0.6;
+    // The icon only depends on the tool and on its black or white variant
+    QString iconId = QStringLiteral("tool-%1-%2")
+                       .arg(static_cast<int>(m_buttonType))
+                       .arg(ColorUtils::colorIsDark(m_mainColor)
+                              ? QStringLiteral("white")
+                              : QStringLiteral("black"));
+    m_iconDevicePixelRatio = devicePixelRatioF();
+    setIcon(IconCache::icon(iconId,
+                            iconSize,
+                            m_iconDevicePixelRatio,
+                            [this]() { return icon(); }));
+    setIconSize(iconSize);
 }
 
 const QList<CaptureTool::Type>& CaptureToolButton::getIterableButtonTypes()
@@ -96,6 +109,18 @@ QIcon CaptureToolButton::icon() const
     return m_tool->icon(m_mainColor, true);
 }
 
+bool CaptureToolButton::event(QEvent* e)
+{
+    // The ratio of the screen is only known once the button is shown on it
+    if ((e->type() == QEvent::Show ||
+         e->type() == QEvent::ScreenChangeInternal) &&
+        m_buttonType != CaptureTool::TYPE_SELECTIONINDICATOR &&
+        devicePixelRatioF() != m_iconDevicePixelRatio) {
+        updateIcon();
+    }
+    return CaptureButton::event(e);
+}
+
 void CaptureToolButton::mousePressEvent(QMouseEvent* e)
 {
     activateWindow();
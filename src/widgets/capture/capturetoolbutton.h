@@ -32,6 +32,7 @@ public:
     void animatedShow();
 
 protected:
+    bool event(QEvent* e) override;
     void mousePressEvent(QMouseEvent* e) override;
     static QList<CaptureTool::Type> iterableButtonTypes;
 
@@ -46,6 +47,8 @@ private:
     CaptureTool::Type m_buttonType;
 
     QPropertyAnimation* m_emergeAnimation;
+    // Device pixel ratio the icon was rasterized for
+    qreal m_iconDevicePixelRatio;
 
     static QColor m_mainColor;
 
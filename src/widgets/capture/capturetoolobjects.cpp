@@ -2,20 +2,34 @@
 // SPDX-FileCopyrightText: 2021 Yurii Puchkov & Contributors
 
 #include "capturetoolobjects.h"
+#include <QCoreApplication>
 
 #define SEARCH_RADIUS_NEAR 3
 #define SEARCH_RADIUS_FAR 5
 #define SEARCH_RADIUS_TEXT_HANDICAP 5
 
+namespace {
+
+// Whether the rows of both objects show the same thing
+bool sameRow(const QPointer<CaptureTool>& a, const QPointer<CaptureTool>& b)
+{
+    return a->type() == b->type() && a->info() == b->info();
+}
+
+} // unnamed namespace
+
 CaptureToolObjects::CaptureToolObjects(QObject* parent)
-  : QObject(parent)
+  : QAbstractListModel(parent)
 {}
 
 void CaptureToolObjects::append(const QPointer<CaptureTool>& captureTool)
 {
     if (!captureTool.isNull()) {
+        const int row = m_captureToolObjects.size() + 1;
+        beginInsertRows(QModelIndex(), row, row);
         m_captureToolObjects.append(captureTool->copy(captureTool->parent()));
         m_imageCache.clear();
+        endInsertRows();
     }
 }
 
@@ -24,12 +38,29 @@ void CaptureToolObjects::insert(int index,
 {
     if (!captureTool.isNull() && index >= 0 &&
         index <= m_captureToolObjects.size()) {
+        beginInsertRows(QModelIndex(), index + 1, index + 1);
         m_captureToolObjects.insert(index,
                                     captureTool->copy(captureTool->parent()));
         m_imageCache.clear();
+        endInsertRows();
     }
 }
 
+void CaptureToolObjects::move(int from, int to)
+{
+    const int size = m_captureToolObjects.size();
+    if (from == to || from < 0 || from >= size || to < 0 || to >= size) {
+        return;
+    }
+    // The destination of beginMoveRows is the row the object is put before,
+    // counted before the move
+    const int destination = (to > from ? to + 1 : to) + 1;
+    beginMoveRows(QModelIndex(), from + 1, from + 1, QModelIndex(), destination);
+    m_captureToolObjects.move(from, to);
+    m_imageCache.clear();
+    endMoveRows();
+}
+
 QPointer<CaptureTool> CaptureToolObjects::at(int index)
 {
     if (index >= 0 && index < m_captureToolObjects.size()) {
@@ -40,15 +71,19 @@ QPointer<CaptureTool> CaptureToolObjects::at(int index)
 
 void CaptureToolObjects::clear()
 {
+    beginResetModel();
     m_captureToolObjects.clear();
+    m_imageCache.clear();
+    endResetModel();
 }
 
-QList<QPointer<CaptureTool>> CaptureToolObjects::captureToolObjects()
+const QList<QPointer<CaptureTool>>& CaptureToolObjects::captureToolObjects()
+  const
 {
     return m_captureToolObjects;
 }
 
-int CaptureToolObjects::size()
+int CaptureToolObjects::size() const
 {
     return m_captureToolObjects.size();
 }
@@ -56,11 +91,39 @@ int CaptureToolObjects::size()
 void CaptureToolObjects::removeAt(int index)
 {
     if (index >= 0 && index < m_captureToolObjects.size()) {
+        beginRemoveRows(QModelIndex(), index + 1, index + 1);
         m_captureToolObjects.removeAt(index);
         m_imageCache.clear();
+        endRemoveRows();
     }
 }
 
+int CaptureToolObjects::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_captureToolObjects.size() + 1;
+}
+
+QVariant CaptureToolObjects::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() > m_captureToolObjects.size()) {
+        return QVariant();
+    }
+    if (index.row() == 0) {
+        if (role == Qt::DisplayRole) {
+            return QCoreApplication::translate("UtilityPanel", "<Empty>");
+        }
+        return QVariant();
+    }
+    const QPointer<CaptureTool>& toolItem =
+      m_captureToolObjects.at(index.row() - 1);
+    if (role == Qt::DisplayRole) {
+        return toolItem->info();
+    } else if (role == Qt::DecorationRole) {
+        return toolItem->icon(QColor(Qt::white), false);
+    }
+    return QVariant();
+}
+
 int CaptureToolObjects::find(const QPoint& pos, const QSize& captureSize)
 {
     if (m_captureToolObjects.empty()) {
@@ -142,21 +205,59 @@ int CaptureToolObjects::findWithRadius(QPainter& painter,
 CaptureToolObjects& CaptureToolObjects::operator=(
   const CaptureToolObjects& other)
 {
-    // remove extra items for this if size is bigger
-    while (this->m_captureToolObjects.size() >
-           other.m_captureToolObjects.size()) {
-        this->m_captureToolObjects.removeLast();
+    const QList<QPointer<CaptureTool>>& items = other.m_captureToolObjects;
+    const int oldSize = m_captureToolObjects.size();
+    const int newSize = items.size();
+
+    // An undo or redo usually changes a single object, the rows before and
+    // after it are left alone
+    int prefix = 0;
+    while (prefix < qMin(oldSize, newSize) &&
+           sameRow(m_captureToolObjects.at(prefix), items.at(prefix))) {
+        ++prefix;
     }
+    int suffix = 0;
+    while (suffix < qMin(oldSize, newSize) - prefix &&
+           sameRow(m_captureToolObjects.at(oldSize - 1 - suffix),
+                   items.at(newSize - 1 - suffix))) {
+        ++suffix;
+    }
+    const int oldMiddle = oldSize - prefix - suffix;
+    const int newMiddle = newSize - prefix - suffix;
+    // Objects copied by the insertion
+    int insertedFirst = 0;
+    int insertedEnd = 0;
 
-    int count = 0;
-    for (const auto& item : other.m_captureToolObjects) {
-        QPointer<CaptureTool> itemCopy = item->copy(item->parent());
-        if (count < this->m_captureToolObjects.size()) {
-            this->m_captureToolObjects[count] = itemCopy;
-        } else {
-            this->m_captureToolObjects.append(itemCopy);
+    if (oldMiddle > newMiddle) {
+        const int first = prefix + newMiddle;
+        beginRemoveRows(QModelIndex(), first + 1, prefix + oldMiddle);
+        m_captureToolObjects.erase(m_captureToolObjects.begin() + first,
+                                   m_captureToolObjects.begin() + prefix +
+                                     oldMiddle);
+        endRemoveRows();
+    } else if (oldMiddle < newMiddle) {
+        insertedFirst = prefix + oldMiddle;
+        insertedEnd = prefix + newMiddle;
+        beginInsertRows(QModelIndex(), insertedFirst + 1, insertedEnd);
+        for (int i = insertedFirst; i < insertedEnd; ++i) {
+            const auto& item = items.at(i);
+            m_captureToolObjects.insert(i, item->copy(item->parent()));
         }
-        count++;
+        endInsertRows();
+    }
+
+    // The objects are copies, even where the rows are unchanged
+    for (int i = 0; i < newSize; ++i) {
+        if (i >= insertedFirst && i < insertedEnd) {
+            continue;
+        }
+        const auto& item = items.at(i);
+        m_captureToolObjects[i] = item->copy(item->parent());
+    }
+    m_imageCache.clear();
+    if (qMin(oldMiddle, newMiddle) > 0) {
+        emit dataChanged(index(prefix + 1),
+                         index(prefix + qMin(oldMiddle, newMiddle)));
     }
     return *this;
 }
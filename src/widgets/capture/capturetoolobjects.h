@@ -5,23 +5,36 @@
 #define FLAMESHOT_CAPTURETOOLOBJECTS_H
 
 #include "src/tools/capturetool.h"
+#include <QAbstractListModel>
 #include <QList>
 #include <QPointer>
 
-class CaptureToolObjects : public QObject
+// The objects drawn on a capture, from bottom to top. As a list model, it
+// notifies views of each insertion, removal and move, so the layers panel
+// only updates the rows that changed. Row 0 is an "<Empty>" entry standing
+// for no object, object i is at row i + 1.
+class CaptureToolObjects : public QAbstractListModel
 {
+    Q_OBJECT
 public:
     explicit CaptureToolObjects(QObject* parent = nullptr);
-    QList<QPointer<CaptureTool>> captureToolObjects();
+    const QList<QPointer<CaptureTool>>& captureToolObjects() const;
     void append(const QPointer<CaptureTool>& captureTool);
     void insert(int index, const QPointer<CaptureTool>& captureTool);
     void removeAt(int index);
+    void move(int from, int to);
     void clear();
-    int size();
+    int size() const;
     int find(const QPoint& pos, const QSize& captureSize);
     QPointer<CaptureTool> at(int index);
+    // Copies the objects of other, the rows that look the same at both ends
+    // of the lists are kept
     CaptureToolObjects& operator=(const CaptureToolObjects& other);
 
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index,
+                  int role = Qt::DisplayRole) const override;
+
 private:
     int findWithRadius(QPainter& painter,
                        QPixmap& pixmap,
@@ -14,16 +14,21 @@
 #include "copytool.h"
 #include "src/core/flameshot.h"
 #include "src/core/qguiappcurrentscreen.h"
+#include "src/tools/annotationproject.h"
 #include "src/tools/toolfactory.h"
 #include "src/utils/colorutils.h"
+#include "src/utils/filenamehandler.h"
 #include "src/utils/screengrabber.h"
 #include "src/utils/screenshotsaver.h"
 #include "src/utils/systemnotification.h"
+#include "src/utils/tracing.h"
 #include "src/widgets/capture/colorpicker.h"
 #include "src/widgets/capture/hovereventfilter.h"
 #include "src/widgets/capture/modificationcommand.h"
 #include "src/widgets/capture/notifierbox.h"
 #include "src/widgets/capture/overlaymessage.h"
+#include "src/widgets/capture/sessionrecorder.h"
+#include "src/widgets/capture/tiledrenderer.h"
 #include "src/widgets/orientablepushbutton.h"
 #include "src/widgets/panel/sidepanelwidget.h"
 #include "src/widgets/panel/utilitypanel.h"
@@ -32,12 +37,15 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QDesktopWidget>
+#include <QDir>
+#include <QFile>
 #include <QFontMetrics>
 #include <QLabel>
 #include <QPaintEvent>
 #include <QPainter>
 #include <QScreen>
 #include <QShortcut>
+#include <QStandardPaths>
 #include <draggablewidgetmaker.h>
 
 #define MOUSE_DISTANCE_TO_START_MOVING 3
@@ -72,6 +80,8 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
   , m_startMove(false)
   , m_toolSizeByKeyboard(0)
 {
+    TRACE_SPAN("CaptureWidget::CaptureWidget");
+    m_startupTimer.start();
     m_undoStack.setUndoLimit(ConfigHandler().undoLimit());
 
     m_context.circleCount = 1;
@@ -97,15 +107,29 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
     // Top left of the whole set of screens
     QPoint topLeft(0, 0);
 #endif
+    // Relative to the widget, unlike the initial selection of the request
+    QRect projectSelection;
     if (fullScreen) {
-        // Grab Screenshot
         bool ok = true;
-        m_context.screenshot = ScreenGrabber().grabEntireDesktop(ok);
+        if (!req.projectPath().isEmpty()) {
+            ok = openProject(req.projectPath(), projectSelection);
+        } else {
+            // Grab Screenshot
+            m_context.screenshot = ScreenGrabber().grabEntireDesktop(ok);
+            if (!ok) {
+                AbstractLogger::error() << tr("Unable to capture screen");
+            }
+        }
         if (!ok) {
-            AbstractLogger::error() << tr("Unable to capture screen");
             this->close();
         }
         m_context.origScreenshot = m_context.screenshot;
+        if (m_captureToolObjects.size() > 0) {
+            drawToolsData(false);
+        } else if (ok && m_config.smartSelection()) {
+            // Done in the background while the overlay is brought up
+            m_regionDetector.start(m_context.screenshot);
+        }
 
 #if defined(Q_OS_WIN)
         setWindowFlags(Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint |
@@ -180,6 +204,10 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
     m_buttonHandler->hide();
 
     initButtons();
+    if (!projectSelection.isNull()) {
+        m_context.request.setInitialSelection(
+          projectSelection.translated(mapToGlobal(QPoint(0, 0))));
+    }
     initSelection(); // button handler must be initialized before
     initShortcuts(); // must be called after initSelection
     // init magnify
@@ -242,6 +270,11 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
         OverlayMessage::push(m_helpMessage);
     }
 
+    const QString sessionPath = SessionRecorder::requestedPath();
+    if (!sessionPath.isEmpty()) {
+        new SessionRecorder(this, m_context.origScreenshot, sessionPath);
+    }
+
     updateCursor();
 }
 
@@ -483,7 +516,15 @@ void CaptureWidget::uncheckActiveTool()
 
 void CaptureWidget::paintEvent(QPaintEvent* paintEvent)
 {
+    TRACE_SPAN("CaptureWidget::paintEvent");
     Q_UNUSED(paintEvent)
+#if defined(FLAMESHOT_DEBUG_CAPTURE)
+    if (m_startupTimer.isValid()) {
+        qDebug() << "Capture overlay first frame after"
+                 << m_startupTimer.elapsed() << "ms";
+        m_startupTimer.invalidate();
+    }
+#endif
     QPainter painter(this);
     painter.drawPixmap(0, 0, m_context.screenshot);
 
@@ -501,6 +542,13 @@ void CaptureWidget::paintEvent(QPaintEvent* paintEvent)
     // draw inactive region
     drawInactiveRegion(&painter);
 
+    if (!m_hoveredRegion.isNull() && !m_selection->isVisible()) {
+        painter.setClipping(false);
+        painter.setBrush(Qt::NoBrush);
+        painter.setPen(m_uiColor);
+        painter.drawRect(m_hoveredRegion.adjusted(0, 0, -1, -1));
+    }
+
     if (!isActiveWindow()) {
         drawErrorMessage(
           tr("Flameshot has lost focus. Keyboard shortcuts won't "
@@ -589,8 +637,7 @@ int CaptureWidget::selectToolItemAtPos(const QPoint& pos)
     // Try to select existing tool, "-1" - no active tool
     int activeLayerIndex = -1;
     auto selectionMouseSide = m_selection->getMouseSide(pos);
-    if (m_activeButton.isNull() &&
-        m_captureToolObjects.captureToolObjects().size() > 0 &&
+    if (m_activeButton.isNull() && m_captureToolObjects.size() > 0 &&
         (selectionMouseSide == SelectionWidget::NO_SIDE ||
          selectionMouseSide == SelectionWidget::CENTER)) {
         auto toolItem = activeToolObject();
@@ -647,7 +694,6 @@ void CaptureWidget::mousePressEvent(QMouseEvent* e)
         commitCurrentTool();
         m_panel->setToolWidget(nullptr);
         drawToolsData();
-        updateLayersPanel();
     }
 
     selectToolItemAtPos(m_mousePressedPos);
@@ -669,7 +715,6 @@ void CaptureWidget::mouseDoubleClickEvent(QMouseEvent* event)
             m_captureToolObjectsBackup = m_captureToolObjects;
             m_activeTool->setEditMode(true);
             drawToolsData();
-            updateLayersPanel();
             handleToolSignal(CaptureTool::REQ_ADD_CHILD_WIDGET);
             m_panel->setToolWidget(m_activeTool->configurationWidget());
         }
@@ -692,7 +737,7 @@ void CaptureWidget::mouseMoveEvent(QMouseEvent* e)
     if (m_magnifier) {
         if (!m_activeButton) {
             m_magnifier->show();
-            m_magnifier->update();
+            m_magnifier->setCursorPosition(e->pos());
         } else {
             m_magnifier->hide();
         }
@@ -700,10 +745,12 @@ void CaptureWidget::mouseMoveEvent(QMouseEvent* e)
 
     m_context.mousePos = e->pos();
     if (e->buttons() != Qt::LeftButton) {
+        updateHoveredRegion(e->pos());
         updateTool(activeButtonTool());
         updateCursor();
         return;
     }
+    updateHoveredRegion(QPoint(-1, -1));
 
     // The rest assumes that left mouse button is clicked
     if (!m_activeButton && m_panel->activeLayerIndex() >= 0) {
@@ -763,6 +810,13 @@ void CaptureWidget::mouseMoveEvent(QMouseEvent* e)
 
 void CaptureWidget::mouseReleaseEvent(QMouseEvent* e)
 {
+    if (e->button() == Qt::LeftButton && !m_colorPicker->isVisible() &&
+        selectHoveredRegion()) {
+        // A click on a detected region selects it
+        m_mouseIsClicked = false;
+        return;
+    }
+
     if (e->button() == Qt::LeftButton && m_colorPicker->isVisible()) {
         // Color picker
         if (m_colorPicker->isVisible() && m_panel->activeLayerIndex() >= 0 &&
@@ -1026,8 +1080,8 @@ void CaptureWidget::initPanel()
     emit toolSizeChanged(m_context.toolSize);
     m_panel->pushWidget(m_sidePanel);
 
-    // Fill undo/redo/history list widget
-    m_panel->fillCaptureTools(m_captureToolObjects.captureToolObjects());
+    // The undo/redo/history list follows the changes of the objects
+    m_panel->setLayersModel(&m_captureToolObjects);
 }
 
 void CaptureWidget::showAppUpdateNotification(const QString& appLatestVersion,
@@ -1307,20 +1361,14 @@ void CaptureWidget::onMoveCaptureToolUp(int captureToolIndex)
 {
     m_captureToolObjectsBackup = m_captureToolObjects;
     pushObjectsStateToUndoStack();
-    auto tool = m_captureToolObjects.at(captureToolIndex);
-    m_captureToolObjects.removeAt(captureToolIndex);
-    m_captureToolObjects.insert(captureToolIndex - 1, tool);
-    updateLayersPanel();
+    m_captureToolObjects.move(captureToolIndex, captureToolIndex - 1);
 }
 
 void CaptureWidget::onMoveCaptureToolDown(int captureToolIndex)
 {
     m_captureToolObjectsBackup = m_captureToolObjects;
     pushObjectsStateToUndoStack();
-    auto tool = m_captureToolObjects.at(captureToolIndex);
-    m_captureToolObjects.removeAt(captureToolIndex);
-    m_captureToolObjects.insert(captureToolIndex + 1, tool);
-    updateLayersPanel();
+    m_captureToolObjects.move(captureToolIndex, captureToolIndex + 1);
 }
 
 void CaptureWidget::selectAll()
@@ -1332,6 +1380,39 @@ void CaptureWidget::selectAll()
     updateSelectionState();
 }
 
+/**
+ * @brief Save the screenshot and the tool objects as an editable project.
+ */
+void CaptureWidget::saveProject()
+{
+    QString savePath = m_config.savePath();
+    if (savePath.isEmpty() || !QDir(savePath).exists()) {
+        savePath =
+          QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
+    }
+    savePath = FileNameHandler().reserveScreenshotPath(
+      savePath, AnnotationProject::fileSuffix());
+
+    QRect selection;
+    if (m_selection->isVisible()) {
+        selection = m_selection->geometry().intersected(rect());
+    }
+    QString error;
+    if (AnnotationProject::save(savePath,
+                                m_context.origScreenshot,
+                                selection,
+                                m_captureToolObjects.captureToolObjects(),
+                                error)) {
+        AbstractLogger::info() << tr("Project saved as ") + savePath;
+    } else {
+        AbstractLogger::error()
+          << tr("Error trying to save the project as ") + savePath + ": " +
+               error;
+        // reserveScreenshotPath created it
+        QFile::remove(savePath);
+    }
+}
+
 void CaptureWidget::removeToolObject(int index)
 {
     --index;
@@ -1362,7 +1443,6 @@ void CaptureWidget::removeToolObject(int index)
         m_captureToolObjects.removeAt(index);
         pushObjectsStateToUndoStack();
         drawToolsData();
-        updateLayersPanel();
     }
 }
 
@@ -1418,6 +1498,10 @@ void CaptureWidget::initShortcuts()
                 this,
                 SLOT(selectAll()));
 
+    newShortcut(QKeySequence(ConfigHandler().shortcut("TYPE_SAVE_PROJECT")),
+                this,
+                SLOT(saveProject()));
+
     newShortcut(Qt::Key_Escape, this, SLOT(deleteToolWidgetOrClose()));
 }
 
@@ -1500,9 +1584,41 @@ void CaptureWidget::updateTool(CaptureTool* tool)
     oldToolObjectRect = toolObjectRect;
 }
 
-void CaptureWidget::updateLayersPanel()
+/**
+ * @brief Highlight the detected region under pos, if there is no selection yet.
+ */
+void CaptureWidget::updateHoveredRegion(const QPoint& pos)
 {
-    m_panel->fillCaptureTools(m_captureToolObjects.captureToolObjects());
+    QRect region;
+    if (!m_selection->isVisible() && !m_activeButton) {
+        region = m_regionDetector.regionAt(pos);
+    }
+    if (region != m_hoveredRegion) {
+        // The shading changes within both regions only
+        update(paddedUpdateRect(m_hoveredRegion));
+        update(paddedUpdateRect(region));
+        m_hoveredRegion = region;
+    }
+}
+
+/**
+ * @brief Snap the selection to the highlighted region.
+ * @return true if there was a highlighted region.
+ */
+bool CaptureWidget::selectHoveredRegion()
+{
+    if (m_hoveredRegion.isNull() || m_selection->isVisible() ||
+        m_activeButton) {
+        return false;
+    }
+    QRect region = m_hoveredRegion;
+    updateHoveredRegion(QPoint(-1, -1));
+    m_selection->show();
+    m_selection->setGeometry(region);
+    emit m_selection->geometrySettled();
+    updateSelectionState();
+    updateCursor();
+    return true;
 }
 
 void CaptureWidget::pushToolToStack()
@@ -1530,7 +1646,6 @@ void CaptureWidget::pushToolToStack()
         pushObjectsStateToUndoStack();
         releaseActiveTool();
         drawToolsData();
-        updateLayersPanel();
 
         // restore signal connection for updating layer
         m_panel->blockSignals(false);
@@ -1539,15 +1654,16 @@ void CaptureWidget::pushToolToStack()
 
 void CaptureWidget::drawToolsData(bool drawSelection)
 {
+    TRACE_SPAN("CaptureWidget::drawToolsData");
     // TODO refactor this for performance. The objects should not all be updated
     // at once every time
-    QPixmap pixmapItem = m_context.origScreenshot;
-    for (auto toolItem : m_captureToolObjects.captureToolObjects()) {
-        processPixmapWithTool(&pixmapItem, toolItem);
+    const auto& toolItems = m_captureToolObjects.captureToolObjects();
+    m_context.screenshot =
+      TiledRenderer::render(m_context.origScreenshot, toolItems);
+    for (auto toolItem : toolItems) {
         update(paddedUpdateRect(toolItem->boundingRect()));
     }
 
-    m_context.screenshot = pixmapItem;
     if (drawSelection) {
         drawObjectSelection();
     }
@@ -1619,6 +1735,24 @@ void CaptureWidget::restoreCircleCountState()
     m_context.circleCount = largest + 1;
 }
 
+bool CaptureWidget::openProject(const QString& path, QRect& selection)
+{
+    QList<CaptureTool*> objects;
+    QString error;
+    if (!AnnotationProject::open(
+          path, m_context.screenshot, selection, objects, error)) {
+        AbstractLogger::error()
+          << tr("Unable to open the project ") + path + ": " + error;
+        return false;
+    }
+    for (auto* object : objects) {
+        object->setParent(this);
+        m_captureToolObjects.append(object);
+    }
+    restoreCircleCountState();
+    return true;
+}
+
 /**
  * @brief Wrapper around `new QShortcut`, properly handling Enter/Return.
  */
@@ -1662,7 +1796,6 @@ void CaptureWidget::setCaptureToolObjects(
     // Used for undo/redo
     m_captureToolObjects = captureToolObjects;
     drawToolsData();
-    updateLayersPanel();
     drawObjectSelection();
 }
 
@@ -1680,7 +1813,6 @@ void CaptureWidget::undo()
     drawToolsData();
     m_undoStack.undo();
     drawToolsData();
-    updateLayersPanel();
 
     restoreCircleCountState();
 }
@@ -1693,7 +1825,6 @@ void CaptureWidget::redo()
     m_undoStack.redo();
     drawToolsData();
     update();
-    updateLayersPanel();
 
     restoreCircleCountState();
 }
@@ -1748,6 +1879,8 @@ void CaptureWidget::drawInactiveRegion(QPainter* painter)
     QRect r;
     if (m_selection->isVisible()) {
         r = m_selection->geometry().normalized();
+    } else {
+        r = m_hoveredRegion;
     }
     QRegion grey(rect());
     grey = grey.subtracted(r);
@@ -18,7 +18,9 @@
 #include "src/tools/capturetool.h"
 #include "src/utils/confighandler.h"
 #include "src/widgets/capture/magnifierwidget.h"
+#include "src/widgets/capture/regiondetector.h"
 #include "src/widgets/capture/selectionwidget.h"
+#include <QElapsedTimer>
 #include <QPointer>
 #include <QUndoStack>
 #include <QWidget>
@@ -80,6 +82,7 @@ private slots:
     void onMoveCaptureToolUp(int captureToolIndex);
     void onMoveCaptureToolDown(int captureToolIndex);
     void selectAll();
+    void saveProject();
 
 public:
     void removeToolObject(int index = -1);
@@ -115,10 +118,12 @@ private:
     void updateCursor();
     void updateSelectionState();
     void updateTool(CaptureTool* tool);
-    void updateLayersPanel();
+    void updateHoveredRegion(const QPoint& pos);
+    bool selectHoveredRegion();
     void pushToolToStack();
     void makeChild(QWidget* w);
     void restoreCircleCountState();
+    bool openProject(const QString& path, QRect& selection);
 
     QList<QShortcut*> newShortcut(const QKeySequence& key,
                                   QWidget* parent,
@@ -195,9 +200,17 @@ private:
 
     QUndoStack m_undoStack;
 
+    // Smart selection, the detected region under the mouse is highlighted
+    // until a selection is made
+    RegionDetector m_regionDetector;
+    QRect m_hoveredRegion;
+
     bool m_existingObjectIsChanged;
 
     // For start moving after more than X offset
     QPoint m_startMovePos;
     bool m_startMove;
+
+    // Time to first frame, reported in FLAMESHOT_DEBUG_CAPTURE builds
+    QElapsedTimer m_startupTimer;
 };
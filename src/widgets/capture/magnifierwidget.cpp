@@ -9,47 +9,100 @@
 #include <QPainterPath>
 #include <QPen>
 #include <QPixmap>
+#include <cstring>
 
 MagnifierWidget::MagnifierWidget(const QPixmap& p,
                                  const QColor& c,
                                  bool isSquare,
                                  QWidget* parent)
   : QWidget(parent)
+  , m_square(isSquare)
   , m_color(c)
   , m_borderColor(c)
-  , m_screenshot(p)
-  , m_square(isSquare)
+  , m_screenshot(p.toImage())
+  , m_devicePixelRatio(p.devicePixelRatio())
+  , m_sampled(false)
 {
     setFixedSize(parent->width(), parent->height());
     setAttribute(Qt::WA_TransparentForMouseEvents);
     m_color.setAlpha(130);
-    // add padding for circular magnifier
-    QImage padded(p.width() + 2 * m_magPixels,
-                  p.height() + 2 * m_magPixels,
-                  QImage::Format_ARGB32);
-    padded.fill(Qt::black);
-    QPainter painter(&padded);
-    painter.drawPixmap(m_magPixels, m_magPixels, p);
-    m_paddedScreenshot.convertFromImage(padded);
+    // The sampling copies whole 32 bit pixels
+    if (m_screenshot.depth() != 32) {
+        m_screenshot =
+          m_screenshot.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    m_buffer = QImage(
+      m_pixels * magZoom, m_pixels * magZoom, m_screenshot.format());
 }
-void MagnifierWidget::paintEvent(QPaintEvent*)
+
+void MagnifierWidget::setCursorPosition(const QPoint& pos)
 {
-    QPainter p(this);
+    if (m_screenshot.isNull()) {
+        return;
+    }
+    const QPoint source(static_cast<int>(pos.x() * m_devicePixelRatio),
+                        static_cast<int>(pos.y() * m_devicePixelRatio));
+    QPoint samplePos = source - QPoint(m_magPixels, m_magPixels);
+    QPoint sampleOffset;
     if (m_square) {
-        drawMagnifier(p);
-    } else {
-        drawMagnifierCircle(p);
+        // Keep the sampled area inside the screenshot and move the crosshair
+        // instead
+        const QPoint clamped(
+          qBound(0, samplePos.x(), m_screenshot.width() - m_pixels),
+          qBound(0, samplePos.y(), m_screenshot.height() - m_pixels));
+        sampleOffset = samplePos - clamped;
+        samplePos = clamped;
+    }
+
+    // Redraw only when the cursor moves to another screenshot pixel
+    if (m_sampled && samplePos == m_samplePos &&
+        sampleOffset == m_sampleOffset) {
+        return;
     }
+    const QRect oldRect = m_sampled ? magnifierRect() : QRect();
+    m_cursorPos = pos;
+    m_samplePos = samplePos;
+    m_sampleOffset = sampleOffset;
+    sample();
+    m_sampled = true;
+    update(oldRect | magnifierRect());
 }
 
-void MagnifierWidget::drawMagnifierCircle(QPainter& painter)
+// Nearest neighbor upscale of the sampled area into the back buffer. Pixels
+// outside of the screenshot repeat its edges.
+void MagnifierWidget::sample()
 {
-    int x = QCursor::pos().x() + m_magPixels;
-    int y = QCursor::pos().y() + m_magPixels;
-    int magX = static_cast<int>(x * m_devicePixelRatio - m_magPixels);
-    int magY = static_cast<int>(y * m_devicePixelRatio - m_magPixels);
-    QRectF magniRect(magX, magY, m_pixels, m_pixels);
+    const int maxX = m_screenshot.width() - 1;
+    const int maxY = m_screenshot.height() - 1;
+    const int rowBytes = m_buffer.width() * 4;
+    for (int row = 0; row < m_pixels; ++row) {
+        const int y = qBound(0, m_samplePos.y() + row, maxY);
+        const auto* src =
+          reinterpret_cast<const quint32*>(m_screenshot.constScanLine(y));
+        uchar* firstLine = m_buffer.scanLine(row * magZoom);
+        auto* dst = reinterpret_cast<quint32*>(firstLine);
+        for (int column = 0; column < m_pixels; ++column) {
+            const quint32 pixel =
+              src[qBound(0, m_samplePos.x() + column, maxX)];
+            for (int i = 0; i < magZoom; ++i) {
+                *dst++ = pixel;
+            }
+        }
+        for (int i = 1; i < magZoom; ++i) {
+            std::memcpy(
+              m_buffer.scanLine(row * magZoom + i), firstLine, rowBytes);
+        }
+    }
+}
 
+QPointF MagnifierWidget::drawPosition() const
+{
+    int x = m_cursorPos.x();
+    int y = m_cursorPos.y();
+    if (!m_square) {
+        x += m_magPixels;
+        y += m_magPixels;
+    }
     qreal drawPosX = x + m_magOffset + m_pixels * magZoom / 2;
     if (drawPosX > width() - m_pixels * magZoom / 2) {
         drawPosX = x - m_magOffset - m_pixels * magZoom / 2;
@@ -58,7 +111,35 @@ void MagnifierWidget::drawMagnifierCircle(QPainter& painter)
     if (drawPosY > height() - m_pixels * magZoom / 2) {
         drawPosY = y - m_magOffset - m_pixels * magZoom / 2;
     }
-    QPointF drawPos(drawPosX, drawPosY);
+    return { drawPosX, drawPosY };
+}
+
+QRect MagnifierWidget::magnifierRect() const
+{
+    const qreal side = m_pixels * magZoom;
+    const QPointF drawPos = drawPosition();
+    // Room for the border and the antialiasing of the circle outline
+    return QRectF(drawPos.x() - side / 2, drawPos.y() - side / 2, side, side)
+             .toAlignedRect()
+             .adjusted(-4, -4, 4, 4);
+}
+
+void MagnifierWidget::paintEvent(QPaintEvent*)
+{
+    if (!m_sampled) {
+        return;
+    }
+    QPainter p(this);
+    if (m_square) {
+        drawMagnifier(p);
+    } else {
+        drawMagnifierCircle(p);
+    }
+}
+
+void MagnifierWidget::drawMagnifierCircle(QPainter& painter)
+{
+    const QPointF drawPos = drawPosition();
     QRectF crossHairTop(drawPos.x() + magZoom * (-0.5),
                         drawPos.y() - magZoom * (m_magPixels + 0.5),
                         magZoom,
@@ -75,20 +156,15 @@ void MagnifierWidget::drawMagnifierCircle(QPainter& painter)
                          drawPos.y() + magZoom * (-0.5),
                          magZoom * (m_magPixels),
                          magZoom);
-    QRectF crossHairBorder(drawPos.x() - magZoom * (m_magPixels + 0.5) - 1,
-                           drawPos.y() - magZoom * (m_magPixels + 0.5) - 1,
-                           m_pixels * magZoom + 2,
-                           m_pixels * magZoom + 2);
-    const auto frag =
-      QPainter::PixmapFragment::create(drawPos, magniRect, magZoom, magZoom);
 
     painter.setRenderHint(QPainter::Antialiasing, true);
     QPainterPath path = QPainterPath();
     path.addEllipse(drawPos, m_pixels * magZoom / 2, m_pixels * magZoom / 2);
     painter.setClipPath(path);
 
-    painter.drawPixmapFragments(
-      &frag, 1, m_paddedScreenshot, QPainter::OpaqueHint);
+    painter.drawImage(drawPos - QPointF(m_buffer.width() / 2.0,
+                                        m_buffer.height() / 2.0),
+                      m_buffer);
     painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
     for (const auto& rect :
          { crossHairTop, crossHairRight, crossHairBottom, crossHairLeft }) {
@@ -103,43 +179,9 @@ void MagnifierWidget::drawMagnifierCircle(QPainter& painter)
 // https://invent.kde.org/graphics/spectacle/-/blob/master/src/QuickEditor/QuickEditor.cpp#L841
 void MagnifierWidget::drawMagnifier(QPainter& painter)
 {
-    int x = QCursor::pos().x();
-    int y = QCursor::pos().y();
-    int magX = static_cast<int>(x * m_devicePixelRatio - m_magPixels);
-    int offsetX = 0;
-    if (magX < 0) {
-        offsetX = magX;
-        magX = 0;
-    } else {
-        const int maxX = m_screenshot.width() - m_pixels;
-        if (magX > maxX) {
-            offsetX = magX - maxX;
-            magX = maxX;
-        }
-    }
-    int magY = static_cast<int>(y * m_devicePixelRatio - m_magPixels);
-    int offsetY = 0;
-    if (magY < 0) {
-        offsetY = magY;
-        magY = 0;
-    } else {
-        const int maxY = m_screenshot.height() - m_pixels;
-        if (magY > maxY) {
-            offsetY = magY - maxY;
-            magY = maxY;
-        }
-    }
-    QRectF magniRect(magX, magY, m_pixels, m_pixels);
-
-    qreal drawPosX = x + m_magOffset + m_pixels * magZoom / 2;
-    if (drawPosX > width() - m_pixels * magZoom / 2) {
-        drawPosX = x - m_magOffset - m_pixels * magZoom / 2;
-    }
-    qreal drawPosY = y + m_magOffset + m_pixels * magZoom / 2;
-    if (drawPosY > height() - m_pixels * magZoom / 2) {
-        drawPosY = y - m_magOffset - m_pixels * magZoom / 2;
-    }
-    QPointF drawPos(drawPosX, drawPosY);
+    const int offsetX = m_sampleOffset.x();
+    const int offsetY = m_sampleOffset.y();
+    const QPointF drawPos = drawPosition();
     QRectF crossHairTop(drawPos.x() + magZoom * (offsetX - 0.5),
                         drawPos.y() - magZoom * (m_magPixels + 0.5),
                         magZoom,
@@ -160,14 +202,14 @@ void MagnifierWidget::drawMagnifier(QPainter& painter)
                            drawPos.y() - magZoom * (m_magPixels + 0.5) - 1,
                            m_pixels * magZoom + 2,
                            m_pixels * magZoom + 2);
-    const auto frag =
-      QPainter::PixmapFragment::create(drawPos, magniRect, magZoom, magZoom);
 
     painter.fillRect(crossHairBorder, m_borderColor);
-    painter.drawPixmapFragments(&frag, 1, m_screenshot, QPainter::OpaqueHint);
+    painter.drawImage(drawPos - QPointF(m_buffer.width() / 2.0,
+                                        m_buffer.height() / 2.0),
+                      m_buffer);
     painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
     for (const auto& rect :
          { crossHairTop, crossHairRight, crossHairBottom, crossHairLeft }) {
         painter.fillRect(rect, m_color);
     }
-}
\ No newline at end of file
+}
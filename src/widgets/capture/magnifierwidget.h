@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QImage>
 #include <QWidget>
 
 class QPropertyAnimation;
@@ -13,6 +14,9 @@ public:
                              bool isSquare,
                              QWidget* parent = nullptr);
 
+    // Position of the cursor in the coordinates of the parent widget
+    void setCursorPosition(const QPoint& pos);
+
 protected:
     void paintEvent(QPaintEvent*) override;
 
@@ -21,12 +25,24 @@ private:
     const int m_magOffset = 16;
     const int magZoom = 10;
     const int m_pixels = 2 * m_magPixels + 1;
-    const int m_devicePixelRatio = 1;
     bool m_square;
     QColor m_color;
     QColor m_borderColor;
-    QPixmap m_screenshot;
-    QPixmap m_paddedScreenshot;
+    // Shares the pixels of the capture screenshot
+    QImage m_screenshot;
+    qreal m_devicePixelRatio;
+    // Magnified pixels, rendered only when the sampled area changes
+    QImage m_buffer;
+    QPoint m_cursorPos;
+    // Top left of the sampled area in the screenshot, and offset of the
+    // cursor pixel from its center when it is shifted by the screen edges
+    QPoint m_samplePos;
+    QPoint m_sampleOffset;
+    bool m_sampled;
+
+    void sample();
+    QPointF drawPosition() const;
+    QRect magnifierRect() const;
     void drawMagnifier(QPainter& painter);
     void drawMagnifierCircle(QPainter& painter);
 };
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "regiondetector.h"
+#include <QHash>
+#include <QImage>
+#include <QtMath>
+#include <QtConcurrent>
+#include <cstdlib>
+
+// Minimum gradient magnitude, |gx| + |gy|, of an edge pixel
+#define EDGE_THRESHOLD 40
+// Smallest detected region, in logical pixels
+#define MIN_REGION_SIZE 12
+// Fraction of each side of a region that must lie on an edge
+#define MIN_SIDE_COVERAGE 0.7
+// Size of the index cells, in logical pixels
+#define INDEX_CELL_SIZE 64
+
+namespace {
+
+struct Run
+{
+    int y;
+    int x0;
+    int x1;
+};
+
+// One byte per pixel, non-zero on edges. The loops only use integer
+// arithmetic on contiguous rows so that the compiler vectorizes them.
+QVector<uchar> edgeMask(const QImage& gray)
+{
+    const int w = gray.width(), h = gray.height();
+    QVector<uchar> mask(w * h, 0);
+    QVector<int> gx(w), gy(w);
+    for (int y = 1; y < h - 1; ++y) {
+        const uchar* p0 = gray.constScanLine(y - 1);
+        const uchar* p1 = gray.constScanLine(y);
+        const uchar* p2 = gray.constScanLine(y + 1);
+        int* dx = gx.data();
+        int* dy = gy.data();
+        for (int x = 1; x < w - 1; ++x) {
+            dx[x] = (p0[x + 1] + 2 * p1[x + 1] + p2[x + 1]) -
+                    (p0[x - 1] + 2 * p1[x - 1] + p2[x - 1]);
+            dy[x] = (p2[x - 1] + 2 * p2[x] + p2[x + 1]) -
+                    (p0[x - 1] + 2 * p0[x] + p0[x + 1]);
+        }
+        uchar* out = mask.data() + y * w;
+        for (int x = 1; x < w - 1; ++x) {
+            out[x] = (std::abs(dx[x]) + std::abs(dy[x])) > EDGE_THRESHOLD;
+        }
+    }
+    return mask;
+}
+
+int findRoot(QVector<int>& parents, int i)
+{
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+// Bounding boxes of the 8-connected edge components, labelled run by run so
+// that no per-pixel label buffer is needed
+QVector<QRect> componentBounds(const QVector<uchar>& mask, int w, int h)
+{
+    QVector<Run> runs;
+    QVector<int> parents;
+    int prevBegin = 0, prevEnd = 0;
+    for (int y = 0; y < h; ++y) {
+        const uchar* row = mask.constData() + y * w;
+        const int rowBegin = runs.size();
+        int prev = prevBegin;
+        for (int x = 0; x < w;) {
+            if (!row[x]) {
+                ++x;
+                continue;
+            }
+            Run run{ y, x, x };
+            while (run.x1 + 1 < w && row[run.x1 + 1]) {
+                ++run.x1;
+            }
+            x = run.x1 + 1;
+
+            const int index = runs.size();
+            runs << run;
+            parents << index;
+            // Runs of the previous row touching this one, diagonals included
+            while (prev < prevEnd && runs[prev].x1 < run.x0 - 1) {
+                ++prev;
+            }
+            for (int p = prev; p < prevEnd && runs[p].x0 <= run.x1 + 1; ++p) {
+                int a = findRoot(parents, p), b = findRoot(parents, index);
+                if (a != b) {
+                    parents[qMax(a, b)] = qMin(a, b);
+                }
+            }
+        }
+        prevBegin = rowBegin;
+        prevEnd = runs.size();
+    }
+
+    QHash<int, QRect> bounds;
+    for (int i = 0; i < runs.size(); ++i) {
+        const Run& run = runs[i];
+        QRect& r = bounds[findRoot(parents, i)];
+        r |= QRect(run.x0, run.y, run.x1 - run.x0 + 1, 1);
+    }
+    return bounds.values().toVector();
+}
+
+double coverage(const QVector<uchar>& mask, int w, const QRect& r, bool row)
+{
+    // A border line is marked on both of its sides, so a side is looked up on
+    // its two outermost lines
+    const int length = row ? r.width() : r.height();
+    int covered = 0;
+    for (int i = 0; i < length; ++i) {
+        int x = row ? r.left() + i : r.left();
+        int y = row ? r.top() : r.top() + i;
+        int next = row ? w : 1;
+        const uchar* p = mask.constData() + y * w + x;
+        covered += (p[0] || p[next]) ? 1 : 0;
+    }
+    return double(covered) / length;
+}
+
+bool isOutlined(const QVector<uchar>& mask, int w, const QRect& r)
+{
+    const QRect top(r.left(), r.top(), r.width(), 1);
+    const QRect bottom(r.left(), r.bottom() - 1, r.width(), 1);
+    const QRect left(r.left(), r.top(), 1, r.height());
+    const QRect right(r.right() - 1, r.top(), 1, r.height());
+    return coverage(mask, w, top, true) >= MIN_SIDE_COVERAGE &&
+           coverage(mask, w, bottom, true) >= MIN_SIDE_COVERAGE &&
+           coverage(mask, w, left, false) >= MIN_SIDE_COVERAGE &&
+           coverage(mask, w, right, false) >= MIN_SIDE_COVERAGE;
+}
+
+RegionDetector::Index detect(const QImage& screenshot, qreal dpr)
+{
+    const QImage gray = screenshot.convertToFormat(QImage::Format_Grayscale8);
+    const int w = gray.width(), h = gray.height();
+    RegionDetector::Index index;
+    if (w < 3 || h < 3) {
+        return index;
+    }
+
+    const QVector<uchar> mask = edgeMask(gray);
+    const int minSize = qCeil(MIN_REGION_SIZE * dpr);
+    const QRect imageRect = gray.rect();
+    for (const QRect& bounds : componentBounds(mask, w, h)) {
+        if (bounds.width() < minSize || bounds.height() < minSize ||
+            bounds == imageRect.adjusted(1, 1, -1, -1) ||
+            !isOutlined(mask, w, bounds)) {
+            continue;
+        }
+        // The edges are detected on the pixels surrounding the border line
+        QRect device = bounds.adjusted(1, 1, -1, -1);
+        QRect logical(qRound(device.x() / dpr),
+                      qRound(device.y() / dpr),
+                      qRound(device.width() / dpr),
+                      qRound(device.height() / dpr));
+        if (!index.regions.contains(logical)) {
+            index.regions << logical;
+        }
+    }
+
+    index.cellSize = INDEX_CELL_SIZE;
+    index.columns = qCeil(w / dpr / index.cellSize) + 1;
+    const int rows = qCeil(h / dpr / index.cellSize) + 1;
+    index.cells.resize(index.columns * rows);
+    for (int i = 0; i < index.regions.size(); ++i) {
+        const QRect& r = index.regions[i];
+        const int left = qMax(0, r.left() / index.cellSize);
+        const int right = qMin(index.columns - 1, r.right() / index.cellSize);
+        const int top = qMax(0, r.top() / index.cellSize);
+        const int bottom = qMin(rows - 1, r.bottom() / index.cellSize);
+        for (int y = top; y <= bottom; ++y) {
+            for (int x = left; x <= right; ++x) {
+                index.cells[y * index.columns + x] << i;
+            }
+        }
+    }
+    return index;
+}
+
+} // unnamed namespace
+
+void RegionDetector::start(const QPixmap& screenshot)
+{
+    // QPixmap can only be used in the GUI thread
+    const QImage image = screenshot.toImage();
+    const qreal dpr = screenshot.devicePixelRatio();
+    m_index = QtConcurrent::run([image, dpr]() { return detect(image, dpr); });
+}
+
+bool RegionDetector::isReady() const
+{
+    // A default constructed future is finished too, but canceled
+    return m_index.isFinished() && m_index.resultCount() > 0;
+}
+
+QRect RegionDetector::regionAt(const QPoint& pos) const
+{
+    if (!isReady() || pos.x() < 0 || pos.y() < 0) {
+        return {};
+    }
+    // Cheap, the containers of the index are implicitly shared
+    const Index index = m_index.result();
+    const int cell = pos.y() / index.cellSize * index.columns +
+                     pos.x() / index.cellSize;
+    if (pos.x() / index.cellSize >= index.columns ||
+        cell >= index.cells.size()) {
+        return {};
+    }
+
+    QRect best;
+    for (int i : index.cells[cell]) {
+        const QRect& r = index.regions[i];
+        if (r.contains(pos) &&
+            (best.isNull() || r.width() * r.height() <
+                                best.width() * best.height())) {
+            best = r;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QFuture>
+#include <QPixmap>
+#include <QRect>
+#include <QVector>
+
+// Detects the rectangular UI elements (windows, panels, buttons...) of a
+// screenshot, so that the selection can snap to them.
+//
+// The analysis runs on the global thread pool: a Sobel pass marks the edges,
+// the connected edge components whose bounding box is mostly outlined by edges
+// are kept as candidates, and the candidates are bucketed in a grid for point
+// queries. Queries never wait for the analysis, they find nothing until it is
+// done.
+class RegionDetector
+{
+public:
+    // The regions are returned in the logical coordinates of the screenshot
+    void start(const QPixmap& screenshot);
+    bool isReady() const;
+    // Smallest detected region containing pos, or a null rect
+    QRect regionAt(const QPoint& pos) const;
+
+    struct Index
+    {
+        QVector<QRect> regions;
+        // Region indexes overlapping each cell, row major
+        QVector<QVector<int>> cells;
+        int columns = 0;
+        int cellSize = 1;
+    };
+
+private:
+    QFuture<Index> m_index;
+};
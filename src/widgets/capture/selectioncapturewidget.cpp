@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "selectioncapturewidget.h"
+#include "abstractlogger.h"
+#include "src/core/flameshot.h"
+#include "src/core/qguiappcurrentscreen.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/screengrabber.h"
+#include "src/widgets/capture/selectionwidget.h"
+#include <QApplication>
+#include <QKeyEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QScreen>
+#include <QShortcut>
+
+SelectionCaptureWidget::SelectionCaptureWidget(const CaptureRequest& req,
+                                               QWidget* parent)
+  : QWidget(parent)
+  , m_request(req)
+  , m_selection(nullptr)
+  , m_captureDone(false)
+{
+    ConfigHandler config;
+    m_opacity = config.contrastOpacity();
+
+    setAttribute(Qt::WA_DeleteOnClose);
+    setAttribute(Qt::WA_QuitOnClose, false);
+    // Repaints only ever cover the screenshot, there is no background to clear
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMouseTracking(true);
+    m_widgetOffset = mapToGlobal(QPoint(0, 0));
+
+    bool ok = true;
+    m_screenshot = ScreenGrabber().grabEntireDesktop(ok);
+    if (!ok) {
+        AbstractLogger::error() << tr("Unable to capture screen");
+        this->close();
+    }
+
+    // Same window setup as the fullscreen CaptureWidget
+#if defined(Q_OS_WIN)
+    setWindowFlags(Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint |
+                   Qt::SubWindow // Hides the taskbar icon
+    );
+    QPoint topLeft(0, 0);
+    for (QScreen* const screen : QGuiApplication::screens()) {
+        QPoint topLeftScreen = screen->geometry().topLeft();
+        if (topLeftScreen.x() < topLeft.x()) {
+            topLeft.setX(topLeftScreen.x());
+        }
+        if (topLeftScreen.y() < topLeft.y()) {
+            topLeft.setY(topLeftScreen.y());
+        }
+    }
+    move(topLeft);
+    resize(m_screenshot.size());
+#elif defined(Q_OS_MACOS)
+    QScreen* currentScreen = QGuiAppCurrentScreen().currentScreen();
+    move(currentScreen->geometry().x(), currentScreen->geometry().y());
+    resize(currentScreen->size());
+#else
+#if !defined(FLAMESHOT_DEBUG_CAPTURE)
+    setWindowFlags(Qt::BypassWindowManagerHint | Qt::WindowStaysOnTopHint |
+                   Qt::FramelessWindowHint | Qt::Tool);
+    resize(m_screenshot.size());
+#endif
+#endif
+
+    initSelection();
+    initShortcuts();
+    setCursor(Qt::CrossCursor);
+}
+
+SelectionCaptureWidget::~SelectionCaptureWidget()
+{
+    if (m_captureDone) {
+        QRect selection =
+          extendedRect(m_selection->geometry().intersected(rect()));
+        QPixmap pixmap =
+          selection.isNull() ? m_screenshot : m_screenshot.copy(selection);
+        QRect geometry(selection);
+        geometry.setTopLeft(geometry.topLeft() + m_widgetOffset);
+        Flameshot::instance()->exportCapture(pixmap, geometry, m_request);
+    } else {
+        emit Flameshot::instance()->captureFailed();
+    }
+}
+
+bool SelectionCaptureWidget::canHandle(const CaptureRequest& req)
+{
+    // Projects bring their tool objects, which only CaptureWidget can show
+    return req.projectPath().isEmpty() &&
+           ((req.tasks() & CaptureRequest::ACCEPT_ON_SELECT) ||
+            req.tasks() == CaptureRequest::PRINT_GEOMETRY);
+}
+
+void SelectionCaptureWidget::accept()
+{
+    if (!m_selection->isVisible() || m_captureDone) {
+        return;
+    }
+    m_request.removeTask(CaptureRequest::ACCEPT_ON_SELECT);
+    m_captureDone = true;
+    close();
+}
+
+void SelectionCaptureWidget::updateShading()
+{
+    // Only the shading between the previous and the new selection changes,
+    // the selection frame repaints itself
+    QRect selection;
+    if (m_selection->isVisible()) {
+        selection = m_selection->geometry().normalized();
+    }
+    update(QRegion(selection).xored(m_shadedSelection));
+    m_shadedSelection = selection;
+}
+
+void SelectionCaptureWidget::paintEvent(QPaintEvent* paintEvent)
+{
+    QPainter painter(this);
+    painter.setClipRegion(paintEvent->region());
+    painter.drawPixmap(0, 0, m_screenshot);
+
+    // draw inactive region
+    painter.setClipRegion(paintEvent->region().subtracted(m_shadedSelection));
+    painter.fillRect(rect(), QColor(0, 0, 0, m_opacity));
+}
+
+void SelectionCaptureWidget::keyPressEvent(QKeyEvent* e)
+{
+    if (e->key() == Qt::Key_Enter) {
+        // Make no difference for Return and Enter keys
+        QCoreApplication::postEvent(
+          this,
+          new QKeyEvent(QEvent::KeyPress, Qt::Key_Return, Qt::NoModifier));
+    } else {
+        QWidget::keyPressEvent(e);
+    }
+}
+
+void SelectionCaptureWidget::resizeEvent(QResizeEvent* e)
+{
+    QWidget::resizeEvent(e);
+    m_widgetOffset = mapToGlobal(QPoint(0, 0));
+}
+
+void SelectionCaptureWidget::moveEvent(QMoveEvent* e)
+{
+    QWidget::moveEvent(e);
+    m_widgetOffset = mapToGlobal(QPoint(0, 0));
+}
+
+void SelectionCaptureWidget::initSelection()
+{
+    m_selection = new SelectionWidget(ConfigHandler().uiColor(), this);
+    m_selection->setIdleCentralCursor(Qt::OpenHandCursor);
+    connect(m_selection,
+            &SelectionWidget::geometryChanged,
+            this,
+            &SelectionCaptureWidget::updateShading);
+    connect(m_selection,
+            &SelectionWidget::visibilityChanged,
+            this,
+            &SelectionCaptureWidget::updateShading);
+    connect(m_selection, &SelectionWidget::geometrySettled, this, [this]() {
+        if (m_selection->isVisibleTo(this) &&
+            (m_request.tasks() & CaptureRequest::ACCEPT_ON_SELECT)) {
+            accept();
+        }
+    });
+
+    QRect initialSelection = m_request.initialSelection();
+    if (!initialSelection.isNull()) {
+        initialSelection.moveTopLeft(initialSelection.topLeft() -
+                                     mapToGlobal({}));
+    }
+    m_selection->setGeometry(initialSelection);
+    m_selection->setVisible(!initialSelection.isNull());
+    if (!initialSelection.isNull()) {
+        emit m_selection->geometrySettled();
+    }
+}
+
+void SelectionCaptureWidget::initShortcuts()
+{
+    ConfigHandler config;
+    newShortcut(
+      QKeySequence(config.shortcut("TYPE_ACCEPT")), this, SLOT(accept()));
+
+    newShortcut(QKeySequence(config.shortcut("TYPE_RESIZE_LEFT")),
+                m_selection,
+                SLOT(resizeLeft()));
+    newShortcut(QKeySequence(config.shortcut("TYPE_RESIZE_RIGHT")),
+                m_selection,
+                SLOT(resizeRight()));
+    newShortcut(QKeySequence(config.shortcut("TYPE_RESIZE_UP")),
+                m_selection,
+                SLOT(resizeUp()));
+    newShortcut(QKeySequence(config.shortcut("TYPE_RESIZE_DOWN")),
+                m_selection,
+                SLOT(resizeDown()));
+
+    newShortcut(QKeySequence(config.shortcut("TYPE_MOVE_LEFT")),
+                m_selection,
+                SLOT(moveLeft()));
+    newShortcut(QKeySequence(config.shortcut("TYPE_MOVE_RIGHT")),
+                m_selection,
+                SLOT(moveRight()));
+    newShortcut(QKeySequence(config.shortcut("TYPE_MOVE_UP")),
+                m_selection,
+                SLOT(moveUp()));
+    newShortcut(QKeySequence(config.shortcut("TYPE_MOVE_DOWN")),
+                m_selection,
+                SLOT(moveDown()));
+
+    newShortcut(Qt::Key_Escape, this, SLOT(close()));
+}
+
+/**
+ * @brief Wrapper around `new QShortcut`, properly handling Enter/Return.
+ */
+void SelectionCaptureWidget::newShortcut(const QKeySequence& key,
+                                         QWidget* parent,
+                                         const char* slot)
+{
+    QString strKey = key.toString();
+    if (strKey.contains("Enter") || strKey.contains("Return")) {
+        strKey.replace("Enter", "Return");
+        new QShortcut(strKey, parent, slot);
+        strKey.replace("Return", "Enter");
+        new QShortcut(strKey, parent, slot);
+    } else {
+        new QShortcut(key, parent, slot);
+    }
+}
+
+QRect SelectionCaptureWidget::extendedRect(const QRect& r) const
+{
+    auto devicePixelRatio = m_screenshot.devicePixelRatio();
+    return { static_cast<int>(r.left() * devicePixelRatio),
+             static_cast<int>(r.top() * devicePixelRatio),
+             static_cast<int>(r.width() * devicePixelRatio),
+             static_cast<int>(r.height() * devicePixelRatio) };
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/core/capturerequest.h"
+#include <QPixmap>
+#include <QWidget>
+
+class SelectionWidget;
+
+// Capture overlay for requests that only need a region: ACCEPT_ON_SELECT and
+// PRINT_GEOMETRY. It shows the screenshot, the selection and the shading of
+// the inactive region, without the tool buttons, panels, magnifier or undo
+// history of CaptureWidget, so it is much cheaper to bring up.
+class SelectionCaptureWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SelectionCaptureWidget(const CaptureRequest& req,
+                                    QWidget* parent = nullptr);
+    ~SelectionCaptureWidget();
+
+    // Requests that SelectionCaptureWidget can fulfill
+    static bool canHandle(const CaptureRequest& req);
+
+private slots:
+    void accept();
+    void updateShading();
+
+protected:
+    void paintEvent(QPaintEvent* paintEvent) override;
+    void keyPressEvent(QKeyEvent* keyEvent) override;
+    void resizeEvent(QResizeEvent* resizeEvent) override;
+    void moveEvent(QMoveEvent* moveEvent) override;
+
+private:
+    void initSelection();
+    void initShortcuts();
+    void newShortcut(const QKeySequence& key,
+                     QWidget* parent,
+                     const char* slot);
+    QRect extendedRect(const QRect& r) const;
+
+    CaptureRequest m_request;
+    QPixmap m_screenshot;
+    QPoint m_widgetOffset;
+    SelectionWidget* m_selection;
+    // Selection excluded from the inactive region shading
+    QRect m_shadedSelection;
+    int m_opacity;
+    bool m_captureDone;
+};
@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "sessionrecorder.h"
+#include "abstractlogger.h"
+#include "confighandler.h"
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QWidget>
+
+#define RECORD_SESSION_VARIABLE "FLAMESHOT_RECORD_SESSION"
+
+QString SessionRecorder::requestedPath()
+{
+    return QString::fromLocal8Bit(qgetenv(RECORD_SESSION_VARIABLE));
+}
+
+SessionRecorder::SessionRecorder(QWidget* captureWindow,
+                                 const QPixmap& screenshot,
+                                 const QString& path)
+  : QObject(captureWindow)
+  , m_captureWindow(captureWindow)
+  , m_path(path)
+{
+    QDir().mkpath(m_path);
+    if (!screenshot.save(QDir(m_path).filePath("screenshot.png"))) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("Unable to save the recorded screenshot in ") + m_path;
+    }
+    // The replay reproduces the session with the same configuration
+    const QString config = QDir(m_path).filePath("flameshot.ini");
+    QFile::remove(config);
+    QFile::copy(ConfigHandler().configFilePath(), config);
+    m_clock.start();
+    qApp->installEventFilter(this);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    qApp->removeEventFilter(this);
+    QVariantMap session;
+    session[QStringLiteral("events")] = m_events;
+    QFile file(QDir(m_path).filePath("events.json"));
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(QJsonDocument(QJsonObject::fromVariantMap(session))
+                     .toJson()) < 0) {
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << tr("Unable to save the recorded events in ") + m_path;
+    }
+}
+
+bool SessionRecorder::eventFilter(QObject* watched, QEvent* event)
+{
+    // The application filters see an event again for every widget it is
+    // propagated to, only the original delivery is spontaneous
+    auto* widget = qobject_cast<QWidget*>(watched);
+    if (!event->spontaneous() || widget == nullptr ||
+        widget->window() != m_captureWindow) {
+        return false;
+    }
+
+    QVariantMap e;
+    switch (event->type()) {
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+        case QEvent::MouseMove: {
+            auto* mouse = static_cast<QMouseEvent*>(event);
+            QPoint pos = widget->mapTo(m_captureWindow, mouse->pos());
+            e[QStringLiteral("x")] = pos.x();
+            e[QStringLiteral("y")] = pos.y();
+            e[QStringLiteral("button")] = static_cast<int>(mouse->button());
+            e[QStringLiteral("buttons")] = static_cast<int>(mouse->buttons());
+            e[QStringLiteral("modifiers")] =
+              static_cast<int>(mouse->modifiers());
+            break;
+        }
+        case QEvent::Wheel: {
+            auto* wheel = static_cast<QWheelEvent*>(event);
+            QPoint pos = widget->mapTo(m_captureWindow, wheel->pos());
+            e[QStringLiteral("x")] = pos.x();
+            e[QStringLiteral("y")] = pos.y();
+            e[QStringLiteral("delta")] = wheel->angleDelta().y();
+            e[QStringLiteral("buttons")] = static_cast<int>(wheel->buttons());
+            e[QStringLiteral("modifiers")] =
+              static_cast<int>(wheel->modifiers());
+            break;
+        }
+        case QEvent::KeyPress:
+        case QEvent::KeyRelease: {
+            auto* key = static_cast<QKeyEvent*>(event);
+            e[QStringLiteral("key")] = key->key();
+            e[QStringLiteral("text")] = key->text();
+            e[QStringLiteral("autoRepeat")] = key->isAutoRepeat();
+            e[QStringLiteral("modifiers")] = static_cast<int>(key->modifiers());
+            break;
+        }
+        default:
+            return false;
+    }
+    e[QStringLiteral("time")] = m_clock.elapsed();
+    e[QStringLiteral("type")] = static_cast<int>(event->type());
+    m_events << e;
+    return false;
+}
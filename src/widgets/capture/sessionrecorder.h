@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPixmap>
+#include <QVariantList>
+
+// Records the input events of a capture session, so that it can be replayed
+// by flameshot_replay (tests/bench) to measure the rendering latency.
+//
+// Recording is enabled by setting FLAMESHOT_RECORD_SESSION to a directory.
+// The screenshot is saved there as screenshot.png, a copy of the
+// configuration as flameshot.ini and, when the capture is closed, the events
+// as events.json:
+//
+//   { "events": [ { "time": 1520, "type": 2, "x": 100, "y": 80,
+//                   "button": 1, "buttons": 1, "modifiers": 0 }, ... ] }
+//
+// "time" is in milliseconds since the start of the session, "type" is the
+// QEvent::Type and the positions are relative to the capture window. Key
+// events have "key", "text" and "autoRepeat", wheel events "delta".
+class SessionRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Directory requested by the environment, empty if not recording
+    static QString requestedPath();
+
+    SessionRecorder(QWidget* captureWindow,
+                    const QPixmap& screenshot,
+                    const QString& path);
+    ~SessionRecorder();
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    QWidget* m_captureWindow;
+    QString m_path;
+    QElapsedTimer m_clock;
+    QVariantList m_events;
+};
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "tiledrenderer.h"
+#include <QImage>
+#include <QPainter>
+#include <QThread>
+#include <QtConcurrent>
+#include <cstring>
+
+// Size of the square tiles, in device pixels
+#define TILE_SIZE 256
+// Below this amount of consecutive objects the serial replay is cheaper
+#define MIN_TILED_OBJECTS 4
+
+namespace {
+
+struct Tile
+{
+    QRect rect;
+    QVector<CaptureTool*> tools;
+};
+
+void processPixmapWithTool(QPixmap& pixmap, CaptureTool* tool)
+{
+    tool->updateSprite(pixmap);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    tool->drawCached(painter, pixmap);
+}
+
+void copyRect(const uchar* src,
+              int srcBytesPerLine,
+              const QPoint& srcPos,
+              uchar* dst,
+              int dstBytesPerLine,
+              const QPoint& dstPos,
+              const QSize& size,
+              int bytesPerPixel)
+{
+    const int rowLength = size.width() * bytesPerPixel;
+    for (int y = 0; y < size.height(); ++y) {
+        std::memcpy(dst + (dstPos.y() + y) * dstBytesPerLine +
+                      dstPos.x() * bytesPerPixel,
+                    src + (srcPos.y() + y) * srcBytesPerLine +
+                      srcPos.x() * bytesPerPixel,
+                    rowLength);
+    }
+}
+
+void renderRun(QPixmap& canvas, const QVector<CaptureTool*>& run)
+{
+    if (run.isEmpty()) {
+        return;
+    }
+    if (run.size() < MIN_TILED_OBJECTS || QThread::idealThreadCount() < 2) {
+        for (auto* tool : run) {
+            processPixmapWithTool(canvas, tool);
+        }
+        return;
+    }
+
+    const qreal dpr = canvas.devicePixelRatio();
+    const QRect canvasRect(QPoint(0, 0), canvas.size());
+
+    // Device area touched by every object of the run
+    QVector<QRect> objectRects;
+    objectRects.reserve(run.size());
+    for (auto* tool : run) {
+        const QRectF r = tool->paintRect();
+        objectRects << QRectF(r.topLeft() * dpr, r.size() * dpr)
+                         .toAlignedRect()
+                         .intersected(canvasRect);
+    }
+
+    QVector<Tile> tiles;
+    for (int y = 0; y < canvasRect.height(); y += TILE_SIZE) {
+        for (int x = 0; x < canvasRect.width(); x += TILE_SIZE) {
+            Tile tile;
+            tile.rect = QRect(x, y, TILE_SIZE, TILE_SIZE) & canvasRect;
+            for (int i = 0; i < run.size(); ++i) {
+                if (objectRects[i].intersects(tile.rect)) {
+                    tile.tools << run[i];
+                }
+            }
+            if (!tile.tools.isEmpty()) {
+                tiles << tile;
+            }
+        }
+    }
+    if (tiles.isEmpty()) {
+        return;
+    }
+
+    // Sprites are rendered here, the workers only blit them
+    for (auto* tool : run) {
+        tool->updateSprite(canvas);
+    }
+
+    QImage image = canvas.toImage();
+    if (image.depth() != 32) {
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    // Workers only access the raw buffer, each one its own tile, so the image
+    // must be detached before they start
+    uchar* bits = image.bits();
+    const int bytesPerLine = image.bytesPerLine();
+    const QImage::Format format = image.format();
+    // Thread safe tools don't read the pixmap, but it is still required by the
+    // process() signature
+    const QPixmap nullPixmap;
+
+    QtConcurrent::blockingMap(tiles, [&](Tile& tile) {
+        QImage tileImage(tile.rect.size(), format);
+        copyRect(bits,
+                 bytesPerLine,
+                 tile.rect.topLeft(),
+                 tileImage.bits(),
+                 tileImage.bytesPerLine(),
+                 QPoint(0, 0),
+                 tile.rect.size(),
+                 4);
+        tileImage.setDevicePixelRatio(dpr);
+        {
+            QPainter painter(&tileImage);
+            painter.setRenderHint(QPainter::Antialiasing);
+            painter.translate(-QPointF(tile.rect.topLeft()) / dpr);
+            for (auto* tool : tile.tools) {
+                painter.save();
+                tool->drawCached(painter, nullPixmap);
+                painter.restore();
+            }
+        }
+        copyRect(tileImage.constBits(),
+                 tileImage.bytesPerLine(),
+                 QPoint(0, 0),
+                 bits,
+                 bytesPerLine,
+                 tile.rect.topLeft(),
+                 tile.rect.size(),
+                 4);
+    });
+
+    canvas = QPixmap::fromImage(image);
+}
+
+} // unnamed namespace
+
+namespace TiledRenderer {
+
+QPixmap render(const QPixmap& base, const QList<QPointer<CaptureTool>>& tools)
+{
+    QPixmap canvas = base;
+    QVector<CaptureTool*> run;
+    for (const auto& tool : tools) {
+        if (tool.isNull()) {
+            continue;
+        }
+        if (tool->isProcessThreadSafe()) {
+            run << tool;
+            continue;
+        }
+        renderRun(canvas, run);
+        run.clear();
+        processPixmapWithTool(canvas, tool);
+    }
+    renderRun(canvas, run);
+    return canvas;
+}
+
+} // namespace
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/capturetool.h"
+#include <QList>
+#include <QPixmap>
+#include <QPointer>
+
+// Replays capture tool objects over a screenshot.
+//
+// Consecutive tools that report isProcessThreadSafe() are rendered in
+// parallel: the canvas is split into tiles and every tile paints, on the
+// global thread pool, the whole geometry of the objects intersecting it. As
+// each object is rasterized in the same device coordinates whatever tile it is
+// clipped to, antialiased strokes are stitched without seams. Other tools
+// (pixelate, invert, text...) are processed in order on the calling thread,
+// on top of what has been rendered before them. The objects of tools that
+// report isSpriteCacheable() are blitted from their sprite in both cases.
+namespace TiledRenderer {
+
+QPixmap render(const QPixmap& base, const QList<QPointer<CaptureTool>>& tools);
+
+} // namespace
@@ -3,11 +3,13 @@
 
 #include "utilitypanel.h"
 #include "capturewidget.h"
+#include "src/utils/iconcache.h"
 #include <QHBoxLayout>
-#include <QListWidget>
+#include <QListView>
 #include <QPropertyAnimation>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QStyle>
 #include <QTimer>
 
 UtilityPanel::UtilityPanel(CaptureWidget* captureWidget)
@@ -24,6 +26,7 @@ UtilityPanel::UtilityPanel(CaptureWidget* captureWidget)
   , m_buttonDelete(nullptr)
   , m_buttonMoveUp(nullptr)
   , m_buttonMoveDown(nullptr)
+  , m_iconDevicePixelRatio(0)
 {
     initInternalPanel();
     setAttribute(Qt::WA_TransparentForMouseEvents);
@@ -135,35 +138,26 @@ void UtilityPanel::initInternalPanel()
       QStringLiteral("QScrollArea {background-color: %1}").arg(bgColor.name()));
     m_internalPanel->hide();
 
-    m_captureTools = new QListWidget(this);
-    connect(m_captureTools,
-            SIGNAL(currentRowChanged(int)),
-            this,
-            SLOT(onCurrentRowChanged(int)));
+    m_captureTools = new QListView(this);
+    m_captureTools->setUniformItemSizes(true);
 
     auto* layersButtons = new QHBoxLayout();
     m_layersLayout->addLayout(layersButtons);
 
     m_layersLayout->addWidget(m_captureTools);
 
-    bool isDark = ColorUtils::colorIsDark(bgColor);
-    QString coloredIconPath =
-      isDark ? PathInfo::whiteIconPath() : PathInfo::blackIconPath();
-
     m_buttonDelete = new QPushButton(this);
-    m_buttonDelete->setIcon(QIcon(coloredIconPath + "delete.svg"));
     m_buttonDelete->setMinimumWidth(m_buttonDelete->height());
     m_buttonDelete->setDisabled(true);
 
     m_buttonMoveUp = new QPushButton(this);
-    m_buttonMoveUp->setIcon(QIcon(coloredIconPath + "move_up.svg"));
     m_buttonMoveUp->setMinimumWidth(m_buttonMoveUp->height());
     m_buttonMoveUp->setDisabled(true);
 
     m_buttonMoveDown = new QPushButton(this);
-    m_buttonMoveDown->setIcon(QIcon(coloredIconPath + "move_down.svg"));
     m_buttonMoveDown->setMinimumWidth(m_buttonMoveDown->height());
     m_buttonMoveDown->setDisabled(true);
+    updateLayerButtonIcons();
 
     layersButtons->addWidget(m_buttonDelete);
     layersButtons->addWidget(m_buttonMoveUp);
@@ -192,40 +186,55 @@ void UtilityPanel::initInternalPanel()
     m_bottomLayout->addWidget(closeButton);
 }
 
-void UtilityPanel::fillCaptureTools(
-  const QList<QPointer<CaptureTool>>& captureToolObjects)
+void UtilityPanel::setLayersModel(QAbstractItemModel* model)
 {
-    int currentSelection = m_captureTools->currentRow();
-    m_captureTools->clear();
-    m_captureTools->addItem(tr("<Empty>"));
-
-    for (auto toolItem : captureToolObjects) {
-        auto* item = new QListWidgetItem(
-          toolItem->icon(QColor(Qt::white), false), toolItem->info());
-        m_captureTools->addItem(item);
-    }
-    if (currentSelection >= 0 && currentSelection < m_captureTools->count()) {
-        m_captureTools->setCurrentRow(currentSelection);
+    m_captureTools->setModel(model);
+    connect(m_captureTools->selectionModel(),
+            &QItemSelectionModel::currentRowChanged,
+            this,
+            [this](const QModelIndex& current) {
+                onCurrentRowChanged(current.row());
+            });
+}
+
+int UtilityPanel::currentRow() const
+{
+    return m_captureTools->currentIndex().row();
+}
+
+void UtilityPanel::setCurrentRow(int row)
+{
+    m_captureTools->setCurrentIndex(m_captureTools->model()->index(row, 0));
+}
+
+// Unlike setCurrentRow, also refreshes the buttons and the active layer when
+// the row is already the current one, which happens when the current row was
+// moved or removed by the model
+void UtilityPanel::selectRow(int row)
+{
+    if (row == currentRow()) {
+        onCurrentRowChanged(row);
+    } else {
+        setCurrentRow(row);
     }
 }
 
 void UtilityPanel::setActiveLayer(int index)
 {
     Q_ASSERT(index >= -1);
-    m_captureTools->setCurrentRow(index + 1);
+    setCurrentRow(index + 1);
 }
 
 int UtilityPanel::activeLayerIndex()
 {
-    return m_captureTools->currentRow() >= 0 ? m_captureTools->currentRow() - 1
-                                             : -1;
+    return currentRow() >= 0 ? currentRow() - 1 : -1;
 }
 
 void UtilityPanel::onCurrentRowChanged(int currentRow)
 {
+    const int count = m_captureTools->model()->rowCount();
     m_buttonDelete->setDisabled(currentRow <= 0);
-    m_buttonMoveDown->setDisabled(currentRow == 0 ||
-                                  currentRow + 1 == m_captureTools->count());
+    m_buttonMoveDown->setDisabled(currentRow == 0 || currentRow + 1 == count);
     m_buttonMoveUp->setDisabled(currentRow <= 1);
 
     emit layerChanged(activeLayerIndex());
@@ -235,33 +244,65 @@ void UtilityPanel::slotUpClicked(bool clicked)
 {
     Q_UNUSED(clicked);
     // subtract 1 because there's <empty> in m_captureTools as [0] element
-    int toolRow = m_captureTools->currentRow() - 1;
-    m_captureTools->setCurrentRow(toolRow);
+    int toolRow = currentRow() - 1;
+    // The current row follows the moved object
     emit moveUpClicked(toolRow);
+    selectRow(toolRow);
 }
 
 void UtilityPanel::slotDownClicked(bool clicked)
 {
     Q_UNUSED(clicked);
     // subtract 1 because there's <empty> in m_captureTools as [0] element
-    int toolRow = m_captureTools->currentRow() - 1;
-    m_captureTools->setCurrentRow(toolRow + 2);
+    int toolRow = currentRow() - 1;
     emit moveDownClicked(toolRow);
+    selectRow(toolRow + 2);
 }
 
 void UtilityPanel::slotButtonDelete(bool clicked)
 {
     Q_UNUSED(clicked)
-    int currentRow = m_captureTools->currentRow();
-    if (currentRow > 0) {
-        m_captureWidget->removeToolObject(currentRow);
-        if (currentRow >= m_captureTools->count()) {
-            currentRow = m_captureTools->count() - 1;
-        }
+    int row = currentRow();
+    if (row > 0) {
+        // The layer is reported once the row to select is known
+        blockSignals(true);
+        m_captureWidget->removeToolObject(row);
+        blockSignals(false);
+        row = qMin(row, m_captureTools->model()->rowCount() - 1);
     } else {
-        currentRow = 0;
+        row = 0;
+    }
+    selectRow(row);
+}
+
+void UtilityPanel::updateLayerButtonIcons()
+{
+    m_iconDevicePixelRatio = devicePixelRatioF();
+    QColor bgColor = palette().window().color();
+    QString coloredIconPath = ColorUtils::colorIsDark(bgColor)
+                                ? PathInfo::whiteIconPath()
+                                : PathInfo::blackIconPath();
+    int iconExtent = style()->pixelMetric(QStyle::PM_ButtonIconSize);
+    auto panelIcon = [&](const QString& path) {
+        return IconCache::icon(path,
+                               QSize(iconExtent, iconExtent),
+                               m_iconDevicePixelRatio,
+                               [path]() { return QIcon(path); });
+    };
+    m_buttonDelete->setIcon(panelIcon(coloredIconPath + "delete.svg"));
+    m_buttonMoveUp->setIcon(panelIcon(coloredIconPath + "move_up.svg"));
+    m_buttonMoveDown->setIcon(panelIcon(coloredIconPath + "move_down.svg"));
+}
+
+bool UtilityPanel::event(QEvent* event)
+{
+    // The ratio of the screen is only known once the panel is shown on it
+    if ((event->type() == QEvent::Show ||
+         event->type() == QEvent::ScreenChangeInternal) &&
+        devicePixelRatioF() != m_iconDevicePixelRatio) {
+        updateLayerButtonIcons();
     }
-    m_captureTools->setCurrentRow(currentRow);
+    return QWidget::event(event);
 }
 
 bool UtilityPanel::isVisible() const
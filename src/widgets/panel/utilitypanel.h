@@ -11,8 +11,9 @@ class QVBoxLayout;
 class QPropertyAnimation;
 class QScrollArea;
 class QPushButton;
-class QListWidget;
+class QListView;
 class QPushButton;
+class QAbstractItemModel;
 class CaptureWidget;
 
 class UtilityPanel : public QWidget
@@ -27,12 +28,15 @@ public:
     void pushWidget(QWidget* widget);
     void hide();
     void show();
-    void fillCaptureTools(
-      const QList<QPointer<CaptureTool>>& captureToolObjectsHistory);
+    // The layers list shows the rows of model, see CaptureToolObjects
+    void setLayersModel(QAbstractItemModel* model);
     void setActiveLayer(int index);
     int activeLayerIndex();
     bool isVisible() const;
 
+protected:
+    bool event(QEvent* event) override;
+
 signals:
     void layerChanged(int layer);
     void moveUpClicked(int currentRow);
@@ -49,6 +53,10 @@ private slots:
 
 private:
     void initInternalPanel();
+    void updateLayerButtonIcons();
+    int currentRow() const;
+    void setCurrentRow(int row);
+    void selectRow(int row);
 
     QPointer<QWidget> m_toolWidget;
     QScrollArea* m_internalPanel;
@@ -58,9 +66,11 @@ private:
     QPropertyAnimation* m_showAnimation;
     QPropertyAnimation* m_hideAnimation;
     QVBoxLayout* m_layersLayout;
-    QListWidget* m_captureTools;
+    QListView* m_captureTools;
     QPushButton* m_buttonDelete;
     QPushButton* m_buttonMoveUp;
     QPushButton* m_buttonMoveDown;
     CaptureWidget* m_captureWidget;
+    // Device pixel ratio the button icons were rasterized for
+    qreal m_iconDevicePixelRatio;
 };
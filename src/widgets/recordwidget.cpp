@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "recordwidget.h"
+#include "src/utils/abstractlogger.h"
+#include "src/utils/globalvalues.h"
+#include "src/utils/screengrabber.h"
+#include "src/widgets/regionwindow.h"
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QShortcut>
+#include <QTimer>
+
+RecordWidget::RecordWidget(const QRect& region,
+                           int fps,
+                           int duration,
+                           QWidget* parent)
+  : QWidget(parent)
+  , m_region(region)
+  , m_duration(duration)
+  , m_timer(new QTimer(this))
+  , m_status(new QLabel(this))
+  , m_done(false)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowIcon(QIcon(GlobalValues::iconPath()));
+    setWindowTitle(tr("Recording"));
+    setWindowFlags(Qt::WindowStaysOnTopHint | Qt::Tool);
+
+    auto* stopButton = new QPushButton(tr("Stop"), this);
+    connect(stopButton, &QPushButton::clicked, this, [this]() { stop(); });
+    connect(new QShortcut(Qt::Key_Return, this),
+            &QShortcut::activated,
+            this,
+            [this]() { stop(); });
+    connect(new QShortcut(Qt::Key_Escape, this),
+            &QShortcut::activated,
+            this,
+            [this]() { stop(); });
+
+    auto* layout = new QHBoxLayout(this);
+    layout->addWidget(m_status);
+    layout->addWidget(stopButton);
+    m_status->setText(tr("Recording: %1 s").arg(0));
+
+    m_timer->setTimerType(Qt::PreciseTimer);
+    m_timer->setInterval(1000 / qMax(fps, 1));
+    connect(m_timer, &QTimer::timeout, this, [this]() { grabFrame(); });
+}
+
+bool RecordWidget::start(const QString& path)
+{
+    bool ok = false;
+    ScreenGrabber().grabRegion(m_region, ok);
+    if (!ok) {
+        AbstractLogger::error()
+          << tr("Unable to capture the region, recording is not supported "
+                "on Wayland");
+        return false;
+    }
+    adjustSize();
+    m_region = RegionWindow::placeOutside(this, m_region);
+    if (m_region.isEmpty()) {
+        AbstractLogger::error() << tr("The region is too small to record");
+        return false;
+    }
+    if (!m_recorder.start(path)) {
+        AbstractLogger::error()
+          << tr("Unable to write the recording to %1").arg(path);
+        return false;
+    }
+    m_path = path;
+    show();
+    m_elapsed.start();
+    grabFrame();
+    m_timer->start();
+    return true;
+}
+
+void RecordWidget::grabFrame()
+{
+    if (m_done) {
+        return;
+    }
+    const qint64 elapsed = m_elapsed.elapsed();
+    if (elapsed >= m_duration) {
+        stop();
+        return;
+    }
+    bool ok = false;
+    const QPixmap frame = ScreenGrabber().grabRegion(m_region, ok);
+    if (ok) {
+        // QPixmap can only be used in the GUI thread
+        m_recorder.addFrame(frame.toImage(), elapsed);
+    }
+    m_status->setText(tr("Recording: %1 s").arg(elapsed / 1000));
+}
+
+void RecordWidget::stop()
+{
+    if (m_done) {
+        return;
+    }
+    m_done = true;
+    m_timer->stop();
+    hide();
+    const qint64 end = qMin<qint64>(m_elapsed.elapsed(), m_duration);
+    if (m_recorder.finish(end)) {
+        if (m_recorder.droppedFrames() > 0) {
+            AbstractLogger::info()
+              << tr("%1 frames were dropped, the encoder was too slow")
+                   .arg(m_recorder.droppedFrames());
+        }
+        emit recordingSaved(m_path);
+    } else {
+        AbstractLogger::error()
+          << tr("Unable to write the recording to %1").arg(m_path);
+        emit recordingFailed();
+    }
+    close();
+}
+
+void RecordWidget::closeEvent(QCloseEvent* event)
+{
+    stop();
+    QWidget::closeEvent(event);
+}
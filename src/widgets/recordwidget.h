@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/animationrecorder.h"
+#include <QElapsedTimer>
+#include <QWidget>
+
+class QLabel;
+class QTimer;
+
+// Small window shown next to the region being recorded. The region is
+// grabbed at a fixed rate and the frames go to an AnimationRecorder, which
+// encodes them while the recording runs.
+class RecordWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    // region is in logical global coordinates, duration in milliseconds
+    explicit RecordWidget(const QRect& region,
+                          int fps,
+                          int duration,
+                          QWidget* parent = nullptr);
+
+    // False when the region can't be grabbed or path can't be written
+    bool start(const QString& path);
+
+signals:
+    void recordingSaved(const QString& path);
+    void recordingFailed();
+
+protected:
+    // Closing the window stops the recording
+    void closeEvent(QCloseEvent* event) override;
+
+private:
+    void grabFrame();
+    void stop();
+
+    QRect m_region;
+    int m_duration;
+    QString m_path;
+    AnimationRecorder m_recorder;
+    QElapsedTimer m_elapsed;
+    QTimer* m_timer;
+    QLabel* m_status;
+    bool m_done;
+};
@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "regionwindow.h"
+#include <QApplication>
+#include <QDesktopWidget>
+#include <QWidget>
+
+// Space between the region and the window
+#define REGION_WINDOW_SPACING 8
+
+QRect RegionWindow::placeOutside(QWidget* window, const QRect& region)
+{
+    const QRect screen =
+      QApplication::desktop()->screenGeometry(region.center());
+    const QSize size = window->frameGeometry().size();
+    QRect uncovered = region;
+    QPoint pos(region.right() - size.width(),
+               region.bottom() + REGION_WINDOW_SPACING);
+    if (pos.y() + size.height() > screen.bottom()) {
+        pos.setY(region.top() - REGION_WINDOW_SPACING - size.height());
+    }
+    if (pos.y() < screen.top()) {
+        pos.setY(region.bottom() - REGION_WINDOW_SPACING - size.height());
+        uncovered.setBottom(pos.y() - REGION_WINDOW_SPACING);
+    }
+    pos.setX(qBound(screen.left(), pos.x(), screen.right() - size.width()));
+    window->move(pos);
+    return uncovered;
+}
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QRect>
+
+class QWidget;
+
+namespace RegionWindow { // namespace
+
+// Moves window next to region, which is in logical global coordinates, for
+// it not to appear in the grabs of the region: below it, or above it. When
+// the region leaves no room on its screen, the window goes inside of it at
+// the bottom. Returns the part of region the window does not cover, which is
+// empty when the region is too small.
+QRect placeOutside(QWidget* window, const QRect& region);
+
+} // namespace
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollcapturewidget.h"
+#include "src/utils/abstractlogger.h"
+#include "src/utils/globalvalues.h"
+#include "src/utils/screengrabber.h"
+#include "src/widgets/regionwindow.h"
+#include <QFutureWatcher>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QShortcut>
+#include <QTimer>
+#include <QtConcurrent>
+
+// Interval between two grabs of the region (ms)
+#define SCROLL_GRAB_INTERVAL 100
+
+ScrollCaptureWidget::ScrollCaptureWidget(const QRect& region, QWidget* parent)
+  : QWidget(parent)
+  , m_region(region)
+  , m_timer(new QTimer(this))
+  , m_watcher(new QFutureWatcher<int>(this))
+  , m_status(new QLabel(this))
+  , m_done(false)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setWindowIcon(QIcon(GlobalValues::iconPath()));
+    setWindowTitle(tr("Scrolling Capture"));
+    setWindowFlags(Qt::WindowStaysOnTopHint | Qt::Tool);
+
+    auto* doneButton = new QPushButton(tr("Done"), this);
+    auto* cancelButton = new QPushButton(tr("Cancel"), this);
+    connect(doneButton, &QPushButton::clicked, this, [this]() { finish(); });
+    connect(cancelButton, &QPushButton::clicked, this, &QWidget::close);
+    connect(new QShortcut(Qt::Key_Return, this),
+            &QShortcut::activated,
+            this,
+            [this]() { finish(); });
+    connect(new QShortcut(Qt::Key_Escape, this),
+            &QShortcut::activated,
+            this,
+            [this]() { close(); });
+
+    auto* layout = new QHBoxLayout(this);
+    layout->addWidget(m_status);
+    layout->addWidget(doneButton);
+    layout->addWidget(cancelButton);
+    m_status->setText(tr("Scroll down the region"));
+
+    m_timer->setInterval(SCROLL_GRAB_INTERVAL);
+    connect(m_timer, &QTimer::timeout, this, [this]() { grabFrame(); });
+    connect(m_watcher, &QFutureWatcher<int>::finished, this, [this]() {
+        frameStitched();
+    });
+}
+
+bool ScrollCaptureWidget::start()
+{
+    bool ok = false;
+    ScreenGrabber().grabRegion(m_region, ok);
+    if (!ok) {
+        AbstractLogger::error()
+          << tr("Unable to capture the region, scrolling capture is not "
+                "supported on Wayland");
+        return false;
+    }
+    adjustSize();
+    m_region = RegionWindow::placeOutside(this, m_region);
+    if (m_region.isEmpty()) {
+        AbstractLogger::error() << tr("The region is too small to scroll");
+        return false;
+    }
+    show();
+    grabFrame();
+    m_timer->start();
+    return true;
+}
+
+void ScrollCaptureWidget::grabFrame()
+{
+    if (m_done || m_watcher->isRunning()) {
+        // The stitcher is behind, this frame is skipped
+        return;
+    }
+    bool ok = false;
+    const QPixmap frame = ScreenGrabber().grabRegion(m_region, ok);
+    if (!ok) {
+        return;
+    }
+    // QPixmap can only be used in the GUI thread. The stitcher is only used
+    // by the thread pool while the watcher runs.
+    const QImage image = frame.toImage();
+    m_watcher->setFuture(QtConcurrent::run(
+      [this, image]() { return m_stitcher.append(image); }));
+}
+
+void ScrollCaptureWidget::frameStitched()
+{
+    if (m_done) {
+        return;
+    }
+    if (m_stitcher.isFull()) {
+        finish();
+        return;
+    }
+    m_status->setText(tr("Scroll down the region: %1 px captured")
+                        .arg(m_stitcher.height()));
+}
+
+void ScrollCaptureWidget::finish()
+{
+    if (m_done) {
+        return;
+    }
+    m_done = true;
+    m_timer->stop();
+    m_watcher->waitForFinished();
+    hide();
+    const QImage page = m_stitcher.result();
+    if (page.isNull()) {
+        emit captureCanceled();
+    } else {
+        emit captureFinished(QPixmap::fromImage(page));
+    }
+    close();
+}
+
+void ScrollCaptureWidget::closeEvent(QCloseEvent* event)
+{
+    if (!m_done) {
+        m_done = true;
+        m_timer->stop();
+        m_watcher->waitForFinished();
+        emit captureCanceled();
+    }
+    QWidget::closeEvent(event);
+}
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/scrollstitcher.h"
+#include <QPixmap>
+#include <QWidget>
+
+class QLabel;
+class QTimer;
+template<typename T>
+class QFutureWatcher;
+
+// Small window shown next to the region of a scrolling capture, while the
+// user scrolls it. The region is grabbed a few times per second and stitched
+// on the thread pool; grabs are skipped while the previous frame is being
+// stitched, so the capture never falls behind.
+class ScrollCaptureWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    // region is in logical global coordinates
+    explicit ScrollCaptureWidget(const QRect& region,
+                                 QWidget* parent = nullptr);
+
+    // False when the region can't be grabbed
+    bool start();
+
+signals:
+    void captureFinished(QPixmap capture);
+    void captureCanceled();
+
+protected:
+    // Closing the window cancels the capture
+    void closeEvent(QCloseEvent* event) override;
+
+private:
+    void grabFrame();
+    void frameStitched();
+    void finish();
+
+    QRect m_region;
+    ScrollStitcher m_stitcher;
+    QTimer* m_timer;
+    QFutureWatcher<int>* m_watcher;
+    QLabel* m_status;
+    bool m_done;
+};
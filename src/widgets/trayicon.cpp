@@ -2,6 +2,7 @@
 
 #include "src/core/flameshot.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/tools/imgupload/uploadqueue.h"
 #include "src/utils/globalvalues.h"
 
 #include "src/utils/confighandler.h"
@@ -152,10 +153,27 @@ void TrayIcon::initMenu()
             Flameshot::instance(),
             &Flameshot::history);
 
+    // Also the only way to stop the uploads resumed from a previous session
+    UploadQueue* uploads = UploadQueue::instance();
+    QAction* cancelUploadsAction = new QAction(tr("Cancel Uploads"), this);
+    cancelUploadsAction->setVisible(!uploads->isIdle());
+    connect(cancelUploadsAction,
+            &QAction::triggered,
+            uploads,
+            &UploadQueue::cancelAll);
+    connect(uploads,
+            &UploadQueue::activityChanged,
+            cancelUploadsAction,
+            [cancelUploadsAction]() {
+                cancelUploadsAction->setVisible(
+                  !UploadQueue::instance()->isIdle());
+            });
+
     m_menu->addAction(captureAction);
     m_menu->addAction(launcherAction);
     m_menu->addSeparator();
     m_menu->addAction(recentAction);
+    m_menu->addAction(cancelUploadsAction);
     m_menu->addSeparator();
     m_menu->addAction(configAction);
     m_menu->addSeparator();
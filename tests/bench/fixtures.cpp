@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "fixtures.h"
+#include <QImage>
+#include <QTcpSocket>
+
+QPixmap syntheticScreenshot(const QSize& size)
+{
+    QImage image(size, QImage::Format_RGB32);
+    quint32 seed = 1;
+    for (int y = 0; y < image.height(); ++y) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            seed = seed * 1103515245 + 12345;
+            int noise = (seed >> 16) & 0x1f;
+            bool window = (x / 300 + y / 200) % 3 == 0;
+            line[x] = window ? qRgb(240, 240, 240)
+                             : qRgb((x * 255 / size.width()) ^ noise,
+                                    (y * 255 / size.height()) ^ noise,
+                                    128 + noise);
+        }
+    }
+    return QPixmap::fromImage(image);
+}
+
+LocalHttpServer::LocalHttpServer(int failures)
+  : m_failures(failures)
+  , m_requests(0)
+{
+    listen(QHostAddress::LocalHost);
+    connect(this, &QTcpServer::newConnection, this, [this]() {
+        while (QTcpSocket* socket = nextPendingConnection()) {
+            connect(socket, &QTcpSocket::readyRead, socket, [=]() {
+                serve(socket);
+            });
+        }
+    });
+}
+
+QString LocalHttpServer::url() const
+{
+    return QStringLiteral("http://127.0.0.1:%1/{filename}").arg(serverPort());
+}
+
+void LocalHttpServer::serve(QTcpSocket* socket)
+{
+    QByteArray buffer = socket->property("buffer").toByteArray();
+    buffer += socket->readAll();
+    for (;;) {
+        const int headerEnd = buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            break;
+        }
+        qint64 length = 0;
+        for (const QByteArray& line : buffer.left(headerEnd).split('\n')) {
+            if (line.toLower().startsWith("content-length:")) {
+                length = line.mid(15).trimmed().toLongLong();
+            }
+        }
+        if (buffer.size() < headerEnd + 4 + length) {
+            break;
+        }
+        buffer.remove(0, headerEnd + 4 + length);
+        if (m_requests++ < m_failures) {
+            socket->write("HTTP/1.1 503 Service Unavailable\r\n"
+                          "Content-Length: 0\r\n\r\n");
+            continue;
+        }
+        const QByteArray body =
+          "{\"url\":\"http://127.0.0.1/x.png\","
+          "\"data\":{\"link\":\"http://127.0.0.1/x.png\","
+          "\"deletehash\":\"x\"}}";
+        socket->write("HTTP/1.1 200 OK\r\n"
+                      "Content-Type: application/json\r\n"
+                      "Content-Length: " +
+                      QByteArray::number(body.size()) + "\r\n\r\n" + body);
+    }
+    socket->setProperty("buffer", buffer);
+}
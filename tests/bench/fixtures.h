@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QPixmap>
+#include <QTcpServer>
+
+class QTcpSocket;
+
+// Inputs shared by flameshot_bench and flameshot_tests
+
+// Screenshot-like content: flat areas, gradients and noise, so that the
+// encoders can't take shortcuts
+QPixmap syntheticScreenshot(const QSize& size);
+
+// Stand-in for an object store or Imgur: accepts any request on keep-alive
+// connections and answers with the URL of the "stored" image, after failing
+// the first ones with a 503
+class LocalHttpServer : public QTcpServer
+{
+public:
+    explicit LocalHttpServer(int failures = 0);
+
+    QString url() const;
+    int requests() const { return m_requests; }
+
+private:
+    void serve(QTcpSocket* socket);
+
+    int m_failures;
+    int m_requests;
+};
@@ -0,0 +1,580 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+// Micro-benchmarks of the rendering, hit-testing, encoding, configuration and
+// upload paths. Run for instance
+//
+//   flameshot_bench -o results.xml,xml
+//   flameshot_bench -csv
+//
+// to get machine-readable results that can be compared between builds.
+
+#include "fixtures.h"
+#include "src/tools/annotationdocument.h"
+#include "src/tools/imgupload/storages/http/httpuploader.h"
+#include "src/utils/animationrecorder.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/filenamehandler.h"
+#include "src/utils/iconcache.h"
+#include "src/utils/scrollstitcher.h"
+#include "src/widgets/capture/capturetoolbutton.h"
+#include "src/widgets/capture/capturetoolobjects.h"
+#include "src/widgets/capture/tiledrenderer.h"
+#include <QBuffer>
+#include <QListView>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPainter>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QtTest>
+
+namespace {
+
+// Drawing objects spread over the screenshot, as a user would leave them
+QList<QPointer<CaptureTool>> syntheticObjects(const QSize& size, int count)
+{
+    static const QStringList types = { QStringLiteral("arrow"),
+                                       QStringLiteral("rectangle"),
+                                       QStringLiteral("circle"),
+                                       QStringLiteral("marker"),
+                                       QStringLiteral("drawer"),
+                                       QStringLiteral("selection") };
+    QVariantList list;
+    for (int i = 0; i < count; ++i) {
+        const int x = (i * 7919) % qMax(1, size.width() - 300);
+        const int y = (i * 104729) % qMax(1, size.height() - 200);
+        QVariantMap state;
+        state[QStringLiteral("type")] = types[i % types.size()];
+        state[QStringLiteral("color")] = QStringLiteral("#ffff0000");
+        state[QStringLiteral("size")] = 1 + i % 10;
+        state[QStringLiteral("points")] =
+          QVariantList{ QVariantList{ x, y },
+                        QVariantList{ x + 50 + i % 250, y + 30 + i % 170 } };
+        list << state;
+    }
+    QVariantMap document;
+    document[QStringLiteral("objects")] = list;
+
+    QList<CaptureTool*> objects;
+    QString error;
+    if (!AnnotationDocument::fromVariant(document, objects, error)) {
+        qFatal("%s", qPrintable(error));
+    }
+    QList<QPointer<CaptureTool>> result;
+    for (auto* object : objects) {
+        result << object;
+    }
+    return result;
+}
+
+CaptureTool* areaTool(const QString& type, const QSize& size)
+{
+    QVariantMap state;
+    state[QStringLiteral("type")] = type;
+    state[QStringLiteral("color")] = QStringLiteral("#ff000000");
+    state[QStringLiteral("size")] = 10;
+    state[QStringLiteral("points")] =
+      QVariantList{ QVariantList{ size.width() / 8, size.height() / 8 },
+                    QVariantList{ size.width() * 7 / 8,
+                                  size.height() * 7 / 8 } };
+    QVariantMap document;
+    document[QStringLiteral("objects")] = QVariantList{ state };
+
+    QList<CaptureTool*> objects;
+    QString error;
+    if (!AnnotationDocument::fromVariant(document, objects, error)) {
+        qFatal("%s", qPrintable(error));
+    }
+    return objects.first();
+}
+
+void addResolutionRows()
+{
+    QTest::newRow("1080p") << QSize(1920, 1080);
+    QTest::newRow("4K") << QSize(3840, 2160);
+    QTest::newRow("8K") << QSize(7680, 4320);
+}
+
+} // unnamed namespace
+
+class FlameshotBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Replay done by CaptureWidget::drawToolsData()
+    void drawToolsData_data();
+    void drawToolsData();
+    // Same replay with text objects only
+    void drawTextData_data();
+    void drawTextData();
+    void findToolObject_data();
+    void findToolObject();
+    // Undo and redo of an object, with the layers list showing the objects
+    void undoLayers_data();
+    void undoLayers();
+    void pixelate_data();
+    void pixelate();
+    void invert_data();
+    void invert();
+    void encode_data();
+    void encode();
+    // Buttons of a new capture overlay, without and with the icon atlas of
+    // a previous process
+    void overlayButtons_data();
+    void overlayButtons();
+    void configRead();
+    // The config check done before each capture
+    void configValidation();
+    void parsedPattern();
+    // Names of a burst of captures, reusing the same string
+    void formatFileName();
+    // Name of a new capture among 10000 duplicates of the same name
+    void numerateDuplicate();
+    // Concurrent uploads of a 4K capture to a local server
+    void httpUpload_data();
+    void httpUpload();
+    // Stitching of the frames of a scrolling capture, per 8 frames
+    void scrollStitch_data();
+    void scrollStitch();
+    // Recording of a 1080p region where a window moves, per 30 frames
+    void recordAnimation_data();
+    void recordAnimation();
+};
+
+void FlameshotBench::drawToolsData_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("count");
+    for (const QSize& size :
+         { QSize(1920, 1080), QSize(3840, 2160), QSize(7680, 4320) }) {
+        for (int count : { 10, 100, 1000 }) {
+            QTest::newRow(qPrintable(QStringLiteral("%1x%2 %3 objects")
+                                       .arg(size.width())
+                                       .arg(size.height())
+                                       .arg(count)))
+              << size << count;
+        }
+    }
+}
+
+void FlameshotBench::drawToolsData()
+{
+    QFETCH(QSize, size);
+    QFETCH(int, count);
+    const QPixmap screenshot = syntheticScreenshot(size);
+    const auto objects = syntheticObjects(size, count);
+    QBENCHMARK
+    {
+        QPixmap result = TiledRenderer::render(screenshot, objects);
+    }
+    for (const auto& object : objects) {
+        delete object.data();
+    }
+}
+
+void FlameshotBench::drawTextData_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10 objects") << 10;
+    QTest::newRow("100 objects") << 100;
+    QTest::newRow("1000 objects") << 1000;
+}
+
+void FlameshotBench::drawTextData()
+{
+    QFETCH(int, count);
+    const QSize size(1920, 1080);
+    QVariantList list;
+    for (int i = 0; i < count; ++i) {
+        QVariantMap state;
+        state[QStringLiteral("type")] = QStringLiteral("text");
+        state[QStringLiteral("color")] = QStringLiteral("#ffff0000");
+        state[QStringLiteral("size")] = 1 + i % 10;
+        state[QStringLiteral("text")] =
+          QStringLiteral("Annotation %1\nsecond line").arg(i);
+        state[QStringLiteral("alignment")] =
+          static_cast<int>(i % 2 == 0 ? Qt::AlignLeft : Qt::AlignRight);
+        state[QStringLiteral("pos")] =
+          QVariantList{ (i * 7919) % (size.width() - 300),
+                        (i * 104729) % (size.height() - 100) };
+        list << state;
+    }
+    QVariantMap document;
+    document[QStringLiteral("objects")] = list;
+    QList<CaptureTool*> created;
+    QString error;
+    if (!AnnotationDocument::fromVariant(document, created, error)) {
+        qFatal("%s", qPrintable(error));
+    }
+    QList<QPointer<CaptureTool>> objects;
+    for (auto* object : created) {
+        objects << object;
+    }
+    const QPixmap screenshot = syntheticScreenshot(size);
+    QBENCHMARK
+    {
+        QPixmap result = TiledRenderer::render(screenshot, objects);
+    }
+    qDeleteAll(created);
+}
+
+void FlameshotBench::findToolObject_data()
+{
+    // Every object is rasterized on a full size pixmap, the larger cases take
+    // minutes per iteration
+    QTest::addColumn<int>("count");
+    QTest::newRow("10 objects") << 10;
+    QTest::newRow("100 objects") << 100;
+}
+
+void FlameshotBench::findToolObject()
+{
+    QFETCH(int, count);
+    const QSize size(1920, 1080);
+    CaptureToolObjects objects;
+    for (const auto& object : syntheticObjects(size, count)) {
+        objects.append(object);
+    }
+    // Nothing is drawn in the corner, so all the objects are tested
+    QBENCHMARK
+    {
+        objects.find(QPoint(size.width() - 1, size.height() - 1), size);
+    }
+    for (const auto& object : objects.captureToolObjects()) {
+        delete object.data();
+    }
+}
+
+void FlameshotBench::undoLayers_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("100 objects") << 100;
+    QTest::newRow("1000 objects") << 1000;
+}
+
+void FlameshotBench::undoLayers()
+{
+    QFETCH(int, count);
+    const auto created = syntheticObjects(QSize(1920, 1080), count);
+    CaptureToolObjects before;
+    CaptureToolObjects after;
+    for (const auto& object : created) {
+        after.append(object);
+        if (before.size() + 1 < count) {
+            before.append(object);
+        }
+    }
+    CaptureToolObjects objects;
+    objects = after;
+    QListView view;
+    view.setModel(&objects);
+    view.setCurrentIndex(objects.index(count / 2));
+    QBENCHMARK
+    {
+        objects = before;
+        objects = after;
+    }
+    for (const auto& object : created) {
+        delete object.data();
+    }
+}
+
+void FlameshotBench::pixelate_data()
+{
+    QTest::addColumn<QSize>("size");
+    addResolutionRows();
+}
+
+void FlameshotBench::pixelate()
+{
+    QFETCH(QSize, size);
+    QPixmap screenshot = syntheticScreenshot(size);
+    CaptureTool* tool = areaTool(QStringLiteral("pixelate"), size);
+    QBENCHMARK
+    {
+        QPixmap pixmap = screenshot;
+        QPainter painter(&pixmap);
+        tool->process(painter, screenshot);
+    }
+    delete tool;
+}
+
+void FlameshotBench::invert_data()
+{
+    QTest::addColumn<QSize>("size");
+    addResolutionRows();
+}
+
+void FlameshotBench::invert()
+{
+    QFETCH(QSize, size);
+    QPixmap screenshot = syntheticScreenshot(size);
+    CaptureTool* tool = areaTool(QStringLiteral("invert"), size);
+    QBENCHMARK
+    {
+        QPixmap pixmap = screenshot;
+        QPainter painter(&pixmap);
+        tool->process(painter, screenshot);
+    }
+    delete tool;
+}
+
+void FlameshotBench::encode_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<QByteArray>("format");
+    for (const QSize& size :
+         { QSize(1920, 1080), QSize(3840, 2160), QSize(7680, 4320) }) {
+        for (const QByteArray& format :
+             { QByteArray("PNG"), QByteArray("JPG") }) {
+            QTest::newRow(qPrintable(QStringLiteral("%1x%2 %3")
+                                       .arg(size.width())
+                                       .arg(size.height())
+                                       .arg(QString(format))))
+              << size << format;
+        }
+    }
+}
+
+void FlameshotBench::encode()
+{
+    QFETCH(QSize, size);
+    QFETCH(QByteArray, format);
+    const QPixmap screenshot = syntheticScreenshot(size);
+    QBENCHMARK
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        screenshot.save(&buffer, format.constData());
+    }
+}
+
+void FlameshotBench::overlayButtons_data()
+{
+    QTest::addColumn<bool>("warm");
+    QTest::newRow("cold atlas") << false;
+    QTest::newRow("warm atlas") << true;
+}
+
+void FlameshotBench::overlayButtons()
+{
+    QFETCH(bool, warm);
+    // The atlas goes to a cache directory of its own
+    QStandardPaths::setTestModeEnabled(true);
+    auto createButtons = []() {
+        QWidget overlay;
+        for (CaptureTool::Type type :
+             CaptureToolButton::getIterableButtonTypes()) {
+            new CaptureToolButton(type, &overlay);
+        }
+    };
+    IconCache::reset(true);
+    if (warm) {
+        createButtons();
+    }
+    QBENCHMARK
+    {
+        // As in a new process, the atlas is mapped again
+        IconCache::reset(!warm);
+        createButtons();
+    }
+    IconCache::reset(true);
+    QStandardPaths::setTestModeEnabled(false);
+}
+
+void FlameshotBench::configRead()
+{
+    QBENCHMARK
+    {
+        ConfigHandler config;
+        config.drawColor();
+        config.drawThickness();
+        config.uiColor();
+        config.savePath();
+        config.shortcut(QStringLiteral("TYPE_ACCEPT"));
+    }
+}
+
+void FlameshotBench::configValidation()
+{
+    QBENCHMARK
+    {
+        ConfigHandler config;
+        config.hasInvalidSettings();
+    }
+}
+
+void FlameshotBench::parsedPattern()
+{
+    FileNameHandler handler;
+    QBENCHMARK
+    {
+        handler.parsedPattern();
+    }
+}
+
+void FlameshotBench::formatFileName()
+{
+    FileNameFormatter formatter(
+      QStringLiteral("%F_%H-%M-%S_%{screen}_%{size}_%{counter}"));
+    FileNameFormatter::Context context;
+    context.screen = QStringLiteral("DP-1");
+    context.size = QSize(1920, 1080);
+    QString name;
+    QBENCHMARK
+    {
+        formatter.format(name, context);
+        ++context.counter;
+    }
+    QVERIFY(name.contains(QLatin1String("_DP-1_1920x1080_")));
+}
+
+void FlameshotBench::numerateDuplicate()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("capture.png"));
+    QFile(path).open(QIODevice::WriteOnly);
+    for (int i = 1; i <= 10000; ++i) {
+        QFile(dir.filePath(QStringLiteral("capture_%1.png").arg(i)))
+          .open(QIODevice::WriteOnly);
+    }
+    FileNameHandler handler;
+    QBENCHMARK
+    {
+        QVERIFY(!handler.reserveScreenshotPath(path).isEmpty());
+    }
+}
+
+void FlameshotBench::httpUpload_data()
+{
+    QTest::addColumn<bool>("put");
+    QTest::addColumn<bool>("multipart");
+    QTest::newRow("POST") << false << false;
+    QTest::newRow("POST multipart") << false << true;
+    QTest::newRow("PUT") << true << false;
+}
+
+void FlameshotBench::httpUpload()
+{
+    QFETCH(bool, put);
+    QFETCH(bool, multipart);
+    const int uploads = 16;
+
+    QTemporaryFile png;
+    QVERIFY(png.open());
+    syntheticScreenshot(QSize(3840, 2160)).save(&png, "PNG");
+    png.close();
+
+    LocalHttpServer server;
+    QVERIFY(server.isListening());
+    HttpUploader::Settings settings;
+    settings.url = server.url();
+    settings.put = put;
+    settings.multipart = multipart;
+    settings.urlPath = QStringLiteral("url");
+
+    // A single manager, as in UploadQueue, so the connections are reused
+    QNetworkAccessManager network;
+    QBENCHMARK
+    {
+        QEventLoop loop;
+        int finished = 0;
+        int failed = 0;
+        for (int i = 0; i < uploads; ++i) {
+            auto* body = new QFile(png.fileName());
+            body->open(QIODevice::ReadOnly);
+            QNetworkReply* reply = HttpUploader::send(
+              &network, body, settings, QStringLiteral("capture"));
+            body->setParent(reply);
+            connect(reply, &QNetworkReply::finished, &loop, [&, reply]() {
+                QUrl url;
+                QString error;
+                if (reply->error() != QNetworkReply::NoError ||
+                    !HttpUploader::parseReply(reply, settings, url, error)) {
+                    ++failed;
+                }
+                reply->deleteLater();
+                if (++finished == uploads) {
+                    loop.quit();
+                }
+            });
+        }
+        loop.exec();
+        QCOMPARE(failed, 0);
+    }
+}
+
+void FlameshotBench::scrollStitch_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::newRow("1080p") << QSize(1920, 1080);
+    QTest::newRow("4K") << QSize(3840, 2160);
+}
+
+void FlameshotBench::scrollStitch()
+{
+    QFETCH(QSize, size);
+    const int frames = 8;
+    const int step = size.height() / 8;
+    const QImage page =
+      syntheticScreenshot(QSize(size.width(), size.height() + frames * step))
+        .toImage();
+    QVector<QImage> views;
+    for (int i = 0; i < frames; ++i) {
+        views << page.copy(0, i * step, size.width(), size.height());
+    }
+    QBENCHMARK
+    {
+        ScrollStitcher stitcher;
+        for (const QImage& view : views) {
+            stitcher.append(view);
+        }
+        QCOMPARE(stitcher.height(), size.height() + (frames - 1) * step);
+    }
+}
+
+void FlameshotBench::recordAnimation_data()
+{
+    QTest::addColumn<QString>("suffix");
+    QTest::newRow("GIF") << QStringLiteral("gif");
+    QTest::newRow("APNG") << QStringLiteral("png");
+}
+
+void FlameshotBench::recordAnimation()
+{
+    QFETCH(QString, suffix);
+    const QSize size(1920, 1080);
+    const QImage background = syntheticScreenshot(size).toImage();
+    QVector<QImage> frames;
+    for (int i = 0; i < 30; ++i) {
+        QImage frame = background;
+        QPainter painter(&frame);
+        painter.fillRect(i * 40, 300, 400, 300, Qt::darkBlue);
+        frames << frame;
+    }
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("record.") + suffix);
+    QBENCHMARK
+    {
+        AnimationRecorder recorder;
+        QVERIFY(recorder.start(path));
+        qint64 timestamp = 0;
+        for (const QImage& frame : frames) {
+            // Every frame is encoded, unlike in a live recording
+            while (!recorder.addFrame(frame, timestamp)) {
+                QThread::yieldCurrentThread();
+            }
+            timestamp += 100;
+        }
+        QVERIFY(recorder.finish(timestamp));
+    }
+}
+
+QTEST_MAIN(FlameshotBench)
+#include "flameshotbench.moc"
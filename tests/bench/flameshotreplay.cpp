@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+// Replays a capture session recorded with FLAMESHOT_RECORD_SESSION (see
+// SessionRecorder) against a CaptureWidget, on the offscreen platform and
+// with the recorded screenshot standing in for the screen:
+//
+//   flameshot_replay <session directory>
+//
+// The configuration recorded with the session is used, or the defaults for
+// older sessions. The replay runs in a temporary sandbox: a replayed save,
+// copy or pin never reaches the user's files, clipboard or history.
+//
+// The events are sent back to back, and after each of them the pending
+// repaints are processed. The time between sending an event and the end of
+// the repaints it caused is its event-to-paint latency. The report is
+// printed as JSON on stdout.
+
+#include "src/core/capturerequest.h"
+#include "src/core/flameshotdaemon.h"
+#include "src/widgets/capture/capturewidget.h"
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMouseEvent>
+#include <QPointer>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QWheelEvent>
+#include <QtTest>
+#include <algorithm>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+class PaintCounter : public QObject
+{
+public:
+    explicit PaintCounter(QWidget* window)
+      : m_window(window)
+    {}
+
+    int paints = 0;
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        auto* widget = qobject_cast<QWidget*>(watched);
+        if (event->type() == QEvent::Paint && widget != nullptr &&
+            widget->window() == m_window) {
+            ++paints;
+        }
+        return false;
+    }
+
+private:
+    QWidget* m_window;
+};
+
+void sendEvent(QWidget* window, const QJsonObject& e)
+{
+    const auto type = static_cast<QEvent::Type>(e["type"].toInt());
+    const QPoint windowPos(e["x"].toInt(), e["y"].toInt());
+    const auto modifiers =
+      static_cast<Qt::KeyboardModifiers>(e["modifiers"].toInt());
+    const auto buttons = static_cast<Qt::MouseButtons>(e["buttons"].toInt());
+
+    if (type == QEvent::KeyPress || type == QEvent::KeyRelease) {
+        // Through QTest, so that QShortcuts are triggered as for real input
+        QWidget* target = QApplication::focusWidget();
+        QTest::sendKeyEvent(type == QEvent::KeyPress ? QTest::Press
+                                                     : QTest::Release,
+                            target ? target : window,
+                            static_cast<Qt::Key>(e["key"].toInt()),
+                            e["text"].toString(),
+                            modifiers);
+        return;
+    }
+
+    QWidget* target = window->childAt(windowPos);
+    if (target == nullptr) {
+        target = window;
+    }
+    const QPoint pos = target->mapFrom(window, windowPos);
+    const QPoint globalPos = window->mapToGlobal(windowPos);
+    if (type == QEvent::Wheel) {
+        QWheelEvent wheel(pos,
+                          globalPos,
+                          QPoint(),
+                          QPoint(0, e["delta"].toInt()),
+                          buttons,
+                          modifiers,
+                          Qt::NoScrollPhase,
+                          false);
+        QApplication::sendEvent(target, &wheel);
+    } else {
+        QMouseEvent mouse(type,
+                          pos,
+                          windowPos,
+                          globalPos,
+                          static_cast<Qt::MouseButton>(e["button"].toInt()),
+                          buttons,
+                          modifiers);
+        QApplication::sendEvent(target, &mouse);
+    }
+}
+
+double percentile(QVector<double> values, double p)
+{
+    if (values.isEmpty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    int index = int(p * (values.size() - 1) + 0.5);
+    return values[qBound(0, index, values.size() - 1)];
+}
+
+// In KiB, 0 when unknown
+qint64 peakMemory()
+{
+#if defined(Q_OS_MACOS)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+#elif defined(Q_OS_UNIX)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+// Points everything a replayed shortcut may write at the sandbox
+void isolate(const QDir& session, const QDir& sandbox)
+{
+    QStandardPaths::setTestModeEnabled(true);
+    // Read from the environment by History
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(sandbox.filePath("cache")));
+    // The clipboard and the pins are handled by the daemon started in this
+    // process, nothing may reach the daemon of the user's session
+    qputenv("DBUS_SESSION_BUS_ADDRESS",
+            "unix:path=" + QFile::encodeName(sandbox.filePath("no-bus")));
+
+    QSettings::setPath(
+      QSettings::IniFormat, QSettings::UserScope, sandbox.path());
+    const QString config = sandbox.filePath("flameshot/flameshot.ini");
+    sandbox.mkpath(QStringLiteral("flameshot"));
+    sandbox.mkpath(QStringLiteral("captures"));
+    QFile::copy(session.filePath("flameshot.ini"), config);
+
+    // Saving must not wait for a file dialog, and the session must not
+    // depend on the network or the desktop
+    QSettings settings(config, QSettings::IniFormat);
+    settings.setValue("savePath", sandbox.filePath("captures"));
+    settings.setValue("savePathFixed", true);
+    settings.setValue("checkForUpdates", false);
+    settings.setValue("disabledTrayIcon", true);
+    settings.setValue("showDesktopNotification", false);
+    settings.setValue("logToFile", false);
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("flameshot"));
+    QCoreApplication::setOrganizationName(QStringLiteral("flameshot"));
+
+    QTextStream err(stderr);
+    if (app.arguments().size() != 2) {
+        err << "Usage: flameshot_replay <session directory>\n";
+        return 1;
+    }
+    const QDir session(app.arguments().at(1));
+    QFile eventsFile(session.filePath("events.json"));
+    if (!eventsFile.open(QIODevice::ReadOnly)) {
+        err << "Unable to open " << eventsFile.fileName() << "\n";
+        return 1;
+    }
+    const QJsonObject recording =
+      QJsonDocument::fromJson(eventsFile.readAll()).object();
+    const QJsonArray events = recording["events"].toArray();
+
+    QTemporaryDir sandbox;
+    if (!sandbox.isValid()) {
+        err << "Unable to create a temporary directory\n";
+        return 1;
+    }
+    isolate(session, QDir(sandbox.path()));
+    FlameshotDaemon::start();
+    qputenv("FLAMESHOT_SCREENSHOT_FILE",
+            session.filePath("screenshot.png").toLocal8Bit());
+
+    QElapsedTimer total;
+    total.start();
+    QPointer<CaptureWidget> widget =
+      new CaptureWidget(CaptureRequest(CaptureRequest::GRAPHICAL_MODE));
+    PaintCounter counter(widget);
+    app.installEventFilter(&counter);
+    widget->show();
+    widget->activateWindow();
+    QApplication::processEvents();
+
+    QVector<double> latencies;
+    QElapsedTimer timer;
+    for (const QJsonValue& value : events) {
+        if (widget.isNull()) {
+            // The session closed the capture
+            break;
+        }
+        counter.paints = 0;
+        timer.start();
+        sendEvent(widget, value.toObject());
+        QApplication::processEvents();
+        if (counter.paints > 0) {
+            latencies << timer.nsecsElapsed() / 1e6;
+        }
+    }
+    const double totalMs = total.nsecsElapsed() / 1e6;
+    app.removeEventFilter(&counter);
+    if (!widget.isNull()) {
+        widget->close();
+        QApplication::processEvents();
+    }
+
+    QJsonObject report;
+    report["events"] = events.size();
+    report["paintedEvents"] = latencies.size();
+    report["p50LatencyMs"] = percentile(latencies, 0.5);
+    report["p99LatencyMs"] = percentile(latencies, 0.99);
+    report["totalMs"] = totalMs;
+    report["peakMemoryKiB"] = peakMemory();
+    QTextStream(stdout) << QJsonDocument(report).toJson();
+    return 0;
+}
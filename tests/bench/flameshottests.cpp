@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+// Checks of the asynchronous paths that the benchmarks don't verify, run by
+// ctest in a build configured with -DBUILD_BENCHMARKS=ON.
+//
+// The tests get a configuration, a cache and data directories of their own,
+// so the user's settings neither change nor skip them.
+
+#include "fixtures.h"
+#include "src/tools/imgupload/uploadqueue.h"
+#include "src/tools/pin/pinmemorymanager.h"
+#include "src/tools/pin/pinwidget.h"
+#include "src/utils/abstractlogger.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/systemnotification.h"
+#include <QBuffer>
+#include <QDir>
+#include <QLockFile>
+#include <QProcess>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#endif
+
+namespace {
+
+// Stand-in for the notification server, records the notifications it gets
+class NotificationServer : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.freedesktop.Notifications")
+
+public:
+    QStringList bodies;
+
+public slots:
+    uint Notify(const QString& appName,
+                uint replacesId,
+                const QString& icon,
+                const QString& summary,
+                const QString& body,
+                const QStringList& actions,
+                const QVariantMap& hints,
+                int timeout)
+    {
+        Q_UNUSED(appName)
+        Q_UNUSED(replacesId)
+        Q_UNUSED(icon)
+        Q_UNUSED(summary)
+        Q_UNUSED(actions)
+        Q_UNUSED(hints)
+        Q_UNUSED(timeout)
+        bodies << body;
+        return bodies.size();
+    }
+};
+
+} // unnamed namespace
+
+class FlameshotTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    // Batching of the notifications and their flush, sent to a private
+    // session bus
+    void notifications();
+    // Retry of a failed upload, resume and cancelation of the jobs
+    void uploadQueue();
+    // Eviction of a pin over the memory budget, and its restore when painted
+    void pinMemory();
+
+private:
+    QTemporaryDir m_home;
+};
+
+void FlameshotTests::initTestCase()
+{
+    QVERIFY(m_home.isValid());
+    const QDir home(m_home.path());
+    QStandardPaths::setTestModeEnabled(true);
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, home.path());
+    // Read from the environment by History
+    qputenv("XDG_CACHE_HOME", QFile::encodeName(home.filePath("cache")));
+}
+
+void FlameshotTests::notifications()
+{
+#if defined(Q_OS_MACOS) || defined(Q_OS_WIN)
+    QSKIP("Notifications are sent by the tray icon");
+#else
+    ConfigHandler().setShowDesktopNotification(true);
+    QProcess bus;
+    bus.start(QStringLiteral("dbus-daemon"),
+              { QStringLiteral("--session"),
+                QStringLiteral("--nofork"),
+                QStringLiteral("--print-address=1") });
+    if (!bus.waitForStarted()) {
+        QSKIP("dbus-daemon is not available");
+    }
+    QVERIFY(bus.waitForReadyRead());
+    const QByteArray address = bus.readLine().trimmed();
+    qputenv("DBUS_SESSION_BUS_ADDRESS", address);
+
+    const QString service = QStringLiteral("org.freedesktop.Notifications");
+    NotificationServer server;
+    {
+        QDBusConnection connection = QDBusConnection::connectToBus(
+          QString::fromLocal8Bit(address), QStringLiteral("notifications"));
+        QVERIFY(connection.isConnected());
+        QVERIFY(connection.registerObject(
+          QStringLiteral("/org/freedesktop/Notifications"),
+          &server,
+          QDBusConnection::ExportAllSlots));
+        QVERIFY(connection.registerService(service));
+        // The notifications are the first test, nothing opened the session
+        // bus of the user before
+        const QString owner =
+          QDBusConnection::sessionBus().interface()->serviceOwner(service);
+        QCOMPARE(owner, connection.baseService());
+    }
+
+    // Messages of the same type are merged, an error is never merged with
+    // the info around it
+    AbstractLogger::info(AbstractLogger::Notification) << QStringLiteral("a");
+    AbstractLogger::info(AbstractLogger::Notification) << QStringLiteral("b");
+    AbstractLogger::error(AbstractLogger::Notification) << QStringLiteral("c");
+    AbstractLogger::info(AbstractLogger::Notification) << QStringLiteral("d");
+    QTRY_COMPARE_WITH_TIMEOUT(server.bodies,
+                              QStringList({ QStringLiteral("a\nb"),
+                                            QStringLiteral("c"),
+                                            QStringLiteral("d") }),
+                              5000);
+
+    // The server answers from this thread, so it can't answer while the
+    // flush waits: the wait must be bounded
+    AbstractLogger::info(AbstractLogger::Notification) << QStringLiteral("e");
+    QElapsedTimer clock;
+    clock.start();
+    SystemNotification::flush();
+    QVERIFY(clock.elapsed() < 1000);
+    QTRY_COMPARE(server.bodies.size(), 4);
+    QCOMPARE(server.bodies.last(), QStringLiteral("e"));
+
+    QDBusConnection::disconnectFromBus(QStringLiteral("notifications"));
+    bus.kill();
+    bus.waitForFinished();
+#endif
+}
+
+void FlameshotTests::uploadQueue()
+{
+    const QString directory =
+      QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) +
+      QStringLiteral("/uploads/");
+    QDir(directory).removeRecursively();
+
+    LocalHttpServer server(1);
+    QVERIFY(server.isListening());
+    qputenv("FLAMESHOT_IMGUR_API_URL",
+            QStringLiteral("http://127.0.0.1:%1/3/image")
+              .arg(server.serverPort())
+              .toLocal8Bit());
+
+    QByteArray png;
+    QBuffer buffer(&png);
+    buffer.open(QIODevice::WriteOnly);
+    syntheticScreenshot(QSize(640, 480)).save(&buffer, "PNG");
+
+    UploadQueue* queue = UploadQueue::instance();
+    queue->setRetryDelay(100);
+    QSignalSpy uploaded(queue, &UploadQueue::uploaded);
+    QSignalSpy failed(queue, &UploadQueue::failed);
+
+    // The 503 is retried after a backoff
+    const QString retried = UploadQueue::createJobId();
+    QElapsedTimer clock;
+    clock.start();
+    queue->enqueue(
+      retried, QStringLiteral("imgur"), QStringLiteral("capture"), png);
+    QTRY_COMPARE_WITH_TIMEOUT(uploaded.count(), 1, 5000);
+    QVERIFY(clock.elapsed() >= 100);
+    QCOMPARE(server.requests(), 2);
+    QCOMPARE(uploaded[0][0].toString(), retried);
+    QVERIFY(queue->isIdle());
+
+    // Jobs left by a dead process are resumed, the ones of a live process
+    // are not
+    const QString left = UploadQueue::createJobId();
+    const QString running = UploadQueue::createJobId();
+    for (const QString& id : { left, running }) {
+        QFile image(directory + id + QStringLiteral(".png"));
+        QVERIFY(image.open(QIODevice::WriteOnly));
+        image.write(png);
+        QFile description(directory + id + QStringLiteral(".json"));
+        QVERIFY(description.open(QIODevice::WriteOnly));
+        description.write("{\"storage\":\"imgur\",\"attempts\":1}");
+    }
+    QLockFile runningLock(directory + running + QStringLiteral(".lock"));
+    QVERIFY(runningLock.tryLock(0));
+    queue->resume();
+    QCOMPARE(queue->pendingCount(), 1);
+    QTRY_COMPARE_WITH_TIMEOUT(uploaded.count(), 2, 5000);
+    QCOMPARE(uploaded[1][0].toString(), left);
+    QVERIFY(!QFile::exists(directory + left + QStringLiteral(".png")));
+    QVERIFY(QFile::exists(directory + running + QStringLiteral(".png")));
+    runningLock.unlock();
+
+    // A canceled job disappears without a signal
+    const QString canceled = UploadQueue::createJobId();
+    queue->enqueue(
+      canceled, QStringLiteral("imgur"), QStringLiteral("capture"), png);
+    queue->cancel(canceled);
+    QVERIFY(queue->isIdle());
+    QTest::qWait(500);
+    QCOMPARE(uploaded.count(), 2);
+    QVERIFY(failed.isEmpty());
+    QVERIFY(!QFile::exists(directory + canceled + QStringLiteral(".png")));
+
+    queue->resume();
+    QTRY_COMPARE_WITH_TIMEOUT(uploaded.count(), 3, 5000);
+    QCOMPARE(uploaded[2][0].toString(), running);
+    QVERIFY(QDir(directory).entryList(QDir::Files).isEmpty());
+}
+
+void FlameshotTests::pinMemory()
+{
+    ConfigHandler().setPinMemoryBudget(1);
+    const QPixmap capture = syntheticScreenshot(QSize(1024, 768));
+    PinMemoryManager* manager = PinMemoryManager::instance();
+    {
+        PinWidget pin(capture, QRect(QPoint(), capture.size()));
+        const QImage painted = pin.grab().toImage();
+        const qint64 bytes = pin.pixelBytes();
+        QVERIFY(bytes > 0);
+
+        // 3 MiB over a budget of 1 MiB, the pin is hidden
+        QTRY_COMPARE(pin.pixelBytes(), qint64(0));
+        // Compressed on the thread pool
+        QTRY_VERIFY(manager->residentBytes() < bytes / 2);
+        const qint64 compressed = manager->residentBytes();
+
+        // Decoded again, without loss
+        QCOMPARE(pin.grab().toImage(), painted);
+        QCOMPARE(pin.pixelBytes(), bytes);
+
+        // Evicted again right away, the compressed copy was kept
+        QTRY_COMPARE(pin.pixelBytes(), qint64(0));
+        QCOMPARE(manager->residentBytes(), compressed);
+
+        // The pin under the cursor keeps its pixels
+        pin.setAttribute(Qt::WA_UnderMouse);
+        QCOMPARE(pin.grab().toImage(), painted);
+        QTest::qWait(100);
+        QCOMPARE(pin.pixelBytes(), bytes);
+    }
+    QCOMPARE(manager->residentBytes(), qint64(0));
+}
+
+QTEST_MAIN(FlameshotTests)
+#include "flameshottests.moc"